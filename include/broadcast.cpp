@@ -0,0 +1,130 @@
+#ifndef BROADCAST_HPP
+#define BROADCAST_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "parallel_for.cpp"
+
+namespace internal {
+    // broadcast_shape: numpy rules, dimensions aligned from the right and a
+    // size-1 dimension stretched to match the other operand
+    std::vector<size_t> broadcast_shape(const std::vector<size_t>& shape_a,
+                                        const std::vector<size_t>& shape_b);
+
+
+    // broadcast_strides: contiguous strides of shape, with 0 on every axis
+    // that is stretched (or missing) relative to out_shape
+    std::vector<size_t> broadcast_strides(const std::vector<size_t>& shape,
+                                          const std::vector<size_t>& out_shape);
+
+
+    // broadcast_rows: walk out_shape with strides_a/strides_b and call
+    // row(a, inc_a, b, inc_b, result, n) for every run along the innermost
+    // axis, after dropping size-1 axes and merging axes that are contiguous
+    // for all three operands; inc_a/inc_b are 0 or 1
+    template <typename T, typename RowFunc>
+    void broadcast_rows(const T *A, const std::vector<size_t>& strides_a,
+                        const T *B, const std::vector<size_t>& strides_b,
+                        T *result, const std::vector<size_t>& out_shape, RowFunc row);
+}
+
+
+namespace internal {
+    // broadcast_shape
+    inline std::vector<size_t> broadcast_shape(const std::vector<size_t>& shape_a,
+                                               const std::vector<size_t>& shape_b) {
+        const size_t ndim = std::max(shape_a.size(), shape_b.size());
+        std::vector<size_t> shape(ndim);
+
+        for (size_t i = 0; i < ndim; ++i) {
+            size_t dim_a = i < ndim - shape_a.size() ? 1 : shape_a[i - (ndim - shape_a.size())];
+            size_t dim_b = i < ndim - shape_b.size() ? 1 : shape_b[i - (ndim - shape_b.size())];
+
+            if (dim_a != dim_b && dim_a != 1 && dim_b != 1)
+                throw std::invalid_argument("Shapes of the two ndarrays cannot be broadcast together.");
+
+            shape[i] = dim_a == 1 ? dim_b : dim_a;
+        }
+
+        return shape;
+    }
+
+
+    // broadcast_strides
+    inline std::vector<size_t> broadcast_strides(const std::vector<size_t>& shape,
+                                                 const std::vector<size_t>& out_shape) {
+        const size_t offset = out_shape.size() - shape.size();
+        std::vector<size_t> strides(out_shape.size(), 0);
+
+        size_t stride = 1;
+        for (int i = static_cast<int>(shape.size()) - 1; i >= 0; --i) {
+            if (shape[i] != 1 || out_shape[i + offset] == 1)
+                strides[i + offset] = stride;
+
+            stride *= shape[i];
+        }
+
+        return strides;
+    }
+
+
+    // broadcast_rows
+    template <typename T, typename RowFunc>
+    void broadcast_rows(const T *A, const std::vector<size_t>& strides_a,
+                        const T *B, const std::vector<size_t>& strides_b,
+                        T *result, const std::vector<size_t>& out_shape, RowFunc row) {
+        std::vector<size_t> shape, sa, sb;
+
+        for (size_t i = 0; i < out_shape.size(); ++i) {
+            if (out_shape[i] == 1)
+                continue;
+
+            // the output is contiguous, so an axis merges into the previous
+            // one whenever both inputs are contiguous across the boundary too
+            if (!shape.empty() && sa.back() == strides_a[i] * out_shape[i]
+                               && sb.back() == strides_b[i] * out_shape[i]) {
+                shape.back() *= out_shape[i];
+                sa.back() = strides_a[i];
+                sb.back() = strides_b[i];
+            } else {
+                shape.push_back(out_shape[i]);
+                sa.push_back(strides_a[i]);
+                sb.push_back(strides_b[i]);
+            }
+        }
+
+        if (shape.empty()) {
+            row(A, 0, B, 0, result, 1);
+            return;
+        }
+
+        const size_t ndim = shape.size();
+        const size_t inner = shape[ndim - 1];
+        size_t rows = 1;
+        for (size_t d = 0; d + 1 < ndim; ++d)
+            rows *= shape[d];
+
+        // rows are independent, so each one locates its operands from its own
+        // index and large outputs are split across threads
+        parallel_rows(rows, inner, [&](size_t r) {
+            size_t offset_a = 0, offset_b = 0;
+            size_t rest = r;
+
+            for (int d = static_cast<int>(ndim) - 2; d >= 0; --d) {
+                const size_t index = rest % shape[d];
+                rest /= shape[d];
+
+                offset_a += index * sa[d];
+                offset_b += index * sb[d];
+            }
+
+            row(A + offset_a, sa[ndim - 1], B + offset_b, sb[ndim - 1], result + r * inner, inner);
+        });
+    }
+}
+
+
+#endif
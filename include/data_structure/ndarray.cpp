@@ -7,6 +7,8 @@
 #include <cstdint>
 #include <iostream>
 #include <optional>
+#include <string>
+#include <utility>
 
 #include <stdexcept>
 #include <cmath>
@@ -14,10 +16,17 @@
 #include <omp.h>
 
 #include "dtype_trait.cpp"
+#include "ndarray_view.cpp"
+#include "span.cpp"
+#include "../utils/allocator.cpp"
 
+#include "../broadcast.cpp"
+#include "../expression.cpp"
 #include "../logical.cpp"
 #include "../math.cpp"
 #include "../parallel_for.cpp"
+#include "../reduce.cpp"
+#include "../statistics.cpp"
 #include "../shift.cpp"
 #include "../sort.cpp"
 #include "../matrix_operations.cpp"
@@ -25,137 +34,212 @@
 #define NDARRAY_UNARY_FUNC(func_name, simd_func_1d) \
 template <typename T> \
 ndarray<T> ndarray<T>::func_name() { \
-    if (__shape.size() != 1 && __shape.size() != 2) \
-        throw std::invalid_argument("Unsupported array dimension."); \
-    std::vector<T> result = simd_func_1d(__data); \
-    ndarray<T> result_ndarray(__shape); \
-    for (size_t i = 0; i < result.size(); ++i) \
-        result_ndarray.__data[i] = result[i]; \
+    ndarray<T> result_ndarray(__shape, uninitialized); \
+    func_name(result_ndarray); \
     return result_ndarray; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name(ndarray<T>& out) { \
+    if (out.__shape != __shape) \
+        throw std::invalid_argument("Output array shape does not match."); \
+    simd_func_1d(__data.data(), out.__data.data(), __size); \
+    return out; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name##_() { \
+    return func_name(*this); \
 }
 
-#define NDARRAY_BINARY_FUNC(func_name, simd_1d_func) \
+#define NDARRAY_BINARY_FUNC(func_name, simd_1d_func, traits, scalar_op) \
 template <typename T> \
 ndarray<T> ndarray<T>::func_name(const ndarray<T>& other) { \
-    if (__shape != other.__shape) \
-        throw std::invalid_argument("Shapes of the two ndarrays do not match."); \
-    if (__shape.size() != 1 && __shape.size() != 2) \
-        throw std::invalid_argument("Unsupported array dimension."); \
-    std::vector<T> result = simd_1d_func(__data, other.__data); \
-    ndarray<T> result_ndarray(__shape); \
-    for (size_t i = 0; i < result.size(); ++i) \
-        result_ndarray.__data[i] = result[i]; \
+    ndarray<T> result_ndarray(internal::broadcast_shape(__shape, other.__shape), uninitialized); \
+    func_name(other, result_ndarray); \
     return result_ndarray; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name(const ndarray<T>& other, ndarray<T>& out) { \
+    if (__shape != other.__shape) \
+        return broadcast_op<traits>(other, out, scalar_op()); \
+    if (out.__shape != __shape) \
+        throw std::invalid_argument("Output array shape does not match."); \
+    simd_1d_func(__data.data(), other.__data.data(), out.__data.data(), __size); \
+    return out; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name##_(const ndarray<T>& other) { \
+    return func_name(other, *this); \
 }
 
-#define NDARRAY_APPLY_FUNC(func_name, apply_1d, apply_2d) \
+#define NDARRAY_APPLY_FUNC(func_name, apply_1d) \
 template <typename T> \
 template <typename Func> \
 ndarray<T> ndarray<T>::func_name(Func func) { \
-    if (__shape.size() == 1) { \
-        std::vector<T> result = __data; \
-        apply_1d(result, func); \
-        ndarray<T> result_ndarray(__shape); \
-        for (size_t i = 0; i < result.size(); ++i) { \
-            result_ndarray.__data[i] = result[i]; \
-        } \
-        return result_ndarray; \
-    } else if (__shape.size() == 2) { \
-        std::vector<std::vector<T>> A_2d(__shape[0], std::vector<T>(__shape[1])); \
-        for (size_t i = 0; i < __shape[0]; ++i) { \
-            for (size_t j = 0; j < __shape[1]; ++j) { \
-                A_2d[i][j] = __data[calculate_offset(i, j)]; \
-            } \
-        } \
-        apply_2d(A_2d, func); \
-        ndarray<T> result_ndarray(__shape); \
-        for (size_t i = 0; i < __shape[0]; ++i) { \
-            for (size_t j = 0; j < __shape[1]; ++j) { \
-                result_ndarray.__data[calculate_offset(i, j)] = A_2d[i][j]; \
-            } \
-        } \
-        return result_ndarray; \
-    } \
-    throw std::invalid_argument("Unsupported array dimension."); \
+    ndarray<T> result_ndarray(__shape, uninitialized); \
+    apply_1d(__data.data(), result_ndarray.__data.data(), __size, func); \
+    return result_ndarray; \
 }
 
 #define NDARRAY_SHIFT_FUNC(func_name, simd_func_1d) \
 template <typename T> \
 ndarray<T> ndarray<T>::func_name(const int imm) { \
-    if (__shape.size() != 1 && __shape.size() != 2) \
-        throw std::invalid_argument("Unsupported array dimension."); \
-    std::vector<T> result = simd_func_1d(__data, imm); \
-    ndarray<T> result_ndarray(__shape); \
-    for (size_t i = 0; i < result.size(); ++i) { \
-        result_ndarray.__data[i] = result[i]; \
-    } \
+    ndarray<T> result_ndarray(__shape, uninitialized); \
+    func_name(imm, result_ndarray); \
     return result_ndarray; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name(const int imm, ndarray<T>& out) { \
+    if (out.__shape != __shape) \
+        throw std::invalid_argument("Output array shape does not match."); \
+    simd_func_1d(__data.data(), out.__data.data(), __size, imm); \
+    return out; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name##_(const int imm) { \
+    return func_name(imm, *this); \
 }
 
+// sorts along the last axis
 #define NDARRAY_SORT_FUNC(func_name, sort_1d_func, sort_2d_func) \
 template <typename T> \
 template <typename Compare> \
 ndarray<T> ndarray<T>::func_name(Compare comp) { \
-    if (__shape.size() == 1) { \
-        std::vector<T> result = __data; \
-        sort_1d_func(result, comp); \
-        ndarray<T> result_ndarray(__shape); \
-        for (size_t i = 0; i < result.size(); ++i) { \
-            result_ndarray.__data[i] = result[i]; \
-        } \
-        return result_ndarray; \
-    } else if (__shape.size() == 2) { \
-        std::vector<std::vector<T>> A_2d(__shape[0], std::vector<T>(__shape[1])); \
-        for (size_t i = 0; i < __shape[0]; ++i) { \
-            for (size_t j = 0; j < __shape[1]; ++j) { \
-                A_2d[i][j] = __data[calculate_offset(i, j)]; \
-            } \
-        } \
-        sort_2d_func(A_2d, comp); \
-        ndarray<T> result_ndarray(__shape); \
-        for (size_t i = 0; i < __shape[0]; ++i) { \
-            for (size_t j = 0; j < __shape[1]; ++j) { \
-                result_ndarray.__data[calculate_offset(i, j)] = A_2d[i][j]; \
-            } \
-        } \
-        return result_ndarray; \
-    } \
-    throw std::invalid_argument("Unsupported array dimension."); \
-}
-
-#define NDARRAY_ARITH_FUNC(func_name, op_1d) \
+    ndarray<T> result_ndarray(*this); \
+    if (__shape.size() == 1) \
+        sort_1d_func(result_ndarray.__data.data(), __size, comp); \
+    else \
+        sort_2d_func(result_ndarray.__data.data(), __size / __shape.back(), __shape.back(), \
+                     __strides[__shape.size() - 2], comp); \
+    return result_ndarray; \
+}
+
+#define NDARRAY_ARITH_FUNC(func_name, op_1d, traits, scalar_op) \
 template <typename T> \
 ndarray<T> ndarray<T>::func_name(const ndarray<T>& other) { \
+    ndarray<T> result_ndarray(internal::broadcast_shape(__shape, other.__shape), uninitialized); \
+    func_name(other, result_ndarray); \
+    return result_ndarray; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name(const ndarray<T>& other, ndarray<T>& out) { \
     if (__shape != other.__shape) \
-        throw std::invalid_argument("Shapes of the two ndarrays do not match."); \
-    if (__shape.size() != 1 && __shape.size() != 2) \
-        throw std::invalid_argument("Unsupported array dimension."); \
-    std::vector<T> result = op_1d(__data, other.__data); \
-    ndarray<T> result_ndarray(__shape); \
-    for (size_t i = 0; i < result.size(); ++i) \
-        result_ndarray.__data[i] = result[i]; \
+        return broadcast_op<traits>(other, out, scalar_op()); \
+    if (out.__shape != __shape) \
+        throw std::invalid_argument("Output array shape does not match."); \
+    op_1d(__data.data(), other.__data.data(), out.__data.data(), __size); \
+    return out; \
+} \
+\
+template <typename T> \
+ndarray<T>& ndarray<T>::func_name##_(const ndarray<T>& other) { \
+    return func_name(other, *this); \
+}
+
+// reductions without an identity (min, max) reject an empty input
+#define NDARRAY_REDUCE_FUNC(func_name, simd_func_1d, axis_func, needs_elements) \
+template <typename T> \
+T ndarray<T>::func_name() const { \
+    if (needs_elements && __size == 0) \
+        throw std::invalid_argument("Zero-size array has no " #func_name "."); \
+    return simd_func_1d(__data.data(), __size); \
+} \
+\
+template <typename T> \
+ndarray<T> ndarray<T>::func_name(int axis) const { \
+    const auto extents = axis_extents(axis); \
+    if (needs_elements && extents[1] == 0) \
+        throw std::invalid_argument("Zero-size axis has no " #func_name "."); \
+    ndarray<T> result_ndarray(reduced_shape(axis), uninitialized); \
+    axis_func(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], extents[2]); \
     return result_ndarray; \
 }
 
+// arg reductions give int64 positions, as numpy does
+#define NDARRAY_ARG_REDUCE_FUNC(func_name, simd_func_1d, axis_func) \
+template <typename T> \
+size_t ndarray<T>::func_name() const { \
+    if (__size == 0) \
+        throw std::invalid_argument("Zero-size array has no " #func_name "."); \
+    return simd_func_1d(__data.data(), __size); \
+} \
+\
+template <typename T> \
+ndarray<int64_t> ndarray<T>::func_name(int axis) const { \
+    const auto extents = axis_extents(axis); \
+    if (extents[1] == 0) \
+        throw std::invalid_argument("Zero-size axis has no " #func_name "."); \
+    typename ndarray<int64_t>::storage_type indices(extents[0] * extents[2]); \
+    axis_func(__data.data(), indices.data(), extents[0], extents[1], extents[2]); \
+    return ndarray<int64_t>(reduced_shape(axis), std::move(indices)); \
+}
+
 template <typename T>
 class ndarray {
+public:
+    // element storage: cache-line aligned, and default-initialising so kernel
+    // outputs skip the zero-fill
+    using storage_type = std::vector<T, aligned_allocator<T>>;
+
 private:
-    std::vector<T> __data;
+    storage_type __data;
     std::vector<size_t> __shape;
     std::vector<size_t> __strides;
     size_t __size;
 
     void compute_strides();
 
-    size_t calculate_offset(size_t row, size_t col) const noexcept;
+    void init_shape();
+
+    size_t calculate_offset(const std::vector<size_t>& indices) const;
+
+    void print(std::ostream& os, size_t axis, size_t offset) const;
+
+    // binary op between different shapes; the stretched operand is read with
+    // stride 0 instead of being expanded
+    template <template <typename> class Traits, typename BinaryOp>
+    ndarray<T>& broadcast_op(const ndarray<T>& other, ndarray<T>& out, BinaryOp binary_op) const;
+
+    // {outer, len, inner}: the shape seen as [outer, axis, inner], for
+    // kernels that work along one axis
+    std::array<size_t, 3> axis_extents(int axis) const;
+
+    // the shape without axis, or {1} when nothing is left
+    std::vector<size_t> reduced_shape(int axis) const;
+
+    // {vars, obs} of a 1D or 2D array of variables, for cov and corrcoef
+    std::array<size_t, 2> variable_extents(bool rowvar) const;
 
 public:
+    // zero-filled
     ndarray(const std::vector<size_t>& shape);
 
+    // contents are indeterminate until written
+    ndarray(const std::vector<size_t>& shape, uninitialized_t);
+
+    // adopts the buffer without copying
+    ndarray(const std::vector<size_t>& shape, storage_type&& data);
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<U>, T>>>
+    explicit ndarray(const ndarray_view<U>& view);
+
+    // materialises a lazy expression in a single pass
+    template <typename Node>
+    ndarray(const lazy_expr<T, Node>& expr);
+
     void assign(const std::vector<T>& data);
 
     void assign(const std::vector<std::vector<T>>& data);
 
+    template <typename Node>
+    void assign(const lazy_expr<T, Node>& expr);
+
     const char *dtype() const noexcept;
 
     size_t itemsize() const noexcept;
@@ -164,67 +248,196 @@ public:
     
     size_t size() const noexcept;
 
-    std::vector<size_t> shape() const noexcept;
+    const std::vector<size_t>& shape() const noexcept;
+
+    // copy of the elements; flat() gives access without copying
+    std::vector<T> data() const;
+
+    span<T> flat() noexcept;
 
-    std::vector<T> data() const noexcept;
+    span<const T> flat() const noexcept;
+
+
+public:
+    // views
+    ndarray_view<T> view();
+
+    ndarray_view<const T> view() const;
+
+    ndarray_view<T> slice(size_t axis, size_t start, size_t stop, size_t step = 1);
+
+    ndarray_view<T> reshape(const std::vector<size_t>& shape);
+
+    // lazy expressions
+    lazy_expr<T, internal::leaf_node<T>> lazy() const;
 
 
 public:
     std::vector<uint8_t> all(int axis) const;
 
-    // float mean() const;
+    // reductions: over every element, or along one axis (negative counts
+    // from the end), which the result drops. min/max and their arg forms
+    // skip NaNs and throw on an empty array; mean needs a floating-point T
+    T sum() const;
+    ndarray<T> sum(int axis) const;
+
+    T prod() const;
+    ndarray<T> prod(int axis) const;
+
+    T mean() const;
+    ndarray<T> mean(int axis) const;
+
+    T min() const;
+    ndarray<T> min(int axis) const;
+
+    T max() const;
+    ndarray<T> max(int axis) const;
+
+    size_t argmin() const;
+    ndarray<int64_t> argmin(int axis) const;
+
+    size_t argmax() const;
+    ndarray<int64_t> argmax(int axis) const;
+
+    // statistics, in one pass: var and std divide by n - ddof. Over the
+    // whole array ddof is passed as ddof_t and must be below size(); along
+    // an axis a lane with n <= ddof gives NaN. cov and corrcoef take the rows of a 2D array as the
+    // variables, or its columns when rowvar is false, and a 1D array as one
+    // variable. All need a floating-point T
+    T var(ddof_t ddof = ddof_t{0}) const;
+    ndarray<T> var(int axis, size_t ddof = 0) const;
 
-    // double mean() const;
+    T std(ddof_t ddof = ddof_t{0}) const;
+    ndarray<T> std(int axis, size_t ddof = 0) const;
 
-    // float mean(int axis) const;
+    ndarray<T> cov(bool rowvar = true, size_t ddof = 1) const;
+
+    ndarray<T> corrcoef(bool rowvar = true) const;
 
 
     // logical function
     ndarray<T> logical_and(const ndarray<T>& other);
+    ndarray<T>& logical_and(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& logical_and_(const ndarray<T>& other);
 
     ndarray<T> logical_or(const ndarray<T>& other);
+    ndarray<T>& logical_or(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& logical_or_(const ndarray<T>& other);
 
     ndarray<T> logical_xor(const ndarray<T>& other);
+    ndarray<T>& logical_xor(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& logical_xor_(const ndarray<T>& other);
 
     ndarray<T> logical_andnot(const ndarray<T>& other);
+    ndarray<T>& logical_andnot(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& logical_andnot_(const ndarray<T>& other);
 
 
     // math function
     ndarray<T> min(const ndarray<T>& other);
+    ndarray<T>& min(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& min_(const ndarray<T>& other);
 
     ndarray<T> max(const ndarray<T>& other);
+    ndarray<T>& max(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& max_(const ndarray<T>& other);
 
     ndarray<T> sqrt();
+    ndarray<T>& sqrt(ndarray<T>& out);
+    ndarray<T>& sqrt_();
 
     ndarray<T> rsqrt();
+    ndarray<T>& rsqrt(ndarray<T>& out);
+    ndarray<T>& rsqrt_();
 
     ndarray<T> round();
+    ndarray<T>& round(ndarray<T>& out);
+    ndarray<T>& round_();
 
     ndarray<T> ceil();
+    ndarray<T>& ceil(ndarray<T>& out);
+    ndarray<T>& ceil_();
 
     ndarray<T> floor();
+    ndarray<T>& floor(ndarray<T>& out);
+    ndarray<T>& floor_();
 
     ndarray<T> abs();
+    ndarray<T>& abs(ndarray<T>& out);
+    ndarray<T>& abs_();
 
     ndarray<T> log();
+    ndarray<T>& log(ndarray<T>& out);
+    ndarray<T>& log_();
 
     ndarray<T> log2();
+    ndarray<T>& log2(ndarray<T>& out);
+    ndarray<T>& log2_();
 
     ndarray<T> log10();
+    ndarray<T>& log10(ndarray<T>& out);
+    ndarray<T>& log10_();
 
     ndarray<T> sin();
+    ndarray<T>& sin(ndarray<T>& out);
+    ndarray<T>& sin_();
 
     ndarray<T> cos();
+    ndarray<T>& cos(ndarray<T>& out);
+    ndarray<T>& cos_();
 
-    ndarray<T> sincos();
+    // sine and cosine together, sharing one range reduction
+    std::pair<ndarray<T>, ndarray<T>> sincos();
+    void sincos(ndarray<T>& sin_out, ndarray<T>& cos_out);
 
     ndarray<T> tan();
+    ndarray<T>& tan(ndarray<T>& out);
+    ndarray<T>& tan_();
 
     ndarray<T> asin();
+    ndarray<T>& asin(ndarray<T>& out);
+    ndarray<T>& asin_();
 
     ndarray<T> acos();
+    ndarray<T>& acos(ndarray<T>& out);
+    ndarray<T>& acos_();
 
     ndarray<T> atan();
+    ndarray<T>& atan(ndarray<T>& out);
+    ndarray<T>& atan_();
+
+    ndarray<T> exp();
+    ndarray<T>& exp(ndarray<T>& out);
+    ndarray<T>& exp_();
+
+    ndarray<T> exp2();
+    ndarray<T>& exp2(ndarray<T>& out);
+    ndarray<T>& exp2_();
+
+    ndarray<T> expm1();
+    ndarray<T>& expm1(ndarray<T>& out);
+    ndarray<T>& expm1_();
+
+    ndarray<T> log1p();
+    ndarray<T>& log1p(ndarray<T>& out);
+    ndarray<T>& log1p_();
+
+    ndarray<T> tanh();
+    ndarray<T>& tanh(ndarray<T>& out);
+    ndarray<T>& tanh_();
+
+    ndarray<T> sigmoid();
+    ndarray<T>& sigmoid(ndarray<T>& out);
+    ndarray<T>& sigmoid_();
+
+    // elementwise power, other broadcast like the arithmetic ops
+    ndarray<T> pow(const ndarray<T>& other);
+    ndarray<T>& pow(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& pow_(const ndarray<T>& other);
+
+    // along one axis (negative counts from the end); logsumexp drops it
+    ndarray<T> softmax(int axis = -1);
+    ndarray<T> logsumexp(int axis = -1);
 
 
     // parallel function
@@ -233,23 +446,69 @@ public:
 
 
     // sort function
-    template <typename Compare>
+    template <typename Compare = std::less<T>>
     ndarray<T> sort(Compare comp = std::less<T>{});
 
 
     // shift function
     ndarray<T> slli(const int imm);
+    ndarray<T>& slli(const int imm, ndarray<T>& out);
+    ndarray<T>& slli_(const int imm);
 
     ndarray<T> srli(const int imm);
+    ndarray<T>& srli(const int imm, ndarray<T>& out);
+    ndarray<T>& srli_(const int imm);
+
+    ndarray<T> srai(const int imm);
+    ndarray<T>& srai(const int imm, ndarray<T>& out);
+    ndarray<T>& srai_(const int imm);
+
+    // per-element counts taken from other (broadcast like the arithmetic ops)
+    ndarray<T> sllv(const ndarray<T>& other);
+    ndarray<T>& sllv(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& sllv_(const ndarray<T>& other);
+
+    ndarray<T> srlv(const ndarray<T>& other);
+    ndarray<T>& srlv(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& srlv_(const ndarray<T>& other);
 
 
     // matrix operations
     ndarray<T> add(const ndarray<T>& other);
+    ndarray<T>& add(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& add_(const ndarray<T>& other);
 
     ndarray<T> sub(const ndarray<T>& other);
+    ndarray<T>& sub(const ndarray<T>& other, ndarray<T>& out);
+    ndarray<T>& sub_(const ndarray<T>& other);
 
     ndarray<T> dot(const ndarray<T>& other);
 
+    ndarray<T> dot(const ndarray_view<const T>& other);
+
+    // dot<R>: the product with elements of type R; integer operands are
+    // multiplied exactly and accumulated in 32 bits or wider, so int8 x
+    // int8 -> int32 does not wrap around in int8
+    template <typename R>
+    ndarray<R> dot(const ndarray<T>& other) const;
+
+    template <typename R>
+    ndarray<R> dot(const ndarray_view<const T>& other) const;
+
+    // dot_batched<M, N, K>: a [count, M, K] array times [count, K, N], or
+    // times one [K, N] shared by the whole batch; the result is [count, M, N]
+    template <size_t M, size_t N, size_t K>
+    ndarray<T> dot_batched(const ndarray<T>& other) const;
+
+    // matmul: np.matmul for arrays of two or more dimensions; the last two
+    // axes hold the matrices and the leading ones are a batch, broadcast as
+    // numpy does
+    ndarray<T> matmul(const ndarray<T>& other) const;
+
+    // vdot: inner product of the two arrays flattened, as np.vdot; summed
+    // as get_summation() says
+    T vdot(const ndarray<T>& other) const;
+
     ndarray<T> transpose();
     
 
@@ -258,37 +517,14 @@ public:
     const T& operator()(const std::vector<size_t>& indices) const;
 
     friend std::ostream& operator<<(std::ostream& os, const ndarray<T>& arr) {
-        os << "[";
-        if (arr.__shape.size() == 1) {
-            for (size_t i = 0; i < arr.__size; ++i) {
-                if (i > 0) 
-                    os << ", ";
-                    
-                os << arr.__data[i];
-            }
-        } else if (arr.__shape.size() == 2) {
-            for (size_t i = 0; i < arr.__shape[0]; ++i) {
-                if (i > 0)
-                    os << ",\n ";
-                
-                os << "[";
-                for (size_t j = 0; j < arr.__shape[1]; ++j) {
-                    if (j > 0)
-                        os << ", ";
-                    
-                    os << arr.__data[arr.calculate_offset(i, j)];
-                }
-                os << "]";
-            }
-        }
-        os << "]";
+        arr.print(os, 0, 0);
 
         return os;
     }
 };
 
-template <typename T>
-uint8_t bool_operation_with_row(const std::vector<T>& vec) {
+template <typename T, typename Alloc>
+uint8_t bool_operation_with_row(const std::vector<T, Alloc>& vec) {
     for (int i = 0; i < static_cast<int>(vec.size()); ++i)
         if (!vec[i])
             return 0;
@@ -307,25 +543,138 @@ uint8_t bool_operation_with_col(const std::vector<std::vector<T>>& vec) {
 }
 
 template <typename T>
-size_t ndarray<T>::calculate_offset(size_t row, size_t col) const noexcept {
-    size_t offset = row * __strides[0] + col * __strides[1];
-        
+size_t ndarray<T>::calculate_offset(const std::vector<size_t>& indices) const {
+    if (indices.size() != __shape.size())
+        throw std::out_of_range("Index dimensions do not match array dimensions.");
+
+    size_t offset = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= __shape[i])
+            throw std::out_of_range("Invalid index.");
+
+        offset += indices[i] * __strides[i];
+    }
+
     return offset;
 }
 
+template <typename T>
+template <template <typename> class Traits, typename BinaryOp>
+ndarray<T>& ndarray<T>::broadcast_op(const ndarray<T>& other, ndarray<T>& out, BinaryOp binary_op) const {
+    std::vector<size_t> shape = internal::broadcast_shape(__shape, other.__shape);
+
+    if (out.__shape != shape)
+        throw std::invalid_argument("Output array shape does not match.");
+
+    internal::broadcast_rows(__data.data(), internal::broadcast_strides(__shape, shape),
+                             other.__data.data(), internal::broadcast_strides(other.__shape, shape),
+                             out.__data.data(), shape,
+                             [&](const T *a, size_t inc_a, const T *b, size_t inc_b, T *result, size_t n) {
+                                 dispatch_binary_op<T, Traits>(a, inc_a, b, inc_b, result, n, binary_op);
+                             });
+
+    return out;
+}
+
+template <typename T>
+std::array<size_t, 3> ndarray<T>::axis_extents(int axis) const {
+    const int ndim = static_cast<int>(__shape.size());
+    if (axis < -ndim || axis >= ndim)
+        throw std::invalid_argument("Axis out of range.");
+    if (axis < 0)
+        axis += ndim;
+
+    std::array<size_t, 3> extents = {1, __shape[axis], 1};
+    for (int d = 0; d < axis; ++d)
+        extents[0] *= __shape[d];
+    for (int d = axis + 1; d < ndim; ++d)
+        extents[2] *= __shape[d];
+
+    return extents;
+}
 
 template <typename T>
-ndarray<T>::ndarray(const std::vector<size_t>& shape) : __shape(shape) {
+std::vector<size_t> ndarray<T>::reduced_shape(int axis) const {
+    std::vector<size_t> shape(__shape);
+    shape.erase(shape.begin() + (axis < 0 ? axis + static_cast<int>(__shape.size()) : axis));
     if (shape.empty())
-        throw std::invalid_argument("Shape cannot be empty");
+        shape.push_back(1);
 
-    __size = std::accumulate(
-        shape.begin(), shape.end(), 
-        1, std::multiplies<size_t>()
-    );
+    return shape;
+}
+
+template <typename T>
+std::array<size_t, 2> ndarray<T>::variable_extents(bool rowvar) const {
+    if (__shape.size() == 1)
+        return {1, __shape[0]};
+    if (__shape.size() != 2)
+        throw std::invalid_argument("Only 1D and 2D arrays hold variables.");
+
+    return rowvar ? std::array<size_t, 2>{__shape[0], __shape[1]} : std::array<size_t, 2>{__shape[1], __shape[0]};
+}
+
+template <typename T>
+void ndarray<T>::print(std::ostream& os, size_t axis, size_t offset) const {
+    os << "[";
+    for (size_t i = 0; i < __shape[axis]; ++i) {
+        if (axis + 1 == __shape.size()) {
+            if (i > 0)
+                os << ", ";
+
+            os << __data[offset + i];
+        } else {
+            // numpy layout: one newline per remaining inner axis, indented
+            // past the brackets already open
+            if (i > 0)
+                os << "," << std::string(__shape.size() - axis - 1, '\n') << std::string(axis + 1, ' ');
+
+            print(os, axis + 1, offset + i * __strides[axis]);
+        }
+    }
+    os << "]";
+}
 
+
+template <typename T>
+ndarray<T>::ndarray(const std::vector<size_t>& shape) : __shape(shape) {
+    init_shape();
+    __data.resize(__size, T());
+}
+
+template <typename T>
+ndarray<T>::ndarray(const std::vector<size_t>& shape, uninitialized_t) : __shape(shape) {
+    init_shape();
     __data.resize(__size);
-    compute_strides();
+}
+
+template <typename T>
+ndarray<T>::ndarray(const std::vector<size_t>& shape, storage_type&& data) : __shape(shape) {
+    init_shape();
+
+    if (data.size() != __size)
+        throw std::invalid_argument("Data size does not match the array size.");
+
+    __data = std::move(data);
+}
+
+template <typename T>
+template <typename U, typename>
+ndarray<T>::ndarray(const ndarray_view<U>& view) : ndarray(view.shape(), uninitialized) {
+    const std::vector<size_t>& strides = view.strides();
+
+    // a transposed 2D view is gathered with the blocked transpose kernel
+    // instead of walking the source column by column
+    if (strides.size() == 2 && strides[0] == 1 && strides[1] != 1 && __shape[0] > 1)
+        internal::transpose(static_cast<const T *>(view.data()), __shape[1], __shape[0], strides[1],
+                            __data.data(), __strides[0]);
+    else
+        internal::strided_copy(static_cast<const T *>(view.data()), view.shape(), strides, __data.data());
+}
+
+template <typename T>
+template <typename Node>
+ndarray<T>::ndarray(const lazy_expr<T, Node>& expr) : ndarray(expr.shape(), uninitialized) {
+    expr.eval(__data.data());
 }
 
 template <typename T>
@@ -336,7 +685,7 @@ void ndarray<T>::assign(const std::vector<T>& data) {
     if (data.size() != __size)
         throw std::invalid_argument("Data size does not match the array size.");
 
-    __data = data;
+    __data.assign(data.begin(), data.end());
 }
 
 template <typename T>
@@ -357,6 +706,28 @@ void ndarray<T>::assign(const std::vector<std::vector<T>>& data) {
         __data.insert(__data.end(), row.begin(), row.end());
 }
 
+template <typename T>
+template <typename Node>
+void ndarray<T>::assign(const lazy_expr<T, Node>& expr) {
+    if (expr.shape() != __shape)
+        throw std::invalid_argument("Expression shape does not match the array shape.");
+
+    expr.eval(__data.data());
+}
+
+template <typename T>
+void ndarray<T>::init_shape() {
+    if (__shape.empty())
+        throw std::invalid_argument("Shape cannot be empty");
+
+    __size = std::accumulate(
+        __shape.begin(), __shape.end(),
+        static_cast<size_t>(1), std::multiplies<size_t>()
+    );
+
+    compute_strides();
+}
+
 template <typename T>
 void ndarray<T>::compute_strides() {
     __strides.resize(__shape.size());
@@ -390,13 +761,48 @@ size_t ndarray<T>::size() const noexcept {
 }
 
 template <typename T>
-std::vector<size_t> ndarray<T>::shape() const noexcept {
+const std::vector<size_t>& ndarray<T>::shape() const noexcept {
     return __shape;
 }
 
 template <typename T>
-std::vector<T> ndarray<T>::data() const noexcept {
-    return __data;
+std::vector<T> ndarray<T>::data() const {
+    return std::vector<T>(__data.begin(), __data.end());
+}
+
+template <typename T>
+span<T> ndarray<T>::flat() noexcept {
+    return span<T>(__data.data(), __size);
+}
+
+template <typename T>
+span<const T> ndarray<T>::flat() const noexcept {
+    return span<const T>(__data.data(), __size);
+}
+
+template <typename T>
+ndarray_view<T> ndarray<T>::view() {
+    return ndarray_view<T>(__data.data(), __shape, __strides);
+}
+
+template <typename T>
+ndarray_view<const T> ndarray<T>::view() const {
+    return ndarray_view<const T>(__data.data(), __shape, __strides);
+}
+
+template <typename T>
+ndarray_view<T> ndarray<T>::slice(size_t axis, size_t start, size_t stop, size_t step) {
+    return view().slice(axis, start, stop, step);
+}
+
+template <typename T>
+ndarray_view<T> ndarray<T>::reshape(const std::vector<size_t>& shape) {
+    return view().reshape(shape);
+}
+
+template <typename T>
+lazy_expr<T, internal::leaf_node<T>> ndarray<T>::lazy() const {
+    return lazy_expr<T, internal::leaf_node<T>>(internal::leaf_node<T>{__data.data()}, __shape);
 }
 
 template <typename T>
@@ -419,7 +825,7 @@ std::vector<uint8_t> ndarray<T>::all(int axis) const {
             for (int i = 0; i < static_cast<int>(col); ++i) {
                 bool false_flag = false;
                 for (int j = 0; j < static_cast<int>(row); ++j) {
-                    size_t offset = calculate_offset(j, i);
+                    size_t offset = j * __strides[0] + i * __strides[1];
 
                     if (!__data[offset]) {
                         false_flag = true;
@@ -435,7 +841,7 @@ std::vector<uint8_t> ndarray<T>::all(int axis) const {
             for (int i = 0; i < static_cast<int>(row); ++i) {
                 bool false_flag = false;
                 for (int j = 0; j < static_cast<int>(col); ++j) {
-                    size_t offset = calculate_offset(i, j);
+                    size_t offset = i * __strides[0] + j * __strides[1];
 
                     if (!__data[offset]) {
                         false_flag = true;
@@ -455,19 +861,19 @@ std::vector<uint8_t> ndarray<T>::all(int axis) const {
 
 
 // logical functions
-NDARRAY_BINARY_FUNC(logical_and, internal::and1_simd);
+NDARRAY_BINARY_FUNC(logical_and, internal::and1_simd, and_simd_traits, internal::logical_and_op);
 
-NDARRAY_BINARY_FUNC(logical_or, internal::or1_simd);
+NDARRAY_BINARY_FUNC(logical_or, internal::or1_simd, or_simd_traits, internal::logical_or_op);
 
-NDARRAY_BINARY_FUNC(logical_xor, internal::xor1_simd);
+NDARRAY_BINARY_FUNC(logical_xor, internal::xor1_simd, xor_simd_traits, internal::logical_xor_op);
 
-NDARRAY_BINARY_FUNC(logical_andnot, internal::andnot1_simd);
+NDARRAY_BINARY_FUNC(logical_andnot, internal::andnot1_simd, andnot_simd_traits, internal::logical_andnot_op);
 
 
 // math functions
-NDARRAY_BINARY_FUNC(min, internal::min1_simd);
+NDARRAY_BINARY_FUNC(min, internal::min1_simd, min_simd_traits, internal::min_op);
 
-NDARRAY_BINARY_FUNC(max, internal::max1_simd);
+NDARRAY_BINARY_FUNC(max, internal::max1_simd, max_simd_traits, internal::max_op);
     
 NDARRAY_UNARY_FUNC(sqrt, internal::sqrt1_simd);
 
@@ -491,7 +897,19 @@ NDARRAY_UNARY_FUNC(sin, internal::sin1_simd);
 
 NDARRAY_UNARY_FUNC(cos, internal::cos1_simd);
 
-NDARRAY_UNARY_FUNC(sincos, internal::sincos1_simd);
+template <typename T>
+std::pair<ndarray<T>, ndarray<T>> ndarray<T>::sincos() {
+    std::pair<ndarray<T>, ndarray<T>> result(ndarray<T>(__shape, uninitialized), ndarray<T>(__shape, uninitialized));
+    sincos(result.first, result.second);
+    return result;
+}
+
+template <typename T>
+void ndarray<T>::sincos(ndarray<T>& sin_out, ndarray<T>& cos_out) {
+    if (sin_out.__shape != __shape || cos_out.__shape != __shape)
+        throw std::invalid_argument("Output array shape does not match.");
+    internal::sincos1_simd(__data.data(), sin_out.__data.data(), cos_out.__data.data(), __size);
+}
 
 NDARRAY_UNARY_FUNC(tan, internal::tan1_simd);
 
@@ -501,9 +919,117 @@ NDARRAY_UNARY_FUNC(acos, internal::acos1_simd);
 
 NDARRAY_UNARY_FUNC(atan, internal::atan1_simd);
 
+NDARRAY_UNARY_FUNC(exp, internal::exp1_simd);
+
+NDARRAY_UNARY_FUNC(exp2, internal::exp2_1_simd);
+
+NDARRAY_UNARY_FUNC(expm1, internal::expm1_1_simd);
+
+NDARRAY_UNARY_FUNC(log1p, internal::log1p_1_simd);
+
+NDARRAY_UNARY_FUNC(tanh, internal::tanh1_simd);
+
+NDARRAY_UNARY_FUNC(sigmoid, internal::sigmoid1_simd);
+
+NDARRAY_BINARY_FUNC(pow, internal::pow1_simd, pow_simd_traits, internal::pow_op);
+
+template <typename T>
+ndarray<T> ndarray<T>::softmax(int axis) {
+    const auto extents = axis_extents(axis);
+    ndarray<T> result_ndarray(__shape, uninitialized);
+    internal::softmax_axis(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], extents[2]);
+    return result_ndarray;
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::logsumexp(int axis) {
+    const auto extents = axis_extents(axis);
+    ndarray<T> result_ndarray(reduced_shape(axis), uninitialized);
+    internal::logsumexp_axis(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], extents[2]);
+    return result_ndarray;
+}
+
+
+// reduction functions
+NDARRAY_REDUCE_FUNC(sum, internal::sum1_simd, internal::sum_axis, false);
+
+NDARRAY_REDUCE_FUNC(prod, internal::prod1_simd, internal::prod_axis, false);
+
+NDARRAY_REDUCE_FUNC(min, internal::amin1_simd, internal::amin_axis, true);
+
+NDARRAY_REDUCE_FUNC(max, internal::amax1_simd, internal::amax_axis, true);
+
+NDARRAY_ARG_REDUCE_FUNC(argmin, internal::argmin1_simd, internal::argmin_axis);
+
+NDARRAY_ARG_REDUCE_FUNC(argmax, internal::argmax1_simd, internal::argmax_axis);
+
+template <typename T>
+T ndarray<T>::mean() const {
+    static_assert(std::is_floating_point<T>::value, "mean needs a floating-point type.");
+    return internal::sum1_simd(__data.data(), __size) / static_cast<T>(__size);
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::mean(int axis) const {
+    const auto extents = axis_extents(axis);
+    ndarray<T> result_ndarray(reduced_shape(axis), uninitialized);
+    internal::mean_axis(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], extents[2]);
+    return result_ndarray;
+}
+
+
+// statistics functions
+template <typename T>
+T ndarray<T>::var(ddof_t ddof) const {
+    if (ddof.value >= __size)
+        throw std::invalid_argument("ddof must be less than the array size.");
+
+    return internal::var1_simd(__data.data(), __size, ddof.value);
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::var(int axis, size_t ddof) const {
+    const auto extents = axis_extents(axis);
+    ndarray<T> result_ndarray(reduced_shape(axis), uninitialized);
+    internal::var_axis(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], extents[2], ddof);
+    return result_ndarray;
+}
+
+template <typename T>
+T ndarray<T>::std(ddof_t ddof) const {
+    if (ddof.value >= __size)
+        throw std::invalid_argument("ddof must be less than the array size.");
+
+    return internal::std1_simd(__data.data(), __size, ddof.value);
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::std(int axis, size_t ddof) const {
+    const auto extents = axis_extents(axis);
+    ndarray<T> result_ndarray(reduced_shape(axis), uninitialized);
+    internal::std_axis(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], extents[2], ddof);
+    return result_ndarray;
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::cov(bool rowvar, size_t ddof) const {
+    const auto extents = variable_extents(rowvar);
+    ndarray<T> result_ndarray({extents[0], extents[0]}, uninitialized);
+    internal::cov(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], rowvar, ddof);
+    return result_ndarray;
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::corrcoef(bool rowvar) const {
+    const auto extents = variable_extents(rowvar);
+    ndarray<T> result_ndarray({extents[0], extents[0]}, uninitialized);
+    internal::corrcoef(__data.data(), result_ndarray.__data.data(), extents[0], extents[1], rowvar);
+    return result_ndarray;
+}
+
 
 // parallel functions
-NDARRAY_APPLY_FUNC(apply, internal::apply1, internal::apply2);
+NDARRAY_APPLY_FUNC(apply, internal::apply1);
 
 
 // sort functions
@@ -515,99 +1041,178 @@ NDARRAY_SHIFT_FUNC(slli, internal::slli1_simd);
 
 NDARRAY_SHIFT_FUNC(srli, internal::srli1_simd);
 
+NDARRAY_SHIFT_FUNC(srai, internal::srai1_simd);
+
+NDARRAY_BINARY_FUNC(sllv, internal::sllv1_simd, sllv_simd_traits, internal::sllv_op);
+
+NDARRAY_BINARY_FUNC(srlv, internal::srlv1_simd, srlv_simd_traits, internal::srlv_op);
+
 
 // matrix operations
+template <typename T>
+T ndarray<T>::vdot(const ndarray<T>& other) const {
+    if (__size != other.__size)
+        throw std::invalid_argument("vdot needs arrays of the same size.");
+    return internal::dot1_simd(__data.data(), other.__data.data(), __size);
+}
+
 template <typename T>
 ndarray<T> ndarray<T>::dot(const ndarray<T>& other) {
-    if (__shape.size() != 2 || other.__shape.size() != 2)
+    return dot(other.view());
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::dot(const ndarray_view<const T>& other) {
+    return dot<T>(other);
+}
+
+template <typename T>
+template <typename R>
+ndarray<R> ndarray<T>::dot(const ndarray<T>& other) const {
+    return dot<R>(other.view());
+}
+
+template <typename T>
+template <typename R>
+ndarray<R> ndarray<T>::dot(const ndarray_view<const T>& other) const {
+    if (__shape.size() != 2 || other.ndim() != 2)
         throw std::invalid_argument("Only 2D arrays are supported for dot operation.");
     
     const size_t M = __shape[0];
     const size_t K_A = __shape[1];
-    const size_t K_B = other.__shape[0];
-    const size_t N = other.__shape[1];
+    const size_t K_B = other.shape()[0];
+    const size_t N = other.shape()[1];
 
     if (K_A != K_B) {
         throw std::invalid_argument("Matrix dimension mismatch");
     }
 
-    std::vector<std::vector<T>> A_2d(__shape[0], std::vector<T>(__shape[1]));
-    std::vector<std::vector<T>> B_2d(other.__shape[0], std::vector<T>(other.__shape[1]));
-
-    for (size_t i = 0; i < __shape[0]; ++i) {
-        for (size_t j = 0; j < __shape[1]; ++j) {
-            A_2d[i][j] = __data[calculate_offset(i, j)];
-        }
+    typename ndarray<R>::storage_type result(M * N);
+
+    // a view with unit stride on either axis is handed to the kernel as-is
+    // (row-major, or transposed row-major); anything else is packed first
+    const std::vector<size_t>& strides = other.strides();
+    if (strides[1] == 1 || N == 1) {
+        internal::dot(false, false, M, N, K_A, __data.data(), __strides[0],
+                      other.data(), std::max(strides[0], N), result.data(), N);
+    } else if (strides[0] == 1 || K_B == 1) {
+        internal::dot(false, true, M, N, K_A, __data.data(), __strides[0],
+                      other.data(), std::max(strides[1], K_B), result.data(), N);
+    } else {
+        ndarray<T> packed(other);
+        internal::dot(false, false, M, N, K_A, __data.data(), __strides[0],
+                      packed.__data.data(), N, result.data(), N);
     }
     
-    for (size_t i = 0; i < other.__shape[0]; ++i) {
-        for (size_t j = 0; j < other.__shape[1]; ++j) {
-            B_2d[i][j] = other.__data[other.calculate_offset(i, j)];
-        }
-    }
+    return ndarray<R>({M, N}, std::move(result));
+}
 
-    std::vector<std::vector<T>> result_2d = internal::dot(A_2d, B_2d);
+template <typename T>
+template <size_t M, size_t N, size_t K>
+ndarray<T> ndarray<T>::dot_batched(const ndarray<T>& other) const {
+    if (__shape.size() != 3 || __shape[1] != M || __shape[2] != K)
+        throw std::invalid_argument("dot_batched needs a [count, M, K] array.");
 
-    std::vector<size_t> result_shape = {M, N};
-    ndarray<T> result_ndarray(result_shape);
+    const size_t count = __shape[0];
+    const bool shared = other.__shape == std::vector<size_t>{K, N};
+    if (!shared && other.__shape != std::vector<size_t>{count, K, N})
+        throw std::invalid_argument("dot_batched needs a [count, K, N] or [K, N] operand.");
+
+    ndarray<T> result_ndarray({count, M, N}, uninitialized);
+    internal::dot_batched<M, N, K>(__data.data(), other.__data.data(), shared ? 0 : K * N,
+                                   result_ndarray.__data.data(), count);
+
+    return result_ndarray;
+}
+
+template <typename T>
+ndarray<T> ndarray<T>::matmul(const ndarray<T>& other) const {
+    if (__shape.size() < 2 || other.__shape.size() < 2)
+        throw std::invalid_argument("matmul needs arrays with at least two dimensions.");
+
+    const size_t M = __shape[__shape.size() - 2];
+    const size_t K = __shape.back();
+    const size_t N = other.__shape.back();
+
+    if (other.__shape[other.__shape.size() - 2] != K)
+        throw std::invalid_argument("Matrix dimension mismatch");
+
+    const std::vector<size_t> batch_a(__shape.begin(), __shape.end() - 2);
+    const std::vector<size_t> batch_b(other.__shape.begin(), other.__shape.end() - 2);
+    const std::vector<size_t> batch = internal::broadcast_shape(batch_a, batch_b);
+
+    std::vector<size_t> result_shape(batch);
+    result_shape.push_back(M);
+    result_shape.push_back(N);
+    ndarray<T> result_ndarray(result_shape, uninitialized);
+
+    auto product = [](const std::vector<size_t>& dims) {
+        return std::accumulate(dims.begin(), dims.end(), size_t(1), std::multiplies<size_t>());
+    };
+    const size_t count = product(batch);
+    const size_t count_a = product(batch_a), count_b = product(batch_b);
+
+    // a batch that is complete or a single matrix is a fixed stride apart;
+    // any other broadcast picks its matrices through pointer arrays
+    if ((count_a == count || count_a == 1) && (count_b == count || count_b == 1)) {
+        internal::dot_strided_batched(false, false, M, N, K,
+                                      __data.data(), K, count_a == 1 ? 0 : M * K,
+                                      other.__data.data(), N, count_b == 1 ? 0 : K * N,
+                                      result_ndarray.__data.data(), N, M * N, count);
+    } else {
+        const std::vector<size_t> strides_a = internal::broadcast_strides(batch_a, batch);
+        const std::vector<size_t> strides_b = internal::broadcast_strides(batch_b, batch);
+        std::vector<const T *> a(count), b(count);
+        std::vector<T *> c(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            size_t offset_a = 0, offset_b = 0;
+            for (size_t d = batch.size(), rest = i; d-- > 0; rest /= batch[d]) {
+                offset_a += rest % batch[d] * strides_a[d];
+                offset_b += rest % batch[d] * strides_b[d];
+            }
+
+            a[i] = __data.data() + offset_a * M * K;
+            b[i] = other.__data.data() + offset_b * K * N;
+            c[i] = result_ndarray.__data.data() + i * M * N;
+        }
+
+        internal::dot_pointer_batched(false, false, M, N, K, a.data(), K, b.data(), N, c.data(), N, count);
+    }
 
-    for (size_t i = 0; i < M; ++i)
-        for (size_t j = 0; j < N; ++j)
-            result_ndarray.__data[result_ndarray.calculate_offset(i, j)] = result_2d[i][j];
-    
     return result_ndarray;
 }
 
-NDARRAY_ARITH_FUNC(add, internal::add1)
+NDARRAY_ARITH_FUNC(add, internal::add1, add_simd_traits, internal::add_op)
 
-NDARRAY_ARITH_FUNC(sub, internal::subtract1)
+NDARRAY_ARITH_FUNC(sub, internal::subtract1, sub_simd_traits, internal::sub_op)
 
 template <typename T>
 ndarray<T> ndarray<T>::transpose() {
-    if (__shape.size() != 2)
-        throw std::invalid_argument("Only 2D arrays can be transposed.");
+    if (__shape.size() < 2)
+        throw std::invalid_argument("Only arrays with at least two dimensions can be transposed.");
 
-    std::vector<std::vector<T>> mat_2d(__shape[0], std::vector<T>(__shape[1]));
-    
-    for (size_t i = 0; i < __shape[0]; ++i)
-        for (size_t j = 0; j < __shape[1]; ++j)
-            mat_2d[i][j] = __data[calculate_offset(i, j)];
+    // higher ranks reverse the axes through a view and gather once
+    if (__shape.size() != 2)
+        return ndarray<T>(view().transpose());
 
-    std::vector<std::vector<T>> result_2d = internal::transpose(mat_2d);
     std::vector<size_t> result_shape = {__shape[1], __shape[0]};
-    ndarray<T> result_ndarray(result_shape);
-    
-    for (size_t i = 0; i < result_shape[0]; ++i)
-        for (size_t j = 0; j < result_shape[1]; ++j)
-            result_ndarray.__data[result_ndarray.calculate_offset(i, j)] = result_2d[i][j];
+    ndarray<T> result_ndarray(result_shape, uninitialized);
+
+    internal::transpose(__data.data(), __shape[0], __shape[1], __strides[0],
+                        result_ndarray.__data.data(), result_ndarray.__strides[0]);
 
     return result_ndarray;
 }
 
 template <typename T>
 T& ndarray<T>::operator()(const std::vector<size_t>& indices) {
-    if (indices.size() != __shape.size())
-        throw std::out_of_range("Index dimensions do not match array dimensions.");
-
-    if (__shape.size() == 1) 
-        return __data[indices[0]];
-    else if (__shape.size() == 2)
-        return __data[calculate_offset(indices[0], indices[1])];
-    
-    throw std::out_of_range("Invalid index.");
+    return __data[calculate_offset(indices)];
 }
 
 template <typename T>
 const T& ndarray<T>::operator()(const std::vector<size_t>& indices) const {
-    if (indices.size() != __shape.size())
-        throw std::out_of_range("Index dimensions do not match array dimensions.");
-
-    if (__shape.size() == 1)
-        return __data[indices[0]];
-    else if (__shape.size() == 2)
-        return __data[calculate_offset(indices[0], indices[1])];
-
-    throw std::out_of_range("Invalid index.");
+    return __data[calculate_offset(indices)];
 }
 
 
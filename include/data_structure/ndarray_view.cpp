@@ -0,0 +1,251 @@
+// ndarray_view.hpp
+#ifndef NDARRAY_VIEW_HPP
+#define NDARRAY_VIEW_HPP
+
+#include <vector>
+#include <cstddef>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+// A non-owning, strided window onto a buffer owned by an ndarray. Slicing,
+// reshaping and transposing a view only rewrites its shape/strides, so they
+// are O(1). The view must not outlive the array it was taken from.
+template <typename T>
+class ndarray_view {
+private:
+    T *__ptr;
+    std::vector<size_t> __shape;
+    std::vector<size_t> __strides;
+    size_t __size;
+
+public:
+    ndarray_view(T *ptr, const std::vector<size_t>& shape, const std::vector<size_t>& strides);
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    ndarray_view(const ndarray_view<U>& other)
+        : ndarray_view(other.data(), other.shape(), other.strides()) {}
+
+    size_t ndim() const noexcept;
+
+    size_t size() const noexcept;
+
+    const std::vector<size_t>& shape() const noexcept;
+
+    const std::vector<size_t>& strides() const noexcept;
+
+    T *data() const noexcept;
+
+    bool is_contiguous() const noexcept;
+
+
+public:
+    ndarray_view<T> slice(size_t axis, size_t start, size_t stop, size_t step = 1) const;
+
+    ndarray_view<T> reshape(const std::vector<size_t>& shape) const;
+
+    ndarray_view<T> transpose() const;
+
+    ndarray_view<T> transpose(const std::vector<size_t>& axes) const;
+
+
+    // access element
+    T& operator()(const std::vector<size_t>& indices) const;
+};
+
+
+namespace internal {
+    // strided_copy
+    template <typename T>
+    void strided_copy(const T *src, const std::vector<size_t>& shape,
+                      const std::vector<size_t>& strides, T *dst);
+}
+
+
+template <typename T>
+ndarray_view<T>::ndarray_view(T *ptr, const std::vector<size_t>& shape, const std::vector<size_t>& strides)
+    : __ptr(ptr), __shape(shape), __strides(strides) {
+    if (shape.empty())
+        throw std::invalid_argument("Shape cannot be empty");
+
+    if (shape.size() != strides.size())
+        throw std::invalid_argument("Shape and strides must have the same length.");
+
+    __size = std::accumulate(
+        shape.begin(), shape.end(),
+        static_cast<size_t>(1), std::multiplies<size_t>()
+    );
+}
+
+template <typename T>
+size_t ndarray_view<T>::ndim() const noexcept {
+    return __shape.size();
+}
+
+template <typename T>
+size_t ndarray_view<T>::size() const noexcept {
+    return __size;
+}
+
+template <typename T>
+const std::vector<size_t>& ndarray_view<T>::shape() const noexcept {
+    return __shape;
+}
+
+template <typename T>
+const std::vector<size_t>& ndarray_view<T>::strides() const noexcept {
+    return __strides;
+}
+
+template <typename T>
+T *ndarray_view<T>::data() const noexcept {
+    return __ptr;
+}
+
+template <typename T>
+bool ndarray_view<T>::is_contiguous() const noexcept {
+    size_t expected = 1;
+    for (int i = static_cast<int>(__shape.size()) - 1; i >= 0; --i) {
+        if (__shape[i] != 1 && __strides[i] != expected)
+            return false;
+
+        expected *= __shape[i];
+    }
+
+    return true;
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::slice(size_t axis, size_t start, size_t stop, size_t step) const {
+    if (axis >= __shape.size())
+        throw std::out_of_range("Axis out of range.");
+
+    if (step == 0)
+        throw std::invalid_argument("Slice step cannot be zero.");
+
+    if (start > stop || stop > __shape[axis])
+        throw std::out_of_range("Slice bounds out of range.");
+
+    std::vector<size_t> shape = __shape;
+    std::vector<size_t> strides = __strides;
+
+    shape[axis] = (stop - start + step - 1) / step;
+    strides[axis] = __strides[axis] * step;
+
+    if (shape[axis] == 0)
+        throw std::invalid_argument("Slice cannot be empty.");
+
+    return ndarray_view<T>(__ptr + start * __strides[axis], shape, strides);
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::reshape(const std::vector<size_t>& shape) const {
+    size_t size = std::accumulate(
+        shape.begin(), shape.end(),
+        static_cast<size_t>(1), std::multiplies<size_t>()
+    );
+
+    if (shape.empty() || size != __size)
+        throw std::invalid_argument("Cannot reshape to a different number of elements.");
+
+    if (!is_contiguous())
+        throw std::invalid_argument("Cannot reshape a non-contiguous view without copying.");
+
+    std::vector<size_t> strides(shape.size());
+    strides.back() = 1;
+    for (int i = static_cast<int>(shape.size()) - 2; i >= 0; --i)
+        strides[i] = strides[i + 1] * shape[i + 1];
+
+    return ndarray_view<T>(__ptr, shape, strides);
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::transpose() const {
+    std::vector<size_t> axes(__shape.size());
+    for (size_t i = 0; i < axes.size(); ++i)
+        axes[i] = axes.size() - 1 - i;
+
+    return transpose(axes);
+}
+
+template <typename T>
+ndarray_view<T> ndarray_view<T>::transpose(const std::vector<size_t>& axes) const {
+    if (axes.size() != __shape.size())
+        throw std::invalid_argument("Axes do not match array dimensions.");
+
+    std::vector<bool> seen(axes.size(), false);
+    std::vector<size_t> shape(axes.size());
+    std::vector<size_t> strides(axes.size());
+
+    for (size_t i = 0; i < axes.size(); ++i) {
+        if (axes[i] >= axes.size() || seen[axes[i]])
+            throw std::invalid_argument("Axes must be a permutation of the array dimensions.");
+
+        seen[axes[i]] = true;
+        shape[i] = __shape[axes[i]];
+        strides[i] = __strides[axes[i]];
+    }
+
+    return ndarray_view<T>(__ptr, shape, strides);
+}
+
+template <typename T>
+T& ndarray_view<T>::operator()(const std::vector<size_t>& indices) const {
+    if (indices.size() != __shape.size())
+        throw std::out_of_range("Index dimensions do not match array dimensions.");
+
+    size_t offset = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= __shape[i])
+            throw std::out_of_range("Invalid index.");
+
+        offset += indices[i] * __strides[i];
+    }
+
+    return __ptr[offset];
+}
+
+
+namespace internal {
+    // strided_copy
+    template <typename T>
+    void strided_copy(const T *src, const std::vector<size_t>& shape,
+                      const std::vector<size_t>& strides, T *dst) {
+        const size_t ndim = shape.size();
+        const size_t inner = shape[ndim - 1];
+        const size_t inner_stride = strides[ndim - 1];
+        const size_t rows = std::accumulate(
+            shape.begin(), shape.end() - 1,
+            static_cast<size_t>(1), std::multiplies<size_t>()
+        );
+
+        std::vector<size_t> index(ndim, 0);
+        size_t offset = 0;
+
+        for (size_t row = 0; row < rows; ++row) {
+            const T *src_row = src + offset;
+
+            if (inner_stride == 1) {
+                std::copy(src_row, src_row + inner, dst);
+            } else {
+                for (size_t j = 0; j < inner; ++j)
+                    dst[j] = src_row[j * inner_stride];
+            }
+            dst += inner;
+
+            // advance the outer index like an odometer
+            for (int d = static_cast<int>(ndim) - 2; d >= 0; --d) {
+                offset += strides[d];
+                if (++index[d] < shape[d])
+                    break;
+
+                offset -= strides[d] * shape[d];
+                index[d] = 0;
+            }
+        }
+    }
+}
+
+
+#endif // NDARRAY_VIEW_HPP
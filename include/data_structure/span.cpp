@@ -0,0 +1,36 @@
+// span.hpp
+#ifndef SPAN_HPP
+#define SPAN_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+// Non-owning (pointer, length) view of contiguous elements, a stand-in for
+// C++20 std::span.
+template <typename T>
+class span {
+private:
+    T *__ptr;
+    size_t __size;
+
+public:
+    span(T *ptr, size_t size) noexcept : __ptr(ptr), __size(size) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    span(const span<U>& other) noexcept : __ptr(other.data()), __size(other.size()) {}
+
+    T *data() const noexcept { return __ptr; }
+
+    size_t size() const noexcept { return __size; }
+
+    bool empty() const noexcept { return __size == 0; }
+
+    T *begin() const noexcept { return __ptr; }
+
+    T *end() const noexcept { return __ptr + __size; }
+
+    T& operator[](size_t i) const noexcept { return __ptr[i]; }
+};
+
+
+#endif // SPAN_HPP
@@ -0,0 +1,508 @@
+#ifndef EXPRESSION_HPP
+#define EXPRESSION_HPP
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "simd_traits.cpp"
+#include "xsimd_traits.cpp"
+#include "utils/simd_operators.cpp"
+
+// Lazy elementwise expressions. Each op on a lazy_expr only records a node;
+// the whole chain runs as one loop when the expression is materialised, so
+// a.sub(b).abs().sqrt() reads a and b once and writes the result once.
+// Nodes hold raw pointers into their source arrays and must not outlive them.
+
+#define LAZY_SCALAR_UNARY_OP(name, expr) \
+struct name##_op { \
+    template <typename T> \
+    T operator()(const T& a) const { return static_cast<T>(expr); } \
+};
+
+#define LAZY_SCALAR_BINARY_OP(name, expr) \
+struct name##_op { \
+    template <typename T> \
+    T operator()(const T& a, const T& b) const { return static_cast<T>(expr); } \
+};
+
+#define LAZY_SCALAR_SHIFT_OP(name, expr) \
+struct name##_op { \
+    template <typename T> \
+    T operator()(const T& a, const int imm) const { return static_cast<T>(expr); } \
+};
+
+#define LAZY_UNARY_FUNC(func_name, traits) \
+template <typename T, typename Node> \
+auto lazy_expr<T, Node>::func_name() const { \
+    using node_type = internal::unary_node<T, traits, internal::func_name##_op, Node>; \
+    return lazy_expr<T, node_type>(node_type{__node}, *__shape); \
+}
+
+#define LAZY_BINARY_FUNC(func_name, traits) \
+template <typename T, typename Node> \
+template <typename Other> \
+auto lazy_expr<T, Node>::func_name(const Other& other) const { \
+    auto rhs = internal::as_lazy(other); \
+    if (*__shape != rhs.shape()) \
+        throw std::invalid_argument("Shapes of the two ndarrays do not match."); \
+    using node_type = internal::binary_node<T, traits, internal::func_name##_op, Node, typename decltype(rhs)::node_type>; \
+    return lazy_expr<T, node_type>(node_type{__node, rhs.node()}, *__shape); \
+}
+
+#define LAZY_SHIFT_FUNC(func_name, traits) \
+template <typename T, typename Node> \
+auto lazy_expr<T, Node>::func_name(const int imm) const { \
+    using node_type = internal::shift_node<T, traits, internal::func_name##_op, Node>; \
+    return lazy_expr<T, node_type>(node_type{__node, imm}, *__shape); \
+}
+
+template <typename T, typename Node>
+class lazy_expr {
+private:
+    Node __node;
+    const std::vector<size_t> *__shape;
+    size_t __size;
+
+public:
+    using node_type = Node;
+
+    lazy_expr(const Node& node, const std::vector<size_t>& shape);
+
+    const std::vector<size_t>& shape() const noexcept;
+
+    size_t size() const noexcept;
+
+    const Node& node() const noexcept;
+
+    // run the fused loop; result may alias any of the source arrays
+    void eval(T *result) const;
+
+
+public:
+    // logical function
+    template <typename Other>
+    auto logical_and(const Other& other) const;
+
+    template <typename Other>
+    auto logical_or(const Other& other) const;
+
+    template <typename Other>
+    auto logical_xor(const Other& other) const;
+
+    template <typename Other>
+    auto logical_andnot(const Other& other) const;
+
+
+    // math function
+    template <typename Other>
+    auto min(const Other& other) const;
+
+    template <typename Other>
+    auto max(const Other& other) const;
+
+    auto sqrt() const;
+
+    auto rsqrt() const;
+
+    auto round() const;
+
+    auto ceil() const;
+
+    auto floor() const;
+
+    auto abs() const;
+
+    auto log() const;
+
+    auto log2() const;
+
+    auto log10() const;
+
+    auto sin() const;
+
+    auto cos() const;
+
+    auto tan() const;
+
+    auto asin() const;
+
+    auto acos() const;
+
+    auto atan() const;
+
+    auto exp() const;
+
+    auto exp2() const;
+
+    auto expm1() const;
+
+    auto log1p() const;
+
+    auto tanh() const;
+
+    auto sigmoid() const;
+
+    template <typename Other>
+    auto pow(const Other& other) const;
+
+
+    // shift function
+    auto slli(const int imm) const;
+
+    auto srli(const int imm) const;
+
+    auto srai(const int imm) const;
+
+    template <typename Other>
+    auto sllv(const Other& other) const;
+
+    template <typename Other>
+    auto srlv(const Other& other) const;
+
+
+    // matrix operations
+    template <typename Other>
+    auto add(const Other& other) const;
+
+    template <typename Other>
+    auto sub(const Other& other) const;
+};
+
+
+namespace internal {
+    // scalar ops, used for the tail and for types without SIMD traits
+    LAZY_SCALAR_BINARY_OP(logical_and, a & b)
+    LAZY_SCALAR_BINARY_OP(logical_or, a | b)
+    LAZY_SCALAR_BINARY_OP(logical_xor, a ^ b)
+    LAZY_SCALAR_BINARY_OP(logical_andnot, ~a & b)
+    LAZY_SCALAR_BINARY_OP(min, std::min(a, b))
+    LAZY_SCALAR_BINARY_OP(max, std::max(a, b))
+    LAZY_SCALAR_BINARY_OP(add, a + b)
+    LAZY_SCALAR_BINARY_OP(sub, a - b)
+    LAZY_SCALAR_UNARY_OP(sqrt, std::sqrt(a))
+    LAZY_SCALAR_UNARY_OP(rsqrt, 1 / std::sqrt(a))
+    LAZY_SCALAR_UNARY_OP(round, std::round(a))
+    LAZY_SCALAR_UNARY_OP(ceil, std::ceil(a))
+    LAZY_SCALAR_UNARY_OP(floor, std::floor(a))
+    LAZY_SCALAR_UNARY_OP(abs, std::abs(a))
+    LAZY_SCALAR_UNARY_OP(log, std::log(a))
+    LAZY_SCALAR_UNARY_OP(log2, std::log2(a))
+    LAZY_SCALAR_UNARY_OP(log10, std::log10(a))
+    LAZY_SCALAR_UNARY_OP(sin, std::sin(a))
+    LAZY_SCALAR_UNARY_OP(cos, std::cos(a))
+    LAZY_SCALAR_UNARY_OP(tan, std::tan(a))
+    LAZY_SCALAR_UNARY_OP(asin, std::asin(a))
+    LAZY_SCALAR_UNARY_OP(acos, std::acos(a))
+    LAZY_SCALAR_UNARY_OP(atan, std::atan(a))
+    LAZY_SCALAR_UNARY_OP(exp, std::exp(a))
+    LAZY_SCALAR_UNARY_OP(exp2, std::exp2(a))
+    LAZY_SCALAR_UNARY_OP(expm1, std::expm1(a))
+    LAZY_SCALAR_UNARY_OP(log1p, std::log1p(a))
+    LAZY_SCALAR_UNARY_OP(tanh, std::tanh(a))
+    LAZY_SCALAR_UNARY_OP(sigmoid, 1 / (1 + std::exp(-a)))
+    LAZY_SCALAR_BINARY_OP(pow, std::pow(a, b))
+    LAZY_SCALAR_SHIFT_OP(slli, shift_left(a, imm))
+    LAZY_SCALAR_SHIFT_OP(srli, shift_right_logical(a, imm))
+    LAZY_SCALAR_SHIFT_OP(srai, shift_right_arith(a, imm))
+    LAZY_SCALAR_BINARY_OP(sllv, shift_left(a, b))
+    LAZY_SCALAR_BINARY_OP(srlv, shift_right_logical(a, b))
+
+
+    // simd_step_of: Traits::step, or 0 when no specialisation exists here
+    template <typename Traits, typename = void>
+    struct simd_step_of : std::integral_constant<size_t, 0> {};
+
+    template <typename Traits>
+    struct simd_step_of<Traits, std::enable_if_t<has_simd_traits<Traits>::value>>
+        : std::integral_constant<size_t, Traits::step> {};
+
+    // a node can join the fused SIMD loop when its own traits exist and its
+    // children either accept any width (leaves) or run at the same width
+    template <size_t Step, typename... Children>
+    constexpr bool fusable() {
+        return Step != 0 && ((Children::vectorizable && (Children::step == 0 || Children::step == Step)) && ...);
+    }
+
+    // hand a register produced under From to an op expecting To; the traits
+    // of different ops may use different register types for the same lanes
+    template <typename From, typename To>
+    SIMD_TARGET_AVX2 typename To::simd_type convert_simd(typename From::simd_type value);
+
+
+    // leaf_node
+    template <typename T>
+    struct leaf_node {
+        const T *ptr;
+
+        static constexpr size_t step = 0;
+        static constexpr bool vectorizable = true;
+
+        T eval(size_t i) const { return ptr[i]; }
+
+        template <typename Out, typename... Mask>
+        SIMD_TARGET_AVX2 typename Out::simd_type eval_simd(size_t i, Mask... mask) const;
+    };
+
+    // unary_node
+    template <typename T, template <typename> class Traits, typename Op, typename Child>
+    struct unary_node {
+        Child child;
+
+        using traits = Traits<T>;
+        static constexpr size_t step = simd_step_of<traits>::value;
+        static constexpr bool vectorizable = fusable<step, Child>();
+
+        T eval(size_t i) const { return Op()(child.eval(i)); }
+
+        template <typename Out, typename... Mask>
+        SIMD_TARGET_AVX2 typename Out::simd_type eval_simd(size_t i, Mask... mask) const;
+    };
+
+    // shift_node
+    template <typename T, template <typename> class Traits, typename Op, typename Child>
+    struct shift_node {
+        Child child;
+        int imm;
+
+        using traits = Traits<T>;
+        static constexpr size_t step = simd_step_of<traits>::value;
+        static constexpr bool vectorizable = fusable<step, Child>();
+
+        T eval(size_t i) const { return Op()(child.eval(i), imm); }
+
+        template <typename Out, typename... Mask>
+        SIMD_TARGET_AVX2 typename Out::simd_type eval_simd(size_t i, Mask... mask) const;
+    };
+
+    // binary_node
+    template <typename T, template <typename> class Traits, typename Op, typename Lhs, typename Rhs>
+    struct binary_node {
+        Lhs lhs;
+        Rhs rhs;
+
+        using traits = Traits<T>;
+        static constexpr size_t step = simd_step_of<traits>::value;
+        static constexpr bool vectorizable = fusable<step, Lhs, Rhs>();
+
+        T eval(size_t i) const { return Op()(lhs.eval(i), rhs.eval(i)); }
+
+        template <typename Out, typename... Mask>
+        SIMD_TARGET_AVX2 typename Out::simd_type eval_simd(size_t i, Mask... mask) const;
+    };
+
+
+    // as_lazy: binary ops take either an expression or anything with lazy()
+    template <typename T, typename Node>
+    const lazy_expr<T, Node>& as_lazy(const lazy_expr<T, Node>& expr) {
+        return expr;
+    }
+
+    template <typename Array>
+    auto as_lazy(const Array& array) {
+        return array.lazy();
+    }
+
+
+    // evaluate_simd: the fused loop over [begin, end), built for AVX2 and only
+    // entered once the CPU has been checked
+    template <typename T, typename Node>
+    SIMD_TARGET_AVX2 void evaluate_simd(const Node& node, T *result, size_t begin, size_t end);
+
+
+    // evaluate
+    template <typename T, typename Node>
+    void evaluate(const Node& node, T *result, size_t n) {
+        parallel_chunks<T>(n, [&](size_t begin, size_t end) {
+            #if SIMD_HAS_AVX2
+                if constexpr (Node::vectorizable && Node::step != 0) {
+                    if (use_avx2<typename Node::traits>(end - begin)) {
+                        evaluate_simd(node, result, begin, end);
+                        return;
+                    }
+                }
+            #endif
+
+            for (size_t i = begin; i < end; ++i)
+                result[i] = node.eval(i);
+        });
+    }
+}
+
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX2_BEGIN
+
+namespace internal {
+    // convert_simd: traits with the same lanes share one 256-bit register,
+    // which only changes type (e.g. __m256 and xsimd::batch<float, avx2>)
+    template <typename From, typename To>
+    typename To::simd_type convert_simd(typename From::simd_type value) {
+        if constexpr (std::is_same_v<typename From::scalar_type, typename To::scalar_type>
+                      && From::step == To::step) {
+            return static_cast<typename To::simd_type>(value);
+        } else {
+            typename From::scalar_type lanes[From::step];
+            From::store(lanes, value);
+            return To::load(lanes);
+        }
+    }
+
+
+    // leaf_node
+    template <typename T>
+    template <typename Out, typename... Mask>
+    typename Out::simd_type leaf_node<T>::eval_simd(size_t i, Mask... mask) const {
+        return load_lanes<Out>(ptr + i, mask...);
+    }
+
+    // unary_node
+    template <typename T, template <typename> class Traits, typename Op, typename Child>
+    template <typename Out, typename... Mask>
+    typename Out::simd_type unary_node<T, Traits, Op, Child>::eval_simd(size_t i, Mask... mask) const {
+        auto value = traits::op(child.template eval_simd<traits>(i, mask...));
+        return convert_simd<traits, Out>(value);
+    }
+
+    // shift_node
+    template <typename T, template <typename> class Traits, typename Op, typename Child>
+    template <typename Out, typename... Mask>
+    typename Out::simd_type shift_node<T, Traits, Op, Child>::eval_simd(size_t i, Mask... mask) const {
+        auto value = traits::op(child.template eval_simd<traits>(i, mask...), imm);
+        return convert_simd<traits, Out>(value);
+    }
+
+    // binary_node
+    template <typename T, template <typename> class Traits, typename Op, typename Lhs, typename Rhs>
+    template <typename Out, typename... Mask>
+    typename Out::simd_type binary_node<T, Traits, Op, Lhs, Rhs>::eval_simd(size_t i, Mask... mask) const {
+        auto value = traits::op(lhs.template eval_simd<traits>(i, mask...), rhs.template eval_simd<traits>(i, mask...));
+        return convert_simd<traits, Out>(value);
+    }
+
+
+    // evaluate_simd
+    template <typename T, typename Node>
+    void evaluate_simd(const Node& node, T *result, size_t begin, size_t end) {
+        using Traits = typename Node::traits;
+
+        simd_loop<Traits>(result + begin, end - begin,
+            [&](size_t i, auto... mask) { return node.template eval_simd<Traits>(begin + i, mask...); },
+            [&](size_t i) { return node.eval(begin + i); });
+    }
+}
+
+SIMD_TARGET_END
+#endif
+
+
+template <typename T, typename Node>
+lazy_expr<T, Node>::lazy_expr(const Node& node, const std::vector<size_t>& shape)
+    : __node(node), __shape(&shape) {
+    __size = 1;
+    for (size_t dim : shape)
+        __size *= dim;
+}
+
+template <typename T, typename Node>
+const std::vector<size_t>& lazy_expr<T, Node>::shape() const noexcept {
+    return *__shape;
+}
+
+template <typename T, typename Node>
+size_t lazy_expr<T, Node>::size() const noexcept {
+    return __size;
+}
+
+template <typename T, typename Node>
+const Node& lazy_expr<T, Node>::node() const noexcept {
+    return __node;
+}
+
+template <typename T, typename Node>
+void lazy_expr<T, Node>::eval(T *result) const {
+    internal::evaluate(__node, result, __size);
+}
+
+
+// logical functions
+LAZY_BINARY_FUNC(logical_and, and_simd_traits)
+
+LAZY_BINARY_FUNC(logical_or, or_simd_traits)
+
+LAZY_BINARY_FUNC(logical_xor, xor_simd_traits)
+
+LAZY_BINARY_FUNC(logical_andnot, andnot_simd_traits)
+
+
+// math functions
+LAZY_BINARY_FUNC(min, min_simd_traits)
+
+LAZY_BINARY_FUNC(max, max_simd_traits)
+
+LAZY_UNARY_FUNC(sqrt, sqrt_simd_traits)
+
+LAZY_UNARY_FUNC(rsqrt, rsqrt_simd_traits)
+
+LAZY_UNARY_FUNC(round, round_simd_traits)
+
+LAZY_UNARY_FUNC(ceil, ceil_simd_traits)
+
+LAZY_UNARY_FUNC(floor, floor_simd_traits)
+
+LAZY_UNARY_FUNC(abs, abs_simd_traits)
+
+LAZY_UNARY_FUNC(log, log_simd_traits)
+
+LAZY_UNARY_FUNC(log2, log2_simd_traits)
+
+LAZY_UNARY_FUNC(log10, log10_simd_traits)
+
+LAZY_UNARY_FUNC(sin, sin_simd_traits)
+
+LAZY_UNARY_FUNC(cos, cos_simd_traits)
+
+LAZY_UNARY_FUNC(tan, tan_simd_traits)
+
+LAZY_UNARY_FUNC(asin, asin_simd_traits)
+
+LAZY_UNARY_FUNC(acos, acos_simd_traits)
+
+LAZY_UNARY_FUNC(atan, atan_simd_traits)
+
+LAZY_UNARY_FUNC(exp, exp_simd_traits)
+
+LAZY_UNARY_FUNC(exp2, exp2_simd_traits)
+
+LAZY_UNARY_FUNC(expm1, expm1_simd_traits)
+
+LAZY_UNARY_FUNC(log1p, log1p_simd_traits)
+
+LAZY_UNARY_FUNC(tanh, tanh_simd_traits)
+
+LAZY_UNARY_FUNC(sigmoid, sigmoid_simd_traits)
+
+LAZY_BINARY_FUNC(pow, pow_simd_traits)
+
+
+// shift functions
+LAZY_SHIFT_FUNC(slli, slli_simd_traits)
+
+LAZY_SHIFT_FUNC(srli, srli_simd_traits)
+
+LAZY_SHIFT_FUNC(srai, srai_simd_traits)
+
+LAZY_BINARY_FUNC(sllv, sllv_simd_traits)
+
+LAZY_BINARY_FUNC(srlv, srlv_simd_traits)
+
+
+// matrix operations
+LAZY_BINARY_FUNC(add, add_simd_traits)
+
+LAZY_BINARY_FUNC(sub, sub_simd_traits)
+
+
+#endif
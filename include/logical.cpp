@@ -5,9 +5,6 @@
 #include "simd_traits.cpp"
 #include "utils/utils.cpp"
 #include "utils/simd_operators.cpp"
-#ifdef __AVX2__
-    #include <immintrin.h>
-#endif
     #include <stdexcept>
 
 namespace internal {
@@ -16,21 +13,33 @@ namespace internal {
     template <typename T>
     std::vector<T> and1_simd(const std::vector<T>& A, const std::vector<T>& B);
 
+    template <typename T>
+    void and1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // or1
     template <typename T>
     std::vector<T> or1_simd(const std::vector<T>& A, const std::vector<T>& B);
 
+    template <typename T>
+    void or1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // xor1
     template <typename T>
     std::vector<T> xor1_simd(const std::vector<T>& A, const std::vector<T>& B);
 
+    template <typename T>
+    void xor1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // andnot1
     template <typename T>
     std::vector<T> andnot1_simd(const std::vector<T>& A, const std::vector<T>& B);
 
+    template <typename T>
+    void andnot1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // testc1
     template <typename T>
@@ -64,70 +73,100 @@ namespace internal {
     // =========================== 1D ======================================
 
     // and1_simd
+    template <typename T>
+    void and1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, and_simd_traits>(A, B, result, n, [](const T& element1, const T& element2) { return element1 & element2; });
+    }
+
     template <typename T>
     std::vector<T> and1_simd(const std::vector<T>& A, const std::vector<T>& B) {
-        if (A.size() < 32)
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return element1 & element2; });
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
 
-        #ifdef __riscv
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return element1 & element2; });
-        #endif
-        
-        #ifdef __AVX2__
-            return apply_binary_op_simd<T, and_simd_traits<T>>(A, B, [](const T& element1, const T& element2) { return element1 & element2; });
-        #endif
+        std::vector<T> result(A.size());
+        and1_simd(A.data(), B.data(), result.data(), A.size());
+
+        return result;
     }
 
 
     // or1_simd
+    template <typename T>
+    void or1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, or_simd_traits>(A, B, result, n, [](const T& element1, const T& element2) { return element1 | element2; });
+    }
+
     template <typename T>
     std::vector<T> or1_simd(const std::vector<T>& A, const std::vector<T>& B) {
-        if (A.size() < 32)
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return element1 | element2; });
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
 
-        #ifdef __riscv
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return element1 | element2; });
-        #endif
+        std::vector<T> result(A.size());
+        or1_simd(A.data(), B.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_binary_op_simd<T, or_simd_traits<T>>(A, B, [](const T& element1, const T& element2) { return element1 | element2; });
-        #endif
+        return result;
     }
 
 
     // xor1_simd
+    template <typename T>
+    void xor1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, xor_simd_traits>(A, B, result, n, [](const T& element1, const T& element2) { return element1 ^ element2; });
+    }
+
     template <typename T>
     std::vector<T> xor1_simd(const std::vector<T>& A, const std::vector<T>& B) {
-        if (A.size() < 32)
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return element1 ^ element2; });
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
 
-        #ifdef __riscv
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return element1 ^ element2; });
-        #endif
+        std::vector<T> result(A.size());
+        xor1_simd(A.data(), B.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_binary_op_simd<T, xor_simd_traits<T>>(A, B, [](const T& element1, const T& element2) { return element1 ^ element2; });
-        #endif
+        return result;
     }
 
 
     // andnot1_simd
+    template <typename T>
+    void andnot1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, andnot_simd_traits>(A, B, result, n, [](const T& element1, const T& element2) { return ~element1 & element2; });
+    }
+
     template <typename T>
     std::vector<T> andnot1_simd(const std::vector<T>& A, const std::vector<T>& B) {
-        if (A.size() < 32)
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return ~element1 & element2; });
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
 
-        #ifdef __riscv
-            return apply_binary_op_plain(A, B, [](const T& element1, const T& element2) { return ~element1 & element2; });
-        #endif
+        std::vector<T> result(A.size());
+        andnot1_simd(A.data(), B.data(), result.data(), A.size());
 
-        #ifdef __AVX2__ 
-            return apply_binary_op_simd<T, andnot_simd_traits<T>>(A, B, [](const T& element1, const T& element2) { return ~element1 & element2; });
-        #endif
+        return result;
+    }
+
+
+    #if SIMD_HAS_AVX2
+    SIMD_TARGET_AVX2_BEGIN
+
+    // testc1_avx2: testc over the whole registers of A and B; returns how
+    // many elements were consumed so the caller finishes the tail
+    template <typename T>
+    size_t testc1_avx2(const T *A, const T *B, size_t n, int& result) {
+        const size_t simd_step = testc_simd_traits<T>::step;
+        size_t i = 0;
+
+        for (; i + simd_step <= n; i += simd_step) {
+            auto vec_a = testc_simd_traits<T>::load(&A[i]);
+            auto vec_b = testc_simd_traits<T>::load(&B[i]);
+            result &= testc_simd_traits<T>::bitwise_testc(vec_a, vec_b);
+        }
+
+        return i;
     }
 
+    SIMD_TARGET_END
+    #endif
+
 
-    #ifdef __AVX2__
     // testc1_simd
     template <typename T>
     int testc1_simd(const std::vector<T>& A, const std::vector<T>& B) {
@@ -135,14 +174,12 @@ namespace internal {
             throw std::invalid_argument("Input vectors must have the same size.");
 
         int result = 1;
-        const size_t simd_step = andnot_simd_traits<T>::step;
         size_t i = 0;
 
-        for (; i <= A.size() - simd_step; i += simd_step) {
-            auto vec_a = testc_simd_traits<T>::load(&A[i]);
-            auto vec_b = testc_simd_traits<T>::load(&B[i]);
-            result &= testc_simd_traits<T>::bitwise_testc(vec_a, vec_b);
-        }
+        #if SIMD_HAS_AVX2
+            if (simd_level_at_least(simd_level::avx2))
+                i = testc1_avx2(A.data(), B.data(), A.size(), result);
+        #endif
 
         for (; i < A.size(); ++i)
             result &= !(~A[i] & B[i]);
@@ -150,40 +187,35 @@ namespace internal {
         return result;
     }
 
-    #endif
-
 
     // =========================== 2D ======================================
 
-    #ifdef __AVX2__
     // and2_simd
     template <typename T>
     std::vector<std::vector<T>> and2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B) {
-        return apply_binary_op(A, B, and1_simd<T>);
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) { return and1_simd(a, b); });
     }
 
 
     // or2_simd
     template <typename T>
     std::vector<std::vector<T>> or2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B) {
-        return apply_binary_op(A, B, or1_simd<T>);
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) { return or1_simd(a, b); });
     }
 
 
     // xor2_simd
     template <typename T>
     std::vector<std::vector<T>> xor2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B) {
-        return apply_binary_op(A, B, xor1_simd<T>);
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) { return xor1_simd(a, b); });
     }
 
 
     // andnot2_simd
     template <typename T>
     std::vector<std::vector<T>> andnot2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B) {
-        return apply_binary_op(A, B, andnot1_simd<T>);
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) { return andnot1_simd(a, b); });
     }
-
-    #endif
 }
 
 
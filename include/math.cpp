@@ -6,8 +6,13 @@
 #include "xsimd_traits.cpp"
 #include "utils/utils.cpp"
 #include "utils/simd_operators.cpp"
+#include "utils/accuracy.cpp"
 #include <type_traits>
 #include <cmath>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <utility>
 
 namespace internal {
     // ================================= 1D ====================================
@@ -15,91 +20,201 @@ namespace internal {
     template <typename T>
     std::vector<T> min1_simd(const std::vector<T>& A, const std::vector<T>& B);
 
+    template <typename T>
+    void min1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // max1
     template <typename T>
     std::vector<T> max1_simd(const std::vector<T>& A, const std::vector<T>& B);
 
+    template <typename T>
+    void max1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // sqrt1
     template <typename T>
     std::vector<T> sqrt1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void sqrt1_simd(const T *A, T *result, size_t n);
+
 
     // rsqrt1
     template <typename T>
-    std::vector<T> rsqrt1_simd(const std::vector<T>& A);
+    std::vector<T> rsqrt1_simd(const std::vector<T>& A, accuracy mode = rsqrt_accuracy());
+
+    template <typename T>
+    void rsqrt1_simd(const T *A, T *result, size_t n, accuracy mode = rsqrt_accuracy());
 
 
     // round1
     template <typename T>
     std::vector<T> round1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void round1_simd(const T *A, T *result, size_t n);
+
 
     // ceil1
     template <typename T>
     std::vector<T> ceil1_simd(const std::vector<T>& A);
 
-    
+    template <typename T>
+    void ceil1_simd(const T *A, T *result, size_t n);
+
+
     // floor1
     template <typename T>
     std::vector<T> floor1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void floor1_simd(const T *A, T *result, size_t n);
+
 
     // abs1
     template <typename T>
     std::vector<T> abs1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void abs1_simd(const T *A, T *result, size_t n);
+
 
     // log_1
     template <typename T>
-    std::vector<T> log_1_simd(const std::vector<T>& A);
+    std::vector<T> log_1_simd(const std::vector<T>& A, accuracy mode = kernel_accuracy());
+
+    template <typename T>
+    void log_1_simd(const T *A, T *result, size_t n, accuracy mode = kernel_accuracy());
 
 
     // log2_1
     template <typename T>
     std::vector<T> log2_1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void log2_1_simd(const T *A, T *result, size_t n);
+
 
     // log10_1
     template <typename T>
     std::vector<T> log10_1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void log10_1_simd(const T *A, T *result, size_t n);
+
 
     // sin1
     template <typename T>
     std::vector<T> sin1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void sin1_simd(const T *A, T *result, size_t n);
+
 
     // cos1
     template <typename T>
     std::vector<T> cos1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void cos1_simd(const T *A, T *result, size_t n);
+
 
-    // sincos1
+    // sincos1: sine and cosine of each element from one range reduction
     template <typename T>
-    std::vector<T> sincos1_simd(const std::vector<T>& A);
+    std::pair<std::vector<T>, std::vector<T>> sincos1_simd(const std::vector<T>& A);
+
+    template <typename T>
+    void sincos1_simd(const T *A, T *sin_result, T *cos_result, size_t n);
 
 
     // tan1
     template <typename T>
     std::vector<T> tan1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void tan1_simd(const T *A, T *result, size_t n);
+
 
     // asin1
     template <typename T>
     std::vector<T> asin1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void asin1_simd(const T *A, T *result, size_t n);
+
 
     // acos1
     template <typename T>
     std::vector<T> acos1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void acos1_simd(const T *A, T *result, size_t n);
+
 
     // atan1
     template <typename T>
     std::vector<T> atan1_simd(const std::vector<T>& A);
 
+    template <typename T>
+    void atan1_simd(const T *A, T *result, size_t n);
+
+
+    // exp1
+    template <typename T>
+    std::vector<T> exp1_simd(const std::vector<T>& A, accuracy mode = kernel_accuracy());
+
+    template <typename T>
+    void exp1_simd(const T *A, T *result, size_t n, accuracy mode = kernel_accuracy());
+
+
+    // exp2_1
+    template <typename T>
+    std::vector<T> exp2_1_simd(const std::vector<T>& A);
+
+    template <typename T>
+    void exp2_1_simd(const T *A, T *result, size_t n);
+
+
+    // expm1_1: exp(a) - 1
+    template <typename T>
+    std::vector<T> expm1_1_simd(const std::vector<T>& A);
+
+    template <typename T>
+    void expm1_1_simd(const T *A, T *result, size_t n);
+
+
+    // log1p_1: log(1 + a)
+    template <typename T>
+    std::vector<T> log1p_1_simd(const std::vector<T>& A);
+
+    template <typename T>
+    void log1p_1_simd(const T *A, T *result, size_t n);
+
+
+    // tanh1
+    template <typename T>
+    std::vector<T> tanh1_simd(const std::vector<T>& A);
+
+    template <typename T>
+    void tanh1_simd(const T *A, T *result, size_t n);
+
+
+    // sigmoid1: 1 / (1 + exp(-a))
+    template <typename T>
+    std::vector<T> sigmoid1_simd(const std::vector<T>& A);
+
+    template <typename T>
+    void sigmoid1_simd(const T *A, T *result, size_t n);
+
+
+    // pow1: A[i] raised to B[i]
+    template <typename T>
+    std::vector<T> pow1_simd(const std::vector<T>& A, const std::vector<T>& B);
+
+    template <typename T>
+    void pow1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // ================================= 2D ====================================
 
@@ -129,7 +244,7 @@ namespace internal {
     template <typename T>
     std::vector<std::vector<T>> round2_simd(const std::vector<std::vector<T>>& A);
 
-    
+
     // ceil2
     template <typename T>
     std::vector<std::vector<T>> ceil2_simd(const std::vector<std::vector<T>>& A);
@@ -172,7 +287,7 @@ namespace internal {
 
     // sincos2
     template <typename T>
-    std::vector<std::vector<T>> sincos2_simd(const std::vector<std::vector<T>>& A);
+    std::pair<std::vector<std::vector<T>>, std::vector<std::vector<T>>> sincos2_simd(const std::vector<std::vector<T>>& A);
 
 
     // tan2
@@ -193,389 +308,548 @@ namespace internal {
     // atan2
     template <typename T>
     std::vector<std::vector<T>> atan2_simd(const std::vector<std::vector<T>>& A);
+
+
+    // ============================== along an axis ==============================
+    // A is viewed as [outer, len, inner] with the reduced axis in the middle
+
+    // softmax_axis: exp(a - max) / sum(exp(a - max)) along the axis
+    template <typename T>
+    void softmax_axis(const T *A, T *result, size_t outer, size_t len, size_t inner);
+
+
+    // logsumexp_axis: log(sum(exp(a))) along the axis; result is [outer, inner]
+    template <typename T>
+    void logsumexp_axis(const T *A, T *result, size_t outer, size_t len, size_t inner);
 }
 
 
+// row_max_* / exp_sum_row_*: the whole registers of a softmax row on the xsimd
+// batch of Traits; i is left at the first element they did not cover
+#if SIMD_HAS_XSIMD_AVX2
+namespace internal {
+    template <typename T, typename Traits>
+    T row_max_avx2(const T *A, size_t n, size_t& i, T m) {
+        typename Traits::simd_type vec_max(m);
+        for (; i + Traits::step <= n; i += Traits::step)
+            vec_max = xsimd::max(vec_max, Traits::load(&A[i]));
+
+        return xsimd::reduce_max(vec_max);
+    }
+
+    template <typename T, typename Traits>
+    T exp_sum_row_avx2(const T *A, T *result, size_t n, size_t& i, T shift) {
+        const typename Traits::simd_type vec_shift(shift);
+        typename Traits::simd_type vec_sum(T(0));
+
+        for (; i + Traits::step <= n; i += Traits::step) {
+            const auto terms = Traits::op(Traits::load(&A[i]) - vec_shift);
+            if (result)
+                Traits::store(&result[i], terms);
+            vec_sum += terms;
+        }
+
+        return xsimd::reduce_add(vec_sum);
+    }
+}
+#endif
+
+
+#if SIMD_HAS_XSIMD_AVX512
+SIMD_TARGET_AVX512_BEGIN
+
+namespace internal {
+    template <typename T, typename Traits>
+    T row_max_avx512(const T *A, size_t n, size_t& i, T m) {
+        typename Traits::simd_type vec_max(m);
+        for (; i + Traits::step <= n; i += Traits::step)
+            vec_max = xsimd::max(vec_max, Traits::load(&A[i]));
+
+        return xsimd::reduce_max(vec_max);
+    }
+
+    template <typename T, typename Traits>
+    T exp_sum_row_avx512(const T *A, T *result, size_t n, size_t& i, T shift) {
+        const typename Traits::simd_type vec_shift(shift);
+        typename Traits::simd_type vec_sum(T(0));
+
+        for (; i + Traits::step <= n; i += Traits::step) {
+            const auto terms = Traits::op(Traits::load(&A[i]) - vec_shift);
+            if (result)
+                Traits::store(&result[i], terms);
+            vec_sum += terms;
+        }
+
+        return xsimd::reduce_add(vec_sum);
+    }
+}
+
+SIMD_TARGET_END
+#endif
+
+
 
 namespace internal {
     // min1_simd
+    template <typename T>
+    void min1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, min_simd_traits>(A, B, result, n, [](const T& a, const T& b) {
+            return std::min(a, b);
+        });
+    }
+
     template <typename T>
     std::vector<T> min1_simd(const std::vector<T>& A, const std::vector<T>& B) {
-        if (A.size() < 32)
-            return apply_binary_op_plain(A, B,  [](const T& a, const T& b) {
-                return std::min(a, b);
-            });
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
 
-        #ifdef __riscv
-            return apply_binary_op_plain(A, B,  [](const T& a, const T& b) {
-                return std::min(a, b);
-            });
-        #endif
+        std::vector<T> result(A.size());
+        min1_simd(A.data(), B.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_binary_op_simd<T, min_simd_traits<T>>(A, B,  [](const T& a, const T& b) {
-                return std::min(a, b);
-            });  
-        #endif      
+        return result;
     }
 
 
     // max1_simd
+    template <typename T>
+    void max1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, max_simd_traits>(A, B, result, n, [](const T& a, const T& b) {
+            return std::max(a, b);
+        });
+    }
+
     template <typename T>
     std::vector<T> max1_simd(const std::vector<T>& A, const std::vector<T>& B) {
-        if (A.size() < 32)
-            return apply_binary_op_plain(A, B,  [](const T& a, const T& b) {
-                return std::max(a, b);
-            });
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
 
-        #ifdef __riscv
-            return apply_binary_op_plain(A, B,  [](const T& a, const T& b) {
-                return std::max(a, b);
-            });
-        #endif
+        std::vector<T> result(A.size());
+        max1_simd(A.data(), B.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_binary_op_simd<T, max_simd_traits<T>>(A, B,  [](const T& a, const T& b) {
-                return std::max(a, b);
-            }); 
-        #endif       
+        return result;
     }
 
 
     // sqrt1_simd
     template <typename T>
-    std::vector<T> sqrt1_simd(const std::vector<T>& A) {
+    void sqrt1_simd(const T *A, T *result, size_t n) {
         static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>);
 
-        if (A.size() < 32)
-            return apply_unary_op_plain(A,  [](const T& a) {
-                return std::sqrt(a);
-            });
+        dispatch_unary_op<T, sqrt_simd_traits>(A, result, n, [](const T& a) {
+            return std::sqrt(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A,  [](const T& a) {
-                return std::sqrt(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> sqrt1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        sqrt1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, sqrt_simd_traits<T>>(A,  [](const T& a) {
-                return std::sqrt(a);
-            });
-        #endif
+        return result;
     }
 
 
-    // rsqrt1_simd
+    // rsqrt1_simd: the raw hardware estimate under approx (the default until
+    // a mode is set), Newton-refined under ulp4; under ulp1 1 / sqrt(a) is
+    // taken in double, since two float roundings can be 1.4 ULP off
     template <typename T>
-    std::vector<T> rsqrt1_simd(const std::vector<T>& A) {
+    void rsqrt1_simd(const T *A, T *result, size_t n, accuracy mode) {
         static_assert(std::is_same_v<T, float>);
 
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& element) { return 1 / std::sqrt(element); });
+        auto scalar = [](const T& a) {
+            return static_cast<T>(1 / std::sqrt(static_cast<double>(a)));
+        };
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& element) { return 1 / std::sqrt(element); });
-        #endif
+        if (mode == accuracy::approx)
+            dispatch_unary_op<T, rsqrt_simd_traits>(A, result, n, scalar);
+        else if (mode == accuracy::ulp4)
+            dispatch_unary_op<T, rsqrt_ulp4_simd_traits>(A, result, n, scalar);
+        else
+            dispatch_unary_op<T, rsqrt_ulp1_simd_traits>(A, result, n, scalar);
+    }
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, rsqrt_simd_traits<T>>(A, [](const T& element) { return 1 / std::sqrt(element); });
-        #endif
+    template <typename T>
+    std::vector<T> rsqrt1_simd(const std::vector<T>& A, accuracy mode) {
+        std::vector<T> result(A.size());
+        rsqrt1_simd(A.data(), result.data(), A.size(), mode);
+
+        return result;
     }
 
 
     // round1_simd
     template <typename T>
-    std::vector<T> round1_simd(const std::vector<T>& A) {
+    void round1_simd(const T *A, T *result, size_t n) {
         static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>);
 
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::round(a);
-            });
+        dispatch_unary_op<T, round_simd_traits>(A, result, n, [](const T& a) {
+            return std::round(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::round(a);
-            });
-        #endif
-    
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, round_simd_traits<T>>(A, [](const T& a) {
-                return std::round(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> round1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        round1_simd(A.data(), result.data(), A.size());
+
+        return result;
     }
 
 
     // ceil1_simd
     template <typename T>
-    std::vector<T> ceil1_simd(const std::vector<T>& A) {
+    void ceil1_simd(const T *A, T *result, size_t n) {
         static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>);
 
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::ceil(a);
-            });
+        dispatch_unary_op<T, ceil_simd_traits>(A, result, n, [](const T& a) {
+            return std::ceil(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::ceil(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> ceil1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        ceil1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, ceil_simd_traits<T>>(A, [](const T& a) {
-                return std::ceil(a);
-            });
-        #endif
+        return result;
     }
 
 
     // floor1_simd
     template <typename T>
-    std::vector<T> floor1_simd(const std::vector<T>& A) {
+    void floor1_simd(const T *A, T *result, size_t n) {
         static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>);
 
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::floor(a);
-            });
+        dispatch_unary_op<T, floor_simd_traits>(A, result, n, [](const T& a) {
+            return std::floor(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::floor(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> floor1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        floor1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, floor_simd_traits<T>>(A, [](const T& a) {
-                return std::floor(a);
-            });
-        #endif
+        return result;
     }
 
 
     // abs1_simd
     template <typename T>
-    std::vector<T> abs1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::abs(a);
-            });
+    void abs1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, abs_simd_traits>(A, result, n, [](const T& a) {
+            return std::abs(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::abs(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> abs1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        abs1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, abs_simd_traits<T>>(A, [](const T& a) {
-                return std::abs(a);
-            });
-        #endif
+        return result;
     }
 
 
-    // log_1_simd
+    // log_1_simd: xsimd under ulp1, the in-tree polynomial otherwise
     template <typename T>
-    std::vector<T> log_1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::log(a);
-            });
+    void log_1_simd(const T *A, T *result, size_t n, accuracy mode) {
+        auto scalar = [](const T& a) {
+            return std::log(a);
+        };
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::log(a);
-            });
-        #endif
+        if (mode == accuracy::ulp1)
+            dispatch_unary_op<T, log_simd_traits>(A, result, n, scalar);
+        else
+            dispatch_unary_op<T, log_ulp4_simd_traits>(A, result, n, scalar);
+    }
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, log_simd_traits<T>>(A, [](const T& a) {
-                return std::log(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> log_1_simd(const std::vector<T>& A, accuracy mode) {
+        std::vector<T> result(A.size());
+        log_1_simd(A.data(), result.data(), A.size(), mode);
+
+        return result;
     }
 
 
     // log2_1_simd
     template <typename T>
-    std::vector<T> log2_1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::log2(a);
-            });
+    void log2_1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, log2_simd_traits>(A, result, n, [](const T& a) {
+            return std::log2(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::log2(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> log2_1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        log2_1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, log2_simd_traits<T>>(A, [](const T& a) {
-                return std::log2(a);
-            });
-        #endif
+        return result;
     }
 
 
     // log10_1_simd
     template <typename T>
-    std::vector<T> log10_1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::log10(a);
-            });
+    void log10_1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, log10_simd_traits>(A, result, n, [](const T& a) {
+            return std::log10(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::log10(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> log10_1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        log10_1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, log10_simd_traits<T>>(A, [](const T& a) {
-                return std::log10(a);
-            });
-        #endif
+        return result;
     }
 
 
     // sin1_simd
     template <typename T>
-    std::vector<T> sin1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::sin(a);
-            });
+    void sin1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, sin_simd_traits>(A, result, n, [](const T& a) {
+            return std::sin(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::sin(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> sin1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        sin1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, sin_simd_traits<T>>(A, [](const T& a) {
-                return std::sin(a);
-            });
-        #endif
+        return result;
     }
 
 
     // cos1_simd
     template <typename T>
-    std::vector<T> cos1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::cos(a);
-            });
+    void cos1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, cos_simd_traits>(A, result, n, [](const T& a) {
+            return std::cos(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::cos(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> cos1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        cos1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, cos_simd_traits<T>>(A, [](const T& a) {
-                return std::cos(a);
-            });
-        #endif
+        return result;
     }
 
 
     // sincos1_simd
-    
+    template <typename T>
+    void sincos1_simd(const T *A, T *sin_result, T *cos_result, size_t n) {
+        dispatch_unary_op_pair<T, sincos_simd_traits>(A, sin_result, cos_result, n, [](const T& a) {
+            return std::make_pair(std::sin(a), std::cos(a));
+        });
+    }
+
+    template <typename T>
+    std::pair<std::vector<T>, std::vector<T>> sincos1_simd(const std::vector<T>& A) {
+        std::vector<T> sin_result(A.size()), cos_result(A.size());
+        sincos1_simd(A.data(), sin_result.data(), cos_result.data(), A.size());
+
+        return {std::move(sin_result), std::move(cos_result)};
+    }
+
 
     // tan1_simd
     template <typename T>
-    std::vector<T> tan1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::tan(a);
-            });
+    void tan1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, tan_simd_traits>(A, result, n, [](const T& a) {
+            return std::tan(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::tan(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> tan1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        tan1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, tan_simd_traits<T>>(A, [](const T& a) {
-                return std::tan(a);
-            });
-        #endif
+        return result;
     }
 
 
     // asin1_simd
     template <typename T>
-    std::vector<T> asin1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::asin(a);
-            });
+    void asin1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, asin_simd_traits>(A, result, n, [](const T& a) {
+            return std::asin(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::asin(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> asin1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        asin1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, asin_simd_traits<T>>(A, [](const T& a) {
-                return std::asin(a);
-            });
-        #endif
+        return result;
     }
 
 
     // acos1_simd
     template <typename T>
-    std::vector<T> acos1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::acos(a);
-            });
+    void acos1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, acos_simd_traits>(A, result, n, [](const T& a) {
+            return std::acos(a);
+        });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::acos(a);
-            });
-        #endif
+    template <typename T>
+    std::vector<T> acos1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        acos1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, acos_simd_traits<T>>(A, [](const T& a) {
-                return std::acos(a);
-            });
-        #endif
+        return result;
     }
 
 
     // atan1_simd
+    template <typename T>
+    void atan1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, atan_simd_traits>(A, result, n, [](const T& a) {
+            return std::atan(a);
+        });
+    }
+
     template <typename T>
     std::vector<T> atan1_simd(const std::vector<T>& A) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::atan(a);
-            });
+        std::vector<T> result(A.size());
+        atan1_simd(A.data(), result.data(), A.size());
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [](const T& a) {
-                return std::atan(a);
-            });
-        #endif
+        return result;
+    }
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd<T, atan_simd_traits<T>>(A, [](const T& a) {
-                return std::atan(a);
-            });
-        #endif
+
+    // exp1_simd: xsimd under ulp1, the in-tree polynomial otherwise
+    template <typename T>
+    void exp1_simd(const T *A, T *result, size_t n, accuracy mode) {
+        auto scalar = [](const T& a) {
+            return std::exp(a);
+        };
+
+        if (mode == accuracy::ulp1)
+            dispatch_unary_op<T, exp_simd_traits>(A, result, n, scalar);
+        else
+            dispatch_unary_op<T, exp_ulp4_simd_traits>(A, result, n, scalar);
+    }
+
+    template <typename T>
+    std::vector<T> exp1_simd(const std::vector<T>& A, accuracy mode) {
+        std::vector<T> result(A.size());
+        exp1_simd(A.data(), result.data(), A.size(), mode);
+
+        return result;
+    }
+
+
+    // exp2_1_simd
+    template <typename T>
+    void exp2_1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, exp2_simd_traits>(A, result, n, [](const T& a) {
+            return std::exp2(a);
+        });
+    }
+
+    template <typename T>
+    std::vector<T> exp2_1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        exp2_1_simd(A.data(), result.data(), A.size());
+
+        return result;
+    }
+
+
+    // expm1_1_simd
+    template <typename T>
+    void expm1_1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, expm1_simd_traits>(A, result, n, [](const T& a) {
+            return std::expm1(a);
+        });
+    }
+
+    template <typename T>
+    std::vector<T> expm1_1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        expm1_1_simd(A.data(), result.data(), A.size());
+
+        return result;
+    }
+
+
+    // log1p_1_simd
+    template <typename T>
+    void log1p_1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, log1p_simd_traits>(A, result, n, [](const T& a) {
+            return std::log1p(a);
+        });
+    }
+
+    template <typename T>
+    std::vector<T> log1p_1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        log1p_1_simd(A.data(), result.data(), A.size());
+
+        return result;
+    }
+
+
+    // tanh1_simd
+    template <typename T>
+    void tanh1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, tanh_simd_traits>(A, result, n, [](const T& a) {
+            return std::tanh(a);
+        });
+    }
+
+    template <typename T>
+    std::vector<T> tanh1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        tanh1_simd(A.data(), result.data(), A.size());
+
+        return result;
+    }
+
+
+    // sigmoid1_simd
+    template <typename T>
+    void sigmoid1_simd(const T *A, T *result, size_t n) {
+        dispatch_unary_op<T, sigmoid_simd_traits>(A, result, n, [](const T& a) {
+            return 1 / (1 + std::exp(-a));
+        });
+    }
+
+    template <typename T>
+    std::vector<T> sigmoid1_simd(const std::vector<T>& A) {
+        std::vector<T> result(A.size());
+        sigmoid1_simd(A.data(), result.data(), A.size());
+
+        return result;
+    }
+
+
+    // pow1_simd
+    template <typename T>
+    void pow1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, pow_simd_traits>(A, B, result, n, [](const T& a, const T& b) {
+            return std::pow(a, b);
+        });
+    }
+
+    template <typename T>
+    std::vector<T> pow1_simd(const std::vector<T>& A, const std::vector<T>& B) {
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
+
+        std::vector<T> result(A.size());
+        pow1_simd(A.data(), B.data(), result.data(), A.size());
+
+        return result;
     }
 
 
@@ -585,7 +859,9 @@ namespace internal {
     template <typename T>
     std::vector<std::vector<T>> min2_simd(const std::vector<std::vector<T>>& A, 
                                           const std::vector<std::vector<T>>& B) {
-        return apply_binary_op(A, B, min1_simd<T>);
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) {
+            return min1_simd(a, b);
+        });
     }
 
 
@@ -593,112 +869,300 @@ namespace internal {
     template <typename T>
     std::vector<std::vector<T>> max2_simd(const std::vector<std::vector<T>>& A, 
                                           const std::vector<std::vector<T>>& B) {
-        return apply_binary_op(A, B, max1_simd<T>);
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) {
+            return max1_simd(a, b);
+        });
     }
 
 
     // sqrt2_simd
     template <typename T>
     std::vector<std::vector<T>> sqrt2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, sqrt1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return sqrt1_simd(a);
+        });
     }
 
 
     // rsqrt2_simd
     template <typename T>
     std::vector<std::vector<T>> rsqrt2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, rsqrt1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return rsqrt1_simd(a);
+        });
     }
 
 
     // round2_simd
     template <typename T>
     std::vector<std::vector<T>> round2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, round1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return round1_simd(a);
+        });
     }
 
 
     // ceil2_simd
     template <typename T>
     std::vector<std::vector<T>> ceil2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, ceil1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return ceil1_simd(a);
+        });
     }
 
 
     // floor2_simd
     template <typename T>
     std::vector<std::vector<T>> floor2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, floor1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return floor1_simd(a);
+        });
     }
 
 
     // abs2_simd
     template <typename T>
     std::vector<std::vector<T>> abs2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, abs1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return abs1_simd(a);
+        });
     }
 
 
     // log_2_simd
     template <typename T>
     std::vector<std::vector<T>> log_2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, log_1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return log_1_simd(a);
+        });
     }
 
 
     // log2_2_simd
     template <typename T>
     std::vector<std::vector<T>> log2_2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, log2_1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return log2_1_simd(a);
+        });
     }
 
 
     // log10_2_simd
     template <typename T>
     std::vector<std::vector<T>> log10_2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, log10_1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return log10_1_simd(a);
+        });
     }
 
 
     // sin2_simd
     template <typename T>
     std::vector<std::vector<T>> sin2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, sin1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return sin1_simd(a);
+        });
     }
 
 
     // cos2_simd
     template <typename T>
     std::vector<std::vector<T>> cos2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, cos1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return cos1_simd(a);
+        });
+    }
+
+
+    // sincos2_simd
+    template <typename T>
+    std::pair<std::vector<std::vector<T>>, std::vector<std::vector<T>>> sincos2_simd(const std::vector<std::vector<T>>& A) {
+        if (A.empty())
+            throw std::invalid_argument("Input 2D vector can't be empty");
+
+        std::vector<std::vector<T>> sin_result, cos_result;
+        for (const auto& row : A) {
+            auto values = sincos1_simd(row);
+            sin_result.push_back(std::move(values.first));
+            cos_result.push_back(std::move(values.second));
+        }
+
+        return {std::move(sin_result), std::move(cos_result)};
     }
 
 
     // tan2_simd
     template <typename T>
     std::vector<std::vector<T>> tan2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, tan1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return tan1_simd(a);
+        });
     }
 
 
     // asin2_simd
     template <typename T>
     std::vector<std::vector<T>> asin2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, asin1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return asin1_simd(a);
+        });
     }
 
 
     // acos2_simd
     template <typename T>
     std::vector<std::vector<T>> acos2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, acos1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return acos1_simd(a);
+        });
     }
 
 
     // atan2_simd
     template <typename T>
     std::vector<std::vector<T>> atan2_simd(const std::vector<std::vector<T>>& A) {
-        return apply_unary_op(A, atan1_simd<T>);
+        return apply_unary_op(A, [](const std::vector<T>& a) {
+            return atan1_simd(a);
+        });
+    }
+
+
+    // ============================== along an axis ==============================
+
+    // row_max: largest element of a contiguous row
+    template <typename T>
+    T row_max(const T *A, size_t n) {
+        T m = -std::numeric_limits<T>::infinity();
+        size_t i = 0;
+
+        #if SIMD_HAS_XSIMD_AVX512
+            if (simd_level_at_least(simd_level::avx512))
+                m = row_max_avx512<T, exp_avx512_traits<T>>(A, n, i, m);
+            else
+        #endif
+        #if SIMD_HAS_XSIMD_AVX2
+            if (use_avx2<exp_simd_traits<T>>(n))
+                m = row_max_avx2<T, exp_simd_traits<T>>(A, n, i, m);
+        #endif
+
+        for (; i < n; ++i)
+            m = std::max(m, A[i]);
+
+        return m;
+    }
+
+
+    // exp_sum_row: sum of exp(A[i] - shift), with the terms also written to
+    // result unless it is null
+    template <typename T>
+    T exp_sum_row(const T *A, T *result, size_t n, T shift) {
+        T sum = 0;
+        size_t i = 0;
+
+        #if SIMD_HAS_XSIMD_AVX512
+            if (simd_level_at_least(simd_level::avx512))
+                sum = exp_sum_row_avx512<T, exp_avx512_traits<T>>(A, result, n, i, shift);
+            else
+        #endif
+        #if SIMD_HAS_XSIMD_AVX2
+            if (use_avx2<exp_simd_traits<T>>(n))
+                sum = exp_sum_row_avx2<T, exp_simd_traits<T>>(A, result, n, i, shift);
+        #endif
+
+        for (; i < n; ++i) {
+            const T term = std::exp(A[i] - shift);
+            if (result)
+                result[i] = term;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+
+    // softmax_axis: a contiguous axis is done row by row in three passes
+    // (max, exp and sum, scale); a strided one runs each pass down all inner
+    // lanes of a block at once with the elementwise kernels. Both run on
+    // worker threads, so the strided one names its accuracy instead of
+    // reading the thread's
+    template <typename T>
+    void softmax_axis(const T *A, T *result, size_t outer, size_t len, size_t inner) {
+        static_assert(std::is_floating_point<T>::value, "softmax needs a floating-point type.");
+
+        if (inner == 1) {
+            parallel_rows(outer, len, [&](size_t o) {
+                const T *a = A + o * len;
+                T *r = result + o * len;
+
+                const T scale = 1 / exp_sum_row(a, r, len, row_max(a, len));
+                for (size_t i = 0; i < len; ++i)
+                    r[i] *= scale;
+            });
+            return;
+        }
+
+        parallel_rows(outer, len * inner, [&](size_t o) {
+            const T *a = A + o * len * inner;
+            T *r = result + o * len * inner;
+
+            std::vector<T> m(a, a + inner), sum(inner, T(0));
+            for (size_t k = 1; k < len; ++k)
+                max1_simd(m.data(), a + k * inner, m.data(), inner);
+
+            for (size_t k = 0; k < len; ++k) {
+                dispatch_binary_op<T, sub_simd_traits>(a + k * inner, m.data(), r + k * inner, inner,
+                                                       [](const T& x, const T& y) { return x - y; });
+                exp1_simd(r + k * inner, r + k * inner, inner, accuracy::ulp1);
+                dispatch_binary_op<T, add_simd_traits>(sum.data(), r + k * inner, sum.data(), inner,
+                                                       [](const T& x, const T& y) { return x + y; });
+            }
+
+            for (size_t j = 0; j < inner; ++j)
+                sum[j] = 1 / sum[j];
+
+            for (size_t k = 0; k < len; ++k)
+                for (size_t j = 0; j < inner; ++j)
+                    r[k * inner + j] *= sum[j];
+        });
+    }
+
+
+    // logsumexp_axis: max + log(sum(exp(a - max))); an infinite max is the
+    // result as is, since a - max would be NaN
+    template <typename T>
+    void logsumexp_axis(const T *A, T *result, size_t outer, size_t len, size_t inner) {
+        static_assert(std::is_floating_point<T>::value, "logsumexp needs a floating-point type.");
+
+        if (inner == 1) {
+            parallel_rows(outer, len, [&](size_t o) {
+                const T *a = A + o * len;
+                const T m = row_max(a, len);
+
+                result[o] = std::isinf(m) ? m : m + std::log(exp_sum_row(a, static_cast<T *>(nullptr), len, m));
+            });
+            return;
+        }
+
+        parallel_rows(outer, len * inner, [&](size_t o) {
+            const T *a = A + o * len * inner;
+            T *r = result + o * inner;
+
+            std::vector<T> m(a, a + inner), sum(inner, T(0)), terms(inner);
+            for (size_t k = 1; k < len; ++k)
+                max1_simd(m.data(), a + k * inner, m.data(), inner);
+
+            for (size_t k = 0; k < len; ++k) {
+                dispatch_binary_op<T, sub_simd_traits>(a + k * inner, m.data(), terms.data(), inner,
+                                                       [](const T& x, const T& y) { return x - y; });
+                exp1_simd(terms.data(), terms.data(), inner, accuracy::ulp1);
+                dispatch_binary_op<T, add_simd_traits>(sum.data(), terms.data(), sum.data(), inner,
+                                                       [](const T& x, const T& y) { return x + y; });
+            }
+
+            log_1_simd(sum.data(), r, inner, accuracy::ulp1);
+            for (size_t j = 0; j < inner; ++j)
+                r[j] = std::isinf(m[j]) ? m[j] : r[j] + m[j];
+        });
     }
 }
 
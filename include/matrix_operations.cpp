@@ -6,10 +6,25 @@
 #include <algorithm>
 #include <type_traits>
 #include <stdexcept>
-#if defined(__AVX2__) && (defined(__UBUNTU__) || defined(__DEBIAN__) || defined(__KALI__))
+#include "simd_traits.cpp"
+#include "utils/simd_operators.cpp"
+#include "parallel_for.cpp"
+
+// CBLAS is used when the build found one; NUMPYCPP_NO_BLAS (set by the build
+// when there is none) leaves every operation to the in-tree kernels
+#if defined(NUMPYCPP_NO_BLAS)
+    #define HAS_CBLAS 0
+#elif (defined(__UBUNTU__) || defined(__DEBIAN__) || defined(__KALI__))
     #include <cblas.h>
+    #define HAS_CBLAS 1
 #elif defined(__riscv) || defined(__FEDORA__) || defined(__ARCHLINUX__)
     #include <openblas/cblas.h>
+    #define HAS_CBLAS 1
+#elif __has_include(<cblas.h>)
+    #include <cblas.h>
+    #define HAS_CBLAS 1
+#else
+    #define HAS_CBLAS 0
 #endif
 
 namespace internal {
@@ -41,6 +56,81 @@ namespace internal {
     // subtract2
     template <typename T>
     std::vector<std::vector<T>> subtract2(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B);
+
+
+    // ============================ flat ====================================
+
+    // dot_accum_t: what an integer dot accumulates in; 8- and 16-bit
+    // operands widen to 32 bits, wider ones keep their own type
+    template <typename T>
+    struct dot_accum { using type = T; };
+
+    template <> struct dot_accum<int8_t> { using type = int32_t; };
+    template <> struct dot_accum<uint8_t> { using type = uint32_t; };
+    template <> struct dot_accum<int16_t> { using type = int32_t; };
+    template <> struct dot_accum<uint16_t> { using type = uint32_t; };
+
+    template <typename T>
+    using dot_accum_t = typename dot_accum<T>::type;
+
+
+    // dot: C[M x N] = op(A)[M x K] * op(B)[K x N], all row-major. Integer
+    // operands are multiplied exactly in dot_accum_t<T>, wrapping around as
+    // unsigned arithmetic does, and C may be any type that holds the result
+    // (int8 x int8 -> int32); floating-point C has the type of A and B
+    template <typename T, typename R = T>
+    void dot(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+             const T *A, size_t lda, const T *B, size_t ldb, R *C, size_t ldc);
+
+
+    // gemm_blocked: the in-tree float/double dot, same arguments; used
+    // without BLAS, and with it for products too small to amortise a call
+    template <typename T>
+    void gemm_blocked(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                      const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc);
+
+
+    // dot_fixed: C[M x N] = A[M x K] * B[K x N] for sizes known at compile
+    // time, unrolled in full with the tile on the stack
+    template <size_t M, size_t N, size_t K, typename T>
+    void dot_fixed(const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc);
+
+
+    // dot_batched: C[b] = A[b] * B[b] for count contiguous M x K and K x N
+    // matrices; with stride_b = 0 every A[b] is multiplied by the same B
+    template <size_t M, size_t N, size_t K, typename T>
+    void dot_batched(const T *A, const T *B, size_t stride_b, T *C, size_t count);
+
+
+    // dot_strided_batched: C[b] = op(A[b]) * op(B[b]) for b < count, with
+    // A[b] at A + b * stride_a and so on; a stride of 0 repeats one matrix
+    template <typename T, typename R = T>
+    void dot_strided_batched(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                             const T *A, size_t lda, size_t stride_a, const T *B, size_t ldb, size_t stride_b,
+                             R *C, size_t ldc, size_t stride_c, size_t count);
+
+
+    // dot_pointer_batched: the same with the matrices given by arrays of
+    // count pointers
+    template <typename T, typename R = T>
+    void dot_pointer_batched(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                             const T *const *A, size_t lda, const T *const *B, size_t ldb,
+                             R *const *C, size_t ldc, size_t count);
+
+
+    // transpose: B[cols x rows] = A[rows x cols]^T
+    template <typename T>
+    void transpose(const T *A, size_t rows, size_t cols, size_t lda, T *B, size_t ldb);
+
+
+    // add1: C = A + B, C may alias A or B
+    template <typename T>
+    void add1(const T *A, const T *B, T *C, size_t n);
+
+
+    // subtract1: C = A - B, C may alias A or B
+    template <typename T>
+    void subtract1(const T *A, const T *B, T *C, size_t n);
 }
 
 
@@ -48,9 +138,6 @@ namespace internal {
     // dot
     template <typename T>
     std::vector<std::vector<T>> dot(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B) {
-        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
-        static_assert(!std::is_same_v<T, char>);
-
         const size_t M = A.size();
         const size_t K_A = A[0].size();
         const size_t K_B = B.size();
@@ -60,43 +147,24 @@ namespace internal {
             throw std::invalid_argument("Matrix dimension mismatch");
         }
 
-        std::vector<std::vector<T>> C(M, std::vector<T>(N));
-
-        auto performDotProduct = [M, K_A, N](const auto& matA, const auto& matB, auto& matC) {
-            using ElementType = std::decay_t<decltype(matA[0][0])>;
-            std::vector<ElementType> flat_A, flat_B;
-            for (const auto& row : matA) {
-                flat_A.insert(flat_A.end(), row.begin(), row.end());
-            }
-            for (const auto& row : matB) {
-                flat_B.insert(flat_B.end(), row.begin(), row.end());
-            }
+        std::vector<T> flat_A, flat_B;
+        flat_A.reserve(M * K_A);
+        flat_B.reserve(K_B * N);
 
-            std::vector<ElementType> flat_C(M * N);
+        for (const auto& row : A)
+            flat_A.insert(flat_A.end(), row.begin(), row.end());
 
-            if constexpr (std::is_same_v<ElementType, float>) {
-                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K_A, 1.0f, flat_A.data(), K_A, flat_B.data(), N, 0.0f, flat_C.data(), N);
-            } else if constexpr (std::is_same_v<ElementType, double>) {
-                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K_A, 1.0, flat_A.data(), K_A, flat_B.data(), N, 0.0, flat_C.data(), N);
-            } else {
-                std::vector<float> float_flat_A(flat_A.begin(), flat_A.end());
-                std::vector<float> float_flat_B(flat_B.begin(), flat_B.end());
-                std::vector<float> float_flat_C(M * N);
+        for (const auto& row : B)
+            flat_B.insert(flat_B.end(), row.begin(), row.end());
 
-                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K_A, 1.0f, float_flat_A.data(), K_A, float_flat_B.data(), N, 0.0f, float_flat_C.data(), N);
+        std::vector<T> flat_C(M * N);
+        dot(false, false, M, N, K_A, flat_A.data(), K_A, flat_B.data(), N, flat_C.data(), N);
 
-                for (size_t i = 0; i < M * N; ++i) {
-                    flat_C[i] = static_cast<ElementType>(float_flat_C[i]);
-                }
-            }
+        std::vector<std::vector<T>> C;
+        C.reserve(M);
+        for (size_t i = 0; i < M; ++i)
+            C.emplace_back(flat_C.begin() + i * N, flat_C.begin() + (i + 1) * N);
 
-            matC.reserve(M);
-            for (size_t i = 0; i < M; ++i) {
-                matC[i].assign(flat_C.begin() + i * N, flat_C.begin() + (i + 1) * N);
-            }
-        };
-
-        performDotProduct(A, B, C);
         return C;
     }    
 
@@ -106,74 +174,26 @@ namespace internal {
         const size_t rows = mat.size();
         const size_t cols = mat[0].size();
 
-        if constexpr (std::is_same_v<T, float>) {
-            std::vector<float> flat_mat;
-            flat_mat.reserve(rows * cols);
-
-            for (const auto& row : mat)
-                flat_mat.insert(flat_mat.end(), row.begin(), row.end());
-
-            std::vector<float> flat_result(cols * rows);
-
-            cblas_somatcopy(CblasRowMajor,
-                            CblasTrans, 
-                            rows,      
-                            cols,          
-                            1.0f,         
-                            flat_mat.data(), 
-                            cols,        
-                            flat_result.data(),
-                            rows);        
-
-            std::vector<std::vector<float>> result;
-            result.reserve(cols);
-
-            for (size_t i = 0; i < cols; ++i) {
-                result.emplace_back(
-                    flat_result.begin() + i * rows,
-                    flat_result.begin() + (i + 1) * rows
-                );
-            }
+        std::vector<T> flat_mat;
+        flat_mat.reserve(rows * cols);
 
-            return result;
-        } else if constexpr (std::is_same_v<T, double>) {
-            std::vector<double> flat_mat;
-            flat_mat.reserve(rows * cols);
-
-            for (const auto& row : mat)
-                flat_mat.insert(flat_mat.end(), row.begin(), row.end());
-
-            std::vector<double> flat_result(cols * rows);
-
-            cblas_domatcopy(CblasRowMajor,
-                            CblasTrans, 
-                            rows,      
-                            cols,          
-                            1.0f,         
-                            flat_mat.data(), 
-                            cols,        
-                            flat_result.data(),
-                            rows);        
-
-            std::vector<std::vector<double>> result;
-            result.reserve(cols);
-
-            for (size_t i = 0; i < cols; ++i) {
-                result.emplace_back(
-                    flat_result.begin() + i * rows,
-                    flat_result.begin() + (i + 1) * rows
-                );
-            }
+        for (const auto& row : mat)
+            flat_mat.insert(flat_mat.end(), row.begin(), row.end());
 
-            return result;
-        } else {
-            std::vector<std::vector<T>> result(cols, std::vector<T>(rows));
-            for (size_t i = 0; i < rows; ++i)
-                for (size_t j = 0; j < cols; ++j)
-                    result[j][i] = mat[i][j];
+        std::vector<T> flat_result(cols * rows);
+        transpose(flat_mat.data(), rows, cols, cols, flat_result.data(), rows);
+
+        std::vector<std::vector<T>> result;
+        result.reserve(cols);
 
-            return result;
+        for (size_t i = 0; i < cols; ++i) {
+            result.emplace_back(
+                flat_result.begin() + i * rows,
+                flat_result.begin() + (i + 1) * rows
+            );
         }
+
+        return result;
     }
 
 
@@ -187,27 +207,8 @@ namespace internal {
             throw std::invalid_argument("Vector dimension mismatch");
         }
 
-        size_t N = A.size();
-        std::vector<T> C(N);
-
-        if constexpr (std::is_same_v<T, float>) {
-            cblas_scopy(N, B.data(), 1, C.data(), 1);
-            cblas_saxpy(N, 1.0, A.data(), 1, C.data(), 1);
-        } else if constexpr (std::is_same_v<T, double>) {
-            cblas_dcopy(N, B.data(), 1, C.data(), 1);
-            cblas_daxpy(N, 1.0, A.data(), 1, C.data(), 1);
-        } else {
-            std::vector<float> float_A(N), float_B(N), float_C(N);
-            for (size_t i = 0; i < N; ++i) {
-                float_A[i] = static_cast<float>(A[i]);
-                float_B[i] = static_cast<float>(B[i]);
-            }
-            cblas_scopy(N, float_B.data(), 1, float_C.data(), 1);
-            cblas_saxpy(N, 1.0, float_A.data(), 1, float_C.data(), 1);
-            for (size_t i = 0; i < N; ++i) {
-                C[i] = static_cast<T>(float_C[i]);
-            }
-        }
+        std::vector<T> C(A.size());
+        add1(A.data(), B.data(), C.data(), A.size());
 
         return C;
     }
@@ -240,27 +241,8 @@ namespace internal {
             throw std::invalid_argument("Vector dimension mismatch");
         }
 
-        size_t N = A.size();
-        std::vector<T> C(N);
-
-        if constexpr (std::is_same_v<T, float>) {
-            cblas_scopy(N, A.data(), 1, C.data(), 1);
-            cblas_saxpy(N, -1.0, B.data(), 1, C.data(), 1);
-        } else if constexpr (std::is_same_v<T, double>) {
-            cblas_dcopy(N, A.data(), 1, C.data(), 1);
-            cblas_daxpy(N, -1.0, B.data(), 1, C.data(), 1);
-        } else {
-            std::vector<float> float_A(N), float_B(N), float_C(N);
-            for (size_t i = 0; i < N; ++i) {
-                float_A[i] = static_cast<float>(A[i]);
-                float_B[i] = static_cast<float>(B[i]);
-            }
-            cblas_scopy(N, float_A.data(), 1, float_C.data(), 1);
-            cblas_saxpy(N, -1.0, float_B.data(), 1, float_C.data(), 1);
-            for (size_t i = 0; i < N; ++i) {
-                C[i] = static_cast<T>(float_C[i]);
-            }
-        }
+        std::vector<T> C(A.size());
+        subtract1(A.data(), B.data(), C.data(), A.size());
 
         return C;
     }
@@ -283,6 +265,712 @@ namespace internal {
         return C;
     }
 
+
+
+    // ============================ flat ====================================
+
+    // ========================= integer gemm ===============================
+    // op(A) and op(B)^T are packed into rows of kp elements, zero-padded to
+    // whole registers, so every C[i, j] is one inner product of two packed
+    // rows. A block of packed A rows stays in cache while the columns of B
+    // stream past it four at a time, and each step of the kernel computes
+    // a 2 x 4 tile of C from two rows and four columns
+
+    // bytes of packed A per row block, about half of a per-core L2
+    constexpr size_t dot_integer_block_bytes = 128 << 10;
+
+    // packed rows are padded to a multiple of one AVX2 register
+    constexpr size_t dot_integer_pad_bytes = 32;
+
+    // dot_tile_plain: tile[r * 4 + c] = a[r] . b[c] over kp elements, in the
+    // unsigned form of the accumulator so wrap-around is defined
+    template <typename T>
+    void dot_tile_plain(const T *const *a, const T *const *b, size_t kp, dot_accum_t<T> *tile) {
+        using U = std::make_unsigned_t<dot_accum_t<T>>;
+
+        for (size_t r = 0; r < 2; ++r) {
+            for (size_t c = 0; c < 4; ++c) {
+                U acc = 0;
+                for (size_t k = 0; k < kp; ++k)
+                    acc += static_cast<U>(a[r][k]) * static_cast<U>(b[c][k]);
+                tile[r * 4 + c] = static_cast<dot_accum_t<T>>(acc);
+            }
+        }
+    }
+
+
+    #if SIMD_HAS_AVX2
+    SIMD_TARGET_AVX2_BEGIN
+
+    // dot_tile_avx2: dot_tile_plain with eight register accumulators; kp
+    // is a multiple of the register width
+    template <typename T>
+    void dot_tile_avx2(const T *const *a, const T *const *b, size_t kp, dot_accum_t<T> *tile) {
+        using Traits = inner_product_simd_traits<T>;
+        static_assert(std::is_same_v<typename Traits::accum_type, dot_accum_t<T>>);
+
+        auto acc00 = Traits::zero(), acc01 = Traits::zero(), acc02 = Traits::zero(), acc03 = Traits::zero();
+        auto acc10 = Traits::zero(), acc11 = Traits::zero(), acc12 = Traits::zero(), acc13 = Traits::zero();
+
+        for (size_t k = 0; k < kp; k += Traits::step) {
+            const auto a0 = Traits::load(a[0] + k);
+            const auto a1 = Traits::load(a[1] + k);
+
+            auto b0 = Traits::load(b[0] + k);
+            acc00 = Traits::mul_add(a0, b0, acc00);
+            acc10 = Traits::mul_add(a1, b0, acc10);
+
+            auto b1 = Traits::load(b[1] + k);
+            acc01 = Traits::mul_add(a0, b1, acc01);
+            acc11 = Traits::mul_add(a1, b1, acc11);
+
+            b0 = Traits::load(b[2] + k);
+            acc02 = Traits::mul_add(a0, b0, acc02);
+            acc12 = Traits::mul_add(a1, b0, acc12);
+
+            b1 = Traits::load(b[3] + k);
+            acc03 = Traits::mul_add(a0, b1, acc03);
+            acc13 = Traits::mul_add(a1, b1, acc13);
+        }
+
+        tile[0] = Traits::horizontal_sum(acc00);
+        tile[1] = Traits::horizontal_sum(acc01);
+        tile[2] = Traits::horizontal_sum(acc02);
+        tile[3] = Traits::horizontal_sum(acc03);
+        tile[4] = Traits::horizontal_sum(acc10);
+        tile[5] = Traits::horizontal_sum(acc11);
+        tile[6] = Traits::horizontal_sum(acc12);
+        tile[7] = Traits::horizontal_sum(acc13);
+    }
+
+    SIMD_TARGET_END
+    #endif
+
+
+    // dot_integer
+    template <typename T, typename R>
+    void dot_integer(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                     const T *A, size_t lda, const T *B, size_t ldb, R *C, size_t ldc) {
+        if (M == 0 || N == 0)
+            return;
+
+        const size_t pad = dot_integer_pad_bytes / sizeof(T);
+        const size_t kp = std::max<size_t>((K + pad - 1) / pad * pad, pad);
+
+        std::vector<T> packed_a(M * kp), packed_b(N * kp);
+        if (trans_a) {
+            transpose(A, K, M, lda, packed_a.data(), kp);
+        } else {
+            for (size_t i = 0; i < M; ++i)
+                std::copy(A + i * lda, A + i * lda + K, packed_a.begin() + i * kp);
+        }
+
+        if (trans_b) {
+            for (size_t j = 0; j < N; ++j)
+                std::copy(B + j * ldb, B + j * ldb + K, packed_b.begin() + j * kp);
+        } else {
+            transpose(B, K, N, ldb, packed_b.data(), kp);
+        }
+
+        bool simd = false;
+        #if SIMD_HAS_AVX2
+            simd = use_avx2<inner_product_simd_traits<T>>(kp);
+        #endif
+
+        // an even number of rows per block, so only the last block can
+        // end on a single row
+        size_t rows = std::max<size_t>(dot_integer_block_bytes / (kp * sizeof(T)), 2) & ~size_t(1);
+        rows = std::min(rows, M + (M & 1));
+        const size_t blocks = (M + rows - 1) / rows;
+
+        parallel_rows(blocks, rows * N * K, [&](size_t block) {
+            const size_t row_end = std::min(M, (block + 1) * rows);
+            dot_accum_t<T> tile[8];
+
+            for (size_t j = 0; j < N; j += 4) {
+                // past the last column the kernel reads the last one again
+                const T *b[4];
+                for (size_t c = 0; c < 4; ++c)
+                    b[c] = packed_b.data() + std::min(j + c, N - 1) * kp;
+
+                for (size_t i = block * rows; i < row_end; i += 2) {
+                    const T *a[2] = {packed_a.data() + i * kp, packed_a.data() + std::min(i + 1, M - 1) * kp};
+
+                    #if SIMD_HAS_AVX2
+                        if (simd)
+                            dot_tile_avx2(a, b, kp, tile);
+                        else
+                            dot_tile_plain(a, b, kp, tile);
+                    #else
+                        dot_tile_plain(a, b, kp, tile);
+                    #endif
+
+                    for (size_t r = 0; r < std::min<size_t>(2, M - i); ++r)
+                        for (size_t c = 0; c < std::min<size_t>(4, N - j); ++c)
+                            C[(i + r) * ldc + j + c] = static_cast<R>(tile[r * 4 + c]);
+                }
+            }
+        });
+    }
+
+
+    // ========================= blocked gemm ===============================
+    // The usual three-level blocking: a kc x nc panel of op(B) and an mc x kc
+    // block of op(A) are packed into strips of gemm_nr columns and gemm_mr
+    // rows, sized for L3 and L2, and a register-tile kernel multiplies one
+    // A strip by one B strip over kc. Row blocks are split across threads,
+    // each packing its own A block. Edge strips are zero-padded, and their
+    // tiles go through a buffer so only the valid part reaches C
+
+    // below this many multiply-adds the call overhead of BLAS costs more
+    // than the product itself, and dot stays in gemm_blocked
+    constexpr size_t gemm_blas_min_ops = 96 * 96 * 96;
+
+    // block sizes in elements; gemm_mc is a multiple of gemm_mr
+    constexpr size_t gemm_mr = 6;
+    constexpr size_t gemm_mc = 72;
+    constexpr size_t gemm_kc = 256;
+    constexpr size_t gemm_nc = 2048;
+
+    // gemm_nr: a tile row is two AVX2 registers
+    template <typename T>
+    constexpr size_t gemm_nr = 64 / sizeof(T);
+
+    // gemm_pack_a: rows [i, i + mc) and columns [p, p + kc) of op(A), as
+    // strips of gemm_mr rows stored column by column
+    template <typename T>
+    void gemm_pack_a(bool trans_a, const T *A, size_t lda, size_t i, size_t mc, size_t p, size_t kc, T *packed) {
+        for (size_t s = 0; s < mc; s += gemm_mr) {
+            for (size_t k = 0; k < kc; ++k) {
+                for (size_t r = 0; r < gemm_mr; ++r) {
+                    const size_t row = i + s + r, col = p + k;
+                    *packed++ = s + r >= mc ? T(0) : trans_a ? A[col * lda + row] : A[row * lda + col];
+                }
+            }
+        }
+    }
+
+    // gemm_pack_b: rows [p, p + kc) and columns [j, j + nc) of op(B), as
+    // strips of gemm_nr columns stored row by row
+    template <typename T>
+    void gemm_pack_b(bool trans_b, const T *B, size_t ldb, size_t p, size_t kc, size_t j, size_t nc, T *packed) {
+        constexpr size_t nr = gemm_nr<T>;
+
+        parallel_rows((nc + nr - 1) / nr, kc * nr, [&](size_t strip) {
+            T *dst = packed + strip * kc * nr;
+            const size_t s = strip * nr;
+
+            for (size_t k = 0; k < kc; ++k) {
+                for (size_t c = 0; c < nr; ++c) {
+                    const size_t row = p + k, col = j + s + c;
+                    *dst++ = s + c >= nc ? T(0) : trans_b ? B[col * ldb + row] : B[row * ldb + col];
+                }
+            }
+        });
+    }
+
+    // gemm_kernel_plain: C[gemm_mr x gemm_nr] (+)= one A strip times one
+    // B strip over kc
+    template <typename T>
+    void gemm_kernel_plain(size_t kc, const T *pa, const T *pb, T *C, size_t ldc, bool accumulate) {
+        constexpr size_t nr = gemm_nr<T>;
+        T tile[gemm_mr * nr] = {};
+
+        for (size_t k = 0; k < kc; ++k, pa += gemm_mr, pb += nr)
+            for (size_t r = 0; r < gemm_mr; ++r)
+                for (size_t c = 0; c < nr; ++c)
+                    tile[r * nr + c] += pa[r] * pb[c];
+
+        for (size_t r = 0; r < gemm_mr; ++r)
+            for (size_t c = 0; c < nr; ++c)
+                C[r * ldc + c] = accumulate ? C[r * ldc + c] + tile[r * nr + c] : tile[r * nr + c];
+    }
+
+
+    #if SIMD_HAS_AVX2
+    SIMD_TARGET_AVX2_BEGIN
+
+    // gemm_kernel_avx2: gemm_kernel_plain with the tile in twelve
+    // registers, one broadcast of A and two FMAs per row and step of k
+    template <typename T>
+    void gemm_kernel_avx2(size_t kc, const T *pa, const T *pb, T *C, size_t ldc, bool accumulate) {
+        using Traits = inner_product_simd_traits<T>;
+        using Add = add_simd_traits<T>;
+        constexpr size_t step = Traits::step;
+
+        auto c00 = Traits::zero(), c01 = Traits::zero(), c10 = Traits::zero(), c11 = Traits::zero();
+        auto c20 = Traits::zero(), c21 = Traits::zero(), c30 = Traits::zero(), c31 = Traits::zero();
+        auto c40 = Traits::zero(), c41 = Traits::zero(), c50 = Traits::zero(), c51 = Traits::zero();
+
+        for (size_t k = 0; k < kc; ++k, pa += gemm_mr, pb += 2 * step) {
+            const auto b0 = Traits::load(pb);
+            const auto b1 = Traits::load(pb + step);
+
+            auto a = Traits::splat(pa[0]);
+            c00 = Traits::mul_add(a, b0, c00);
+            c01 = Traits::mul_add(a, b1, c01);
+            a = Traits::splat(pa[1]);
+            c10 = Traits::mul_add(a, b0, c10);
+            c11 = Traits::mul_add(a, b1, c11);
+            a = Traits::splat(pa[2]);
+            c20 = Traits::mul_add(a, b0, c20);
+            c21 = Traits::mul_add(a, b1, c21);
+            a = Traits::splat(pa[3]);
+            c30 = Traits::mul_add(a, b0, c30);
+            c31 = Traits::mul_add(a, b1, c31);
+            a = Traits::splat(pa[4]);
+            c40 = Traits::mul_add(a, b0, c40);
+            c41 = Traits::mul_add(a, b1, c41);
+            a = Traits::splat(pa[5]);
+            c50 = Traits::mul_add(a, b0, c50);
+            c51 = Traits::mul_add(a, b1, c51);
+        }
+
+        auto store = [&](T *row, typename Traits::simd_type low, typename Traits::simd_type high) {
+            if (accumulate) {
+                low = Add::op(low, Add::load(row));
+                high = Add::op(high, Add::load(row + step));
+            }
+            Add::store(row, low);
+            Add::store(row + step, high);
+        };
+
+        store(C, c00, c01);
+        store(C + ldc, c10, c11);
+        store(C + 2 * ldc, c20, c21);
+        store(C + 3 * ldc, c30, c31);
+        store(C + 4 * ldc, c40, c41);
+        store(C + 5 * ldc, c50, c51);
+    }
+
+    SIMD_TARGET_END
+    #endif
+
+
+    // gemm_blocked
+    template <typename T>
+    void gemm_blocked(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                      const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc) {
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "gemm_blocked needs float or double");
+        constexpr size_t nr = gemm_nr<T>;
+
+        if (K == 0) {
+            for (size_t i = 0; i < M; ++i)
+                std::fill(C + i * ldc, C + i * ldc + N, T(0));
+            return;
+        }
+
+        bool simd = false;
+        #if SIMD_HAS_AVX2
+            simd = simd_level_at_least(simd_level::avx2);
+        #endif
+
+        auto kernel = [simd](size_t kc, const T *pa, const T *pb, T *c, size_t ldc_, bool accumulate) {
+            #if SIMD_HAS_AVX2
+                if (simd)
+                    return gemm_kernel_avx2(kc, pa, pb, c, ldc_, accumulate);
+            #endif
+            gemm_kernel_plain(kc, pa, pb, c, ldc_, accumulate);
+        };
+
+        std::vector<T> packed_b(gemm_kc * ((std::min(N, gemm_nc) + nr - 1) / nr * nr));
+
+        for (size_t j = 0; j < N; j += gemm_nc) {
+            const size_t nc = std::min(gemm_nc, N - j);
+
+            for (size_t p = 0; p < K; p += gemm_kc) {
+                const size_t kc = std::min(gemm_kc, K - p);
+                gemm_pack_b(trans_b, B, ldb, p, kc, j, nc, packed_b.data());
+
+                parallel_rows((M + gemm_mc - 1) / gemm_mc, gemm_mc * nc * kc, [&](size_t block) {
+                    const size_t i = block * gemm_mc;
+                    const size_t mc = std::min(gemm_mc, M - i);
+
+                    std::vector<T> packed_a(gemm_mc * kc);
+                    gemm_pack_a(trans_a, A, lda, i, mc, p, kc, packed_a.data());
+
+                    for (size_t jr = 0; jr < nc; jr += nr) {
+                        const T *pb = packed_b.data() + jr * kc;
+
+                        for (size_t ir = 0; ir < mc; ir += gemm_mr) {
+                            const T *pa = packed_a.data() + ir * kc;
+                            T *c = C + (i + ir) * ldc + j + jr;
+
+                            if (ir + gemm_mr <= mc && jr + nr <= nc) {
+                                kernel(kc, pa, pb, c, ldc, p > 0);
+                                continue;
+                            }
+
+                            T tile[gemm_mr * nr];
+                            kernel(kc, pa, pb, tile, nr, false);
+
+                            for (size_t r = 0; r < std::min(gemm_mr, mc - ir); ++r)
+                                for (size_t col = 0; col < std::min(nr, nc - jr); ++col)
+                                    c[r * ldc + col] = p > 0 ? c[r * ldc + col] + tile[r * nr + col] : tile[r * nr + col];
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+
+    // ========================= fixed-size dot ===============================
+    // With every size a constant the loops unroll completely and the tile
+    // of C lives in registers. Float and double rows that fill whole AVX2
+    // registers get the FMA kernel below, everything else the scalar one.
+    // dot hands square products of the sizes in dot_small here
+
+    // dot_fixed_kernel
+    template <size_t M, size_t N, size_t K, typename T>
+    inline void dot_fixed_kernel(const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc) {
+        for (size_t i = 0; i < M; ++i) {
+            T row[N] = {};
+            for (size_t k = 0; k < K; ++k)
+                for (size_t j = 0; j < N; ++j)
+                    row[j] += A[i * lda + k] * B[k * ldb + j];
+
+            for (size_t j = 0; j < N; ++j)
+                C[i * ldc + j] = row[j];
+        }
+    }
+
+    // dot_fixed_fits_avx2: a row of C is a whole number of 256-bit registers
+    template <typename T, size_t N>
+    inline constexpr bool dot_fixed_fits_avx2 =
+        (std::is_same_v<T, float> || std::is_same_v<T, double>) && N % (32 / sizeof(T)) == 0;
+
+
+    #if SIMD_HAS_AVX2
+    SIMD_TARGET_AVX2_BEGIN
+
+    // dot_rows_avx2: R rows of C held in R * N / step accumulators; each
+    // row of B is loaded once per k and meets one broadcast per row of A
+    template <size_t R, size_t N, size_t K, typename T>
+    void dot_rows_avx2(const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc) {
+        using Traits = inner_product_simd_traits<T>;
+        using Add = add_simd_traits<T>;
+        constexpr size_t step = Traits::step, cols = N / step;
+
+        typename Traits::simd_type acc[R][cols];
+        for (size_t r = 0; r < R; ++r)
+            for (size_t c = 0; c < cols; ++c)
+                acc[r][c] = Traits::zero();
+
+        for (size_t k = 0; k < K; ++k) {
+            typename Traits::simd_type b[cols];
+            for (size_t c = 0; c < cols; ++c)
+                b[c] = Traits::load(B + k * ldb + c * step);
+
+            for (size_t r = 0; r < R; ++r) {
+                const auto a = Traits::splat(A[r * lda + k]);
+                for (size_t c = 0; c < cols; ++c)
+                    acc[r][c] = Traits::mul_add(a, b[c], acc[r][c]);
+            }
+        }
+
+        for (size_t r = 0; r < R; ++r)
+            for (size_t c = 0; c < cols; ++c)
+                Add::store(C + r * ldc + c * step, acc[r][c]);
+    }
+
+    // dot_fixed_avx2: dot_fixed_kernel in blocks of rows sized so the
+    // accumulators take eight of the sixteen registers
+    template <size_t M, size_t N, size_t K, typename T>
+    void dot_fixed_avx2(const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc) {
+        constexpr size_t cols = N / inner_product_simd_traits<T>::step;
+        constexpr size_t R = std::min(M, std::max<size_t>(1, 8 / cols));
+
+        size_t i = 0;
+        for (; i + R <= M; i += R)
+            dot_rows_avx2<R, N, K>(A + i * lda, lda, B, ldb, C + i * ldc, ldc);
+
+        if constexpr (M % R != 0)
+            dot_rows_avx2<M % R, N, K>(A + i * lda, lda, B, ldb, C + i * ldc, ldc);
+    }
+
+    SIMD_TARGET_END
+    #endif
+
+
+    // dot_fixed
+    template <size_t M, size_t N, size_t K, typename T>
+    void dot_fixed(const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc) {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
+
+        #if SIMD_HAS_AVX2
+            if constexpr (dot_fixed_fits_avx2<T, N>)
+                if (simd_level_at_least(simd_level::avx2))
+                    return dot_fixed_avx2<M, N, K>(A, lda, B, ldb, C, ldc);
+        #endif
+
+        dot_fixed_kernel<M, N, K>(A, lda, B, ldb, C, ldc);
+    }
+
+
+    // dot_batched: the batch is split across threads
+    template <size_t M, size_t N, size_t K, typename T>
+    void dot_batched(const T *A, const T *B, size_t stride_b, T *C, size_t count) {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
+
+        bool simd = false;
+        #if SIMD_HAS_AVX2
+            if constexpr (dot_fixed_fits_avx2<T, N>)
+                simd = simd_level_at_least(simd_level::avx2);
+        #endif
+
+        parallel_chunks<T>(count * M * N, [&](size_t begin, size_t end) {
+            // chunks of C, rounded to whole matrices
+            begin = (begin + M * N - 1) / (M * N);
+            end = (end + M * N - 1) / (M * N);
+
+            for (size_t b = begin; b < end; ++b) {
+                const T *a = A + b * M * K, *bm = B + b * stride_b;
+                T *c = C + b * M * N;
+
+                #if SIMD_HAS_AVX2
+                    if constexpr (dot_fixed_fits_avx2<T, N>) {
+                        if (simd) {
+                            dot_fixed_avx2<M, N, K>(a, K, bm, N, c, N);
+                            continue;
+                        }
+                    }
+                #endif
+
+                dot_fixed_kernel<M, N, K>(a, K, bm, N, c, N);
+            }
+        });
+    }
+
+
+    // dot_small: dot_fixed for square products of the sizes geometry and
+    // small blocks use; false when M, N and K are not one of them
+    template <typename T>
+    bool dot_small(size_t M, size_t N, size_t K, const T *A, size_t lda, const T *B, size_t ldb, T *C, size_t ldc) {
+        if (M != N || N != K)
+            return false;
+
+        switch (M) {
+            case 2: dot_fixed<2, 2, 2>(A, lda, B, ldb, C, ldc); return true;
+            case 3: dot_fixed<3, 3, 3>(A, lda, B, ldb, C, ldc); return true;
+            case 4: dot_fixed<4, 4, 4>(A, lda, B, ldb, C, ldc); return true;
+            case 8: dot_fixed<8, 8, 8>(A, lda, B, ldb, C, ldc); return true;
+            case 16: dot_fixed<16, 16, 16>(A, lda, B, ldb, C, ldc); return true;
+            default: return false;
+        }
+    }
+
+
+    // dot
+    template <typename T, typename R>
+    void dot(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+             const T *A, size_t lda, const T *B, size_t ldb, R *C, size_t ldc) {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
+        static_assert(!std::is_same_v<T, char>);
+        static_assert(std::is_same_v<T, R> || (std::is_integral_v<T> && std::is_arithmetic_v<R>),
+                      "Only integer operands can have a result of another type");
+
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            if (!trans_a && !trans_b && dot_small(M, N, K, A, lda, B, ldb, C, ldc))
+                return;
+
+            #if HAS_CBLAS
+                if (M * N * K >= gemm_blas_min_ops) {
+                    const CBLAS_TRANSPOSE op_a = trans_a ? CblasTrans : CblasNoTrans;
+                    const CBLAS_TRANSPOSE op_b = trans_b ? CblasTrans : CblasNoTrans;
+
+                    if constexpr (std::is_same_v<T, float>)
+                        cblas_sgemm(CblasRowMajor, op_a, op_b, M, N, K, 1.0f, A, lda, B, ldb, 0.0f, C, ldc);
+                    else
+                        cblas_dgemm(CblasRowMajor, op_a, op_b, M, N, K, 1.0, A, lda, B, ldb, 0.0, C, ldc);
+                    return;
+                }
+            #endif
+
+            gemm_blocked(trans_a, trans_b, M, N, K, A, lda, B, ldb, C, ldc);
+        } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            // integers are multiplied exactly instead of through a float round-trip
+            dot_integer(trans_a, trans_b, M, N, K, A, lda, B, ldb, C, ldc);
+        } else {
+            // operands keep their own leading dimensions, so only the
+            // addressed elements are converted
+            const size_t rows_a = trans_a ? K : M;
+            const size_t cols_a = trans_a ? M : K;
+            const size_t rows_b = trans_b ? N : K;
+            const size_t cols_b = trans_b ? K : N;
+
+            std::vector<float> float_A((rows_a - 1) * lda + cols_a);
+            std::vector<float> float_B((rows_b - 1) * ldb + cols_b);
+            std::vector<float> float_C(M * N);
+
+            for (size_t i = 0; i < rows_a; ++i)
+                for (size_t j = 0; j < cols_a; ++j)
+                    float_A[i * lda + j] = static_cast<float>(A[i * lda + j]);
+
+            for (size_t i = 0; i < rows_b; ++i)
+                for (size_t j = 0; j < cols_b; ++j)
+                    float_B[i * ldb + j] = static_cast<float>(B[i * ldb + j]);
+
+            dot(trans_a, trans_b, M, N, K, float_A.data(), lda, float_B.data(), ldb, float_C.data(), N);
+
+            for (size_t i = 0; i < M; ++i)
+                for (size_t j = 0; j < N; ++j)
+                    C[i * ldc + j] = static_cast<T>(float_C[i * N + j]);
+        }
+    }
+
+
+    // ============================ batched ==================================
+    // Up to this many multiply-adds per product the batch is split across
+    // threads and every product runs on one; larger products are split by
+    // dot itself, and the batch runs in order
+    constexpr size_t gemm_batch_parallel_max_ops = 256 * 256 * 256;
+
+    // dot_in_batch: one product of a batch split across threads; float and
+    // double stay in the in-tree kernels, so BLAS does not start threads of
+    // its own inside the parallel region
+    template <typename T, typename R>
+    void dot_in_batch(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                      const T *A, size_t lda, const T *B, size_t ldb, R *C, size_t ldc) {
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            if (trans_a || trans_b || !dot_small(M, N, K, A, lda, B, ldb, C, ldc))
+                gemm_blocked(trans_a, trans_b, M, N, K, A, lda, B, ldb, C, ldc);
+        } else {
+            dot(trans_a, trans_b, M, N, K, A, lda, B, ldb, C, ldc);
+        }
+    }
+
+    // dot_strided_batched
+    template <typename T, typename R>
+    void dot_strided_batched(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                             const T *A, size_t lda, size_t stride_a, const T *B, size_t ldb, size_t stride_b,
+                             R *C, size_t ldc, size_t stride_c, size_t count) {
+        if (M * N * K > gemm_batch_parallel_max_ops) {
+            for (size_t b = 0; b < count; ++b)
+                dot(trans_a, trans_b, M, N, K, A + b * stride_a, lda, B + b * stride_b, ldb, C + b * stride_c, ldc);
+            return;
+        }
+
+        parallel_rows(count, M * N * K, [&](size_t b) {
+            dot_in_batch(trans_a, trans_b, M, N, K, A + b * stride_a, lda, B + b * stride_b, ldb, C + b * stride_c, ldc);
+        });
+    }
+
+
+    // dot_pointer_batched
+    template <typename T, typename R>
+    void dot_pointer_batched(bool trans_a, bool trans_b, size_t M, size_t N, size_t K,
+                             const T *const *A, size_t lda, const T *const *B, size_t ldb,
+                             R *const *C, size_t ldc, size_t count) {
+        if (M * N * K > gemm_batch_parallel_max_ops) {
+            for (size_t b = 0; b < count; ++b)
+                dot(trans_a, trans_b, M, N, K, A[b], lda, B[b], ldb, C[b], ldc);
+            return;
+        }
+
+        parallel_rows(count, M * N * K, [&](size_t b) {
+            dot_in_batch(trans_a, trans_b, M, N, K, A[b], lda, B[b], ldb, C[b], ldc);
+        });
+    }
+
+
+    // transpose
+    template <typename T>
+    void transpose(const T *A, size_t rows, size_t cols, size_t lda, T *B, size_t ldb) {
+        #if HAS_CBLAS
+            if constexpr (std::is_same_v<T, float>) {
+                cblas_somatcopy(CblasRowMajor, CblasTrans, rows, cols, 1.0f, A, lda, B, ldb);
+                return;
+            } else if constexpr (std::is_same_v<T, double>) {
+                cblas_domatcopy(CblasRowMajor, CblasTrans, rows, cols, 1.0, A, lda, B, ldb);
+                return;
+            }
+        #endif
+
+        // blocked so both the reads and the writes stay within a few cache lines
+        constexpr size_t block = 32;
+
+        for (size_t ii = 0; ii < rows; ii += block) {
+            const size_t i_end = std::min(ii + block, rows);
+            for (size_t jj = 0; jj < cols; jj += block) {
+                const size_t j_end = std::min(jj + block, cols);
+                for (size_t i = ii; i < i_end; ++i)
+                    for (size_t j = jj; j < j_end; ++j)
+                        B[j * ldb + i] = A[i * lda + j];
+            }
+        }
+    }
+
+
+    // add1
+    template <typename T>
+    void add1(const T *A, const T *B, T *C, size_t n) {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
+        static_assert(!std::is_same_v<T, char>);
+
+        #if HAS_CBLAS
+            if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+                // accumulate into whichever operand C already holds
+                const T *addend = (C == B) ? A : B;
+                if (C != A && C != B) {
+                    if constexpr (std::is_same_v<T, float>)
+                        cblas_scopy(n, A, 1, C, 1);
+                    else
+                        cblas_dcopy(n, A, 1, C, 1);
+                }
+
+                if constexpr (std::is_same_v<T, float>)
+                    cblas_saxpy(n, 1.0f, addend, 1, C, 1);
+                else
+                    cblas_daxpy(n, 1.0, addend, 1, C, 1);
+                return;
+            }
+        #endif
+
+        // integers are added exactly instead of through a float round-trip
+        for (size_t i = 0; i < n; ++i)
+            C[i] = static_cast<T>(A[i] + B[i]);
+    }
+
+
+    // subtract1
+    template <typename T>
+    void subtract1(const T *A, const T *B, T *C, size_t n) {
+        static_assert(std::is_arithmetic_v<T>, "Type must be arithmetic");
+        static_assert(!std::is_same_v<T, char>);
+
+        #if HAS_CBLAS
+            if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+                if (C == B && C != A) {
+                    // C = -C + A
+                    if constexpr (std::is_same_v<T, float>) {
+                        cblas_sscal(n, -1.0f, C, 1);
+                        cblas_saxpy(n, 1.0f, A, 1, C, 1);
+                    } else {
+                        cblas_dscal(n, -1.0, C, 1);
+                        cblas_daxpy(n, 1.0, A, 1, C, 1);
+                    }
+                    return;
+                }
+
+                if (C != A) {
+                    if constexpr (std::is_same_v<T, float>)
+                        cblas_scopy(n, A, 1, C, 1);
+                    else
+                        cblas_dcopy(n, A, 1, C, 1);
+                }
+
+                if constexpr (std::is_same_v<T, float>)
+                    cblas_saxpy(n, -1.0f, B, 1, C, 1);
+                else
+                    cblas_daxpy(n, -1.0, B, 1, C, 1);
+                return;
+            }
+        #endif
+
+        for (size_t i = 0; i < n; ++i)
+            C[i] = static_cast<T>(A[i] - B[i]);
+    }
 }
 
 
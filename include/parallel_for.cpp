@@ -2,6 +2,9 @@
 #define PARALLEL_FOR_HPP
 
 #include <vector>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
 #include <omp.h>
 
 namespace internal {
@@ -13,6 +16,51 @@ namespace internal {
     // apply2
     template <typename T, typename Func>
     void apply2(std::vector<std::vector<T>>& A, Func func);
+
+
+    // ============================ flat ====================================
+
+    // apply1 (A and B may alias)
+    template <typename T, typename Func>
+    void apply1(const T *A, T *B, std::size_t n, Func func);
+
+
+    // apply2 (row-major, leading dimensions lda/ldb)
+    template <typename T, typename Func>
+    void apply2(const T *A, std::size_t lda, T *B, std::size_t ldb,
+                std::size_t rows, std::size_t cols, Func func);
+
+
+    // ========================= elementwise ================================
+
+    // below this many elements an elementwise op stays on the calling thread
+    inline std::atomic<std::size_t> parallel_min_size{static_cast<std::size_t>(1) << 17};
+
+    // parallel_chunks: func(begin, end) over [0, n), one chunk per thread;
+    // chunk boundaries fall on 64-byte lines of T, so they are multiples of
+    // every SIMD width and threads never share a cache line of the output
+    template <typename T, typename Func>
+    void parallel_chunks(std::size_t n, Func func);
+
+
+    // parallel_reduce: func(begin, end) for the chunks of parallel_chunks,
+    // folded in chunk order as combine(later, earlier), so the result does
+    // not depend on which thread ran which chunk. T sizes the chunks; the
+    // partial results are whatever func returns
+    template <typename T, typename Func, typename Combine>
+    std::invoke_result_t<Func, std::size_t, std::size_t> parallel_reduce(std::size_t n, Func func, Combine combine);
+
+
+    // parallel_rows: func(row) for every row, split across threads when
+    // rows * cols is above the threshold
+    template <typename Func>
+    void parallel_rows(std::size_t rows, std::size_t cols, Func func);
+}
+
+
+// Elementwise ops on at least n elements are split across OpenMP threads.
+inline void set_parallel_threshold(std::size_t n) noexcept {
+    internal::parallel_min_size.store(n, std::memory_order_relaxed);
 }
 
 
@@ -37,6 +85,111 @@ namespace internal {
             }
         }
     }
+
+
+    // ============================ flat ====================================
+
+    // apply1
+    template <typename T, typename Func>
+    void apply1(const T *A, T *B, std::size_t n, Func func) {
+        #pragma omp parallel for
+        for (std::size_t i = 0; i < n; ++i) {
+            B[i] = func(A[i]);
+        }
+    }
+
+
+    // apply2
+    template <typename T, typename Func>
+    void apply2(const T *A, std::size_t lda, T *B, std::size_t ldb,
+                std::size_t rows, std::size_t cols, Func func) {
+        #pragma omp parallel for
+        for (std::size_t i = 0; i < rows; ++i) {
+            const T *a_row = A + i * lda;
+            T *b_row = B + i * ldb;
+            for (std::size_t j = 0; j < cols; ++j) {
+                b_row[j] = func(a_row[j]);
+            }
+        }
+    }
+
+
+    // ========================= elementwise ================================
+
+    // chunk_length: elements per thread, rounded up to whole cache lines;
+    // 0 when n stays on the calling thread
+    template <typename T>
+    std::size_t chunk_length(std::size_t n) {
+        const std::size_t threads = omp_in_parallel() ? 1 : static_cast<std::size_t>(omp_get_max_threads());
+
+        if (threads <= 1 || n < parallel_min_size.load(std::memory_order_relaxed))
+            return 0;
+
+        const std::size_t line = std::max<std::size_t>(64 / sizeof(T), 1);
+        return ((n + threads - 1) / threads + line - 1) / line * line;
+    }
+
+
+    // parallel_chunks
+    template <typename T, typename Func>
+    void parallel_chunks(std::size_t n, Func func) {
+        const std::size_t chunk = chunk_length<T>(n);
+
+        if (chunk == 0) {
+            func(static_cast<std::size_t>(0), n);
+            return;
+        }
+
+        const std::size_t num_chunks = (n + chunk - 1) / chunk;
+
+        #pragma omp parallel for schedule(static)
+        for (std::size_t c = 0; c < num_chunks; ++c) {
+            const std::size_t begin = c * chunk;
+            func(begin, std::min(n, begin + chunk));
+        }
+    }
+
+
+    // parallel_reduce
+    template <typename T, typename Func, typename Combine>
+    std::invoke_result_t<Func, std::size_t, std::size_t> parallel_reduce(std::size_t n, Func func, Combine combine) {
+        using R = std::invoke_result_t<Func, std::size_t, std::size_t>;
+        const std::size_t chunk = chunk_length<T>(n);
+
+        if (chunk == 0)
+            return func(static_cast<std::size_t>(0), n);
+
+        const std::size_t num_chunks = (n + chunk - 1) / chunk;
+        std::vector<R> partial(num_chunks);
+
+        #pragma omp parallel for schedule(static)
+        for (std::size_t c = 0; c < num_chunks; ++c) {
+            const std::size_t begin = c * chunk;
+            partial[c] = func(begin, std::min(n, begin + chunk));
+        }
+
+        R result = partial[0];
+        for (std::size_t c = 1; c < num_chunks; ++c)
+            result = combine(partial[c], result);
+
+        return result;
+    }
+
+
+    // parallel_rows
+    template <typename Func>
+    void parallel_rows(std::size_t rows, std::size_t cols, Func func) {
+        if (rows <= 1 || omp_in_parallel() || rows * cols < parallel_min_size.load(std::memory_order_relaxed)) {
+            for (std::size_t i = 0; i < rows; ++i)
+                func(i);
+
+            return;
+        }
+
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < rows; ++i)
+            func(i);
+    }
 }
 
 #endif
@@ -0,0 +1,427 @@
+#ifndef REDUCE_HPP
+#define REDUCE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include "simd_traits.cpp"
+#include "utils/accuracy.cpp"
+#include "utils/simd_operators.cpp"
+#include "parallel_for.cpp"
+
+namespace internal {
+    // ================================= 1D ====================================
+    // NaN elements are skipped by the min/max family, as np.nanmin does;
+    // an all-NaN input gives the identity (inf for min, -inf for max).
+    // Floating-point sums accumulate as mode says, read on the calling thread
+
+    // sum1: total of the n elements, 0 when n is 0
+    template <typename T>
+    T sum1_simd(const T *A, size_t n, summation mode = get_summation());
+
+
+    // dot1: sum of A[i] * B[i]
+    template <typename T>
+    T dot1_simd(const T *A, const T *B, size_t n, summation mode = get_summation());
+
+
+    // prod1: product of the n elements, 1 when n is 0
+    template <typename T>
+    T prod1_simd(const T *A, size_t n);
+
+
+    // amin1 / amax1: smallest / largest element
+    template <typename T>
+    T amin1_simd(const T *A, size_t n);
+
+    template <typename T>
+    T amax1_simd(const T *A, size_t n);
+
+
+    // argmin1 / argmax1: index of the first smallest / largest element
+    template <typename T>
+    size_t argmin1_simd(const T *A, size_t n);
+
+    template <typename T>
+    size_t argmax1_simd(const T *A, size_t n);
+
+
+    // ============================== along an axis ==============================
+    // A is viewed as [outer, len, inner] with the reduced axis in the middle;
+    // result is [outer, inner]
+
+    // sum_axis
+    template <typename T>
+    void sum_axis(const T *A, T *result, size_t outer, size_t len, size_t inner,
+                  summation mode = get_summation());
+
+
+    // prod_axis
+    template <typename T>
+    void prod_axis(const T *A, T *result, size_t outer, size_t len, size_t inner);
+
+
+    // mean_axis: sum_axis scaled by 1 / len
+    template <typename T>
+    void mean_axis(const T *A, T *result, size_t outer, size_t len, size_t inner,
+                   summation mode = get_summation());
+
+
+    // amin_axis / amax_axis
+    template <typename T>
+    void amin_axis(const T *A, T *result, size_t outer, size_t len, size_t inner);
+
+    template <typename T>
+    void amax_axis(const T *A, T *result, size_t outer, size_t len, size_t inner);
+
+
+    // argmin_axis / argmax_axis: position along the axis
+    template <typename T>
+    void argmin_axis(const T *A, int64_t *result, size_t outer, size_t len, size_t inner);
+
+    template <typename T>
+    void argmax_axis(const T *A, int64_t *result, size_t outer, size_t len, size_t inner);
+}
+
+
+namespace internal {
+    // identities of min and max: a NaN-free fold starting from them keeps
+    // every real element
+    template <typename T>
+    constexpr T min_identity() noexcept {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::max();
+    }
+
+    template <typename T>
+    constexpr T max_identity() noexcept {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::lowest();
+    }
+
+    // wrapping: integers are added and multiplied as unsigned (at least
+    // unsigned int, past integer promotion), so an overflowing sum wraps as
+    // the SIMD lanes do instead of being undefined
+    template <typename T>
+    using wrapping = std::common_type<
+        typename std::conditional_t<std::is_integral<T>::value, std::make_unsigned<T>, std::common_type<T>>::type,
+        std::conditional_t<std::is_integral<T>::value, unsigned, T>>;
+
+    // scalar forms of the reductions, element first as dispatch_reduce_op
+    // passes them; x < acc is false for a NaN x, which is then skipped
+    template <typename T>
+    struct sum_op {
+        T operator()(const T& x, const T& acc) const {
+            using U = typename wrapping<T>::type;
+            return static_cast<T>(static_cast<U>(x) + static_cast<U>(acc));
+        }
+    };
+
+    template <typename T>
+    struct prod_op {
+        T operator()(const T& x, const T& acc) const {
+            using U = typename wrapping<T>::type;
+            return static_cast<T>(static_cast<U>(x) * static_cast<U>(acc));
+        }
+    };
+
+    template <typename T>
+    struct amin_op {
+        T operator()(const T& x, const T& acc) const { return x < acc ? x : acc; }
+    };
+
+    template <typename T>
+    struct amax_op {
+        T operator()(const T& x, const T& acc) const { return x > acc ? x : acc; }
+    };
+
+
+    // pairwise summation sums blocks of this many elements with the fast
+    // kernels and adds the block sums as a balanced tree, so the error grows
+    // with log2(n / block) instead of n
+    constexpr size_t pairwise_block = 1024;
+
+    // pairwise_sum: leaf(begin, end) on the blocks of [begin, end), split
+    // on block boundaries
+    template <typename T, typename Leaf>
+    T pairwise_sum(size_t begin, size_t end, Leaf leaf) {
+        const size_t n = end - begin;
+        if (n <= pairwise_block)
+            return leaf(begin, end);
+
+        const size_t half = (n / 2 + pairwise_block - 1) / pairwise_block * pairwise_block;
+        return pairwise_sum<T>(begin, begin + half, leaf) + pairwise_sum<T>(begin + half, end, leaf);
+    }
+
+
+    // ================================= 1D ====================================
+    // sum1_simd
+    template <typename T>
+    T sum1_simd(const T *A, size_t n, summation mode) {
+        if constexpr (std::is_floating_point<T>::value) {
+            if (mode == summation::compensated)
+                return dispatch_sum_compensated(A, n);
+
+            if (mode == summation::pairwise) {
+                return parallel_reduce<T>(n, [&](size_t begin, size_t end) {
+                    return pairwise_sum<T>(begin, end, [&](size_t b, size_t e) {
+                        return dispatch_reduce_op_serial<T, add_simd_traits>(A + b, e - b, T(0), sum_op<T>());
+                    });
+                }, sum_op<T>());
+            }
+        }
+
+        return dispatch_reduce_op<T, add_simd_traits>(A, n, T(0), sum_op<T>());
+    }
+
+
+    // dot1_simd
+    template <typename T>
+    T dot1_simd(const T *A, const T *B, size_t n, summation mode) {
+        if constexpr (std::is_floating_point<T>::value) {
+            if (mode == summation::compensated)
+                return dispatch_dot_compensated(A, B, n);
+
+            if (mode == summation::pairwise) {
+                return parallel_reduce<T>(n, [&](size_t begin, size_t end) {
+                    return pairwise_sum<T>(begin, end, [&](size_t b, size_t e) {
+                        return dispatch_dot_op_serial(A + b, B + b, e - b, sum_op<T>(), prod_op<T>());
+                    });
+                }, sum_op<T>());
+            }
+        }
+
+        return dispatch_dot_op(A, B, n, sum_op<T>(), prod_op<T>());
+    }
+
+
+    // prod1_simd
+    template <typename T>
+    T prod1_simd(const T *A, size_t n) {
+        return dispatch_reduce_op<T, mul_simd_traits>(A, n, T(1), prod_op<T>());
+    }
+
+
+    // amin1_simd
+    template <typename T>
+    T amin1_simd(const T *A, size_t n) {
+        return dispatch_reduce_op<T, min_simd_traits>(A, n, min_identity<T>(), amin_op<T>());
+    }
+
+
+    // amax1_simd
+    template <typename T>
+    T amax1_simd(const T *A, size_t n) {
+        return dispatch_reduce_op<T, max_simd_traits>(A, n, max_identity<T>(), amax_op<T>());
+    }
+
+
+    // argmin1_simd / argmax1_simd: the extreme value from the SIMD reduction,
+    // then the first element equal to it; 0 if there is none (all NaN)
+    template <typename T>
+    size_t argmin1_simd(const T *A, size_t n) {
+        const T m = amin1_simd(A, n);
+        const size_t i = std::find(A, A + n, m) - A;
+
+        return i < n ? i : 0;
+    }
+
+    template <typename T>
+    size_t argmax1_simd(const T *A, size_t n) {
+        const T m = amax1_simd(A, n);
+        const size_t i = std::find(A, A + n, m) - A;
+
+        return i < n ? i : 0;
+    }
+
+
+    // ============================== along an axis ==============================
+    // a strided axis streams this many bytes of accumulators per tile, so
+    // they stay in L1 while the rows go past
+    constexpr size_t reduce_tile_bytes = 16 << 10;
+
+    // reduce_axis: a contiguous axis is one dispatch_reduce_op per row. A
+    // strided one folds whole rows into [inner] accumulators with the
+    // elementwise kernel instead of walking columns; with a single block the
+    // columns are split across threads
+    template <typename T, template <typename> class Traits, typename BinaryOp>
+    void reduce_axis(const T *A, T *result, size_t outer, size_t len, size_t inner,
+                     T identity, BinaryOp binary_op) {
+        if (inner == 1) {
+            parallel_rows(outer, len, [&](size_t o) {
+                result[o] = dispatch_reduce_op<T, Traits>(A + o * len, len, identity, binary_op);
+            });
+            return;
+        }
+
+        const size_t tile = std::max<size_t>(reduce_tile_bytes / sizeof(T), 1);
+
+        parallel_rows(outer, len * inner, [&](size_t o) {
+            const T *a = A + o * len * inner;
+            T *r = result + o * inner;
+
+            parallel_chunks<T>(inner, [&](size_t begin, size_t end) {
+                std::fill(r + begin, r + end, identity);
+
+                for (size_t j = begin; j < end; j += tile) {
+                    const size_t count = std::min(tile, end - j);
+                    for (size_t k = 0; k < len; ++k)
+                        dispatch_binary_op<T, Traits>(a + k * inner + j, r + j, r + j, count, binary_op);
+                }
+            });
+        });
+    }
+
+
+    // sum_axis_compensated: a strided axis under pairwise or compensated
+    // summation. Each column keeps a compensation next to its sum and takes
+    // one TwoSum per row, which vectorises across the columns of a tile
+    template <typename T>
+    void sum_axis_compensated(const T *A, T *result, size_t outer, size_t len, size_t inner) {
+        const size_t tile = std::max<size_t>(reduce_tile_bytes / (2 * sizeof(T)), 1);
+
+        parallel_rows(outer, len * inner, [&](size_t o) {
+            const T *a = A + o * len * inner;
+            T *r = result + o * inner;
+
+            parallel_chunks<T>(inner, [&](size_t begin, size_t end) {
+                std::vector<T> comp(std::min(tile, end - begin));
+
+                for (size_t j = begin; j < end; j += tile) {
+                    const size_t count = std::min(tile, end - j);
+                    std::fill(r + j, r + j + count, T(0));
+                    std::fill(comp.begin(), comp.begin() + count, T(0));
+
+                    for (size_t k = 0; k < len; ++k) {
+                        const T *row = a + k * inner + j;
+                        for (size_t m = 0; m < count; ++m)
+                            two_sum(r[j + m], comp[m], row[m]);
+                    }
+
+                    for (size_t m = 0; m < count; ++m)
+                        r[j + m] = compensated_total(std::pair<T, T>(r[j + m], comp[m]));
+                }
+            });
+        });
+    }
+
+
+    // sum_axis: a contiguous axis follows mode through sum1_simd; a strided
+    // one is compensated under either accurate mode
+    template <typename T>
+    void sum_axis(const T *A, T *result, size_t outer, size_t len, size_t inner, summation mode) {
+        if constexpr (std::is_floating_point<T>::value) {
+            if (mode != summation::fast) {
+                if (inner == 1) {
+                    parallel_rows(outer, len, [&](size_t o) {
+                        result[o] = sum1_simd(A + o * len, len, mode);
+                    });
+                } else {
+                    sum_axis_compensated(A, result, outer, len, inner);
+                }
+
+                return;
+            }
+        }
+
+        reduce_axis<T, add_simd_traits>(A, result, outer, len, inner, T(0), sum_op<T>());
+    }
+
+
+    // prod_axis
+    template <typename T>
+    void prod_axis(const T *A, T *result, size_t outer, size_t len, size_t inner) {
+        reduce_axis<T, mul_simd_traits>(A, result, outer, len, inner, T(1), prod_op<T>());
+    }
+
+
+    // mean_axis
+    template <typename T>
+    void mean_axis(const T *A, T *result, size_t outer, size_t len, size_t inner, summation mode) {
+        static_assert(std::is_floating_point<T>::value, "mean needs a floating-point type.");
+
+        sum_axis(A, result, outer, len, inner, mode);
+
+        const T scale = T(1) / static_cast<T>(len);
+        for (size_t i = 0; i < outer * inner; ++i)
+            result[i] *= scale;
+    }
+
+
+    // amin_axis
+    template <typename T>
+    void amin_axis(const T *A, T *result, size_t outer, size_t len, size_t inner) {
+        reduce_axis<T, min_simd_traits>(A, result, outer, len, inner, min_identity<T>(), amin_op<T>());
+    }
+
+
+    // amax_axis
+    template <typename T>
+    void amax_axis(const T *A, T *result, size_t outer, size_t len, size_t inner) {
+        reduce_axis<T, max_simd_traits>(A, result, outer, len, inner, max_identity<T>(), amax_op<T>());
+    }
+
+
+    // arg_axis: a contiguous axis goes through argmin1/argmax1 row by row. A
+    // strided one streams the rows of a block, keeping the best value and
+    // its row per column; a column still at the identity takes the first row
+    // equal to it, so the answer matches the contiguous path
+    template <typename T, typename Better, typename ArgRow>
+    void arg_axis(const T *A, int64_t *result, size_t outer, size_t len, size_t inner,
+                  T identity, Better better, ArgRow arg_row) {
+        if (inner == 1) {
+            parallel_rows(outer, len, [&](size_t o) {
+                result[o] = static_cast<int64_t>(arg_row(A + o * len, len));
+            });
+            return;
+        }
+
+        parallel_rows(outer, len * inner, [&](size_t o) {
+            const T *a = A + o * len * inner;
+            int64_t *r = result + o * inner;
+
+            parallel_chunks<T>(inner, [&](size_t begin, size_t end) {
+                std::vector<T> best(end - begin, identity);
+                std::fill(r + begin, r + end, int64_t(-1));
+
+                for (size_t k = 0; k < len; ++k) {
+                    const T *row = a + k * inner + begin;
+                    int64_t *index = r + begin;
+
+                    for (size_t j = 0; j < end - begin; ++j) {
+                        if (better(row[j], best[j]) || (index[j] < 0 && row[j] == best[j])) {
+                            best[j] = row[j];
+                            index[j] = static_cast<int64_t>(k);
+                        }
+                    }
+                }
+
+                for (size_t j = begin; j < end; ++j)
+                    r[j] = std::max<int64_t>(r[j], 0);
+            });
+        });
+    }
+
+
+    // argmin_axis
+    template <typename T>
+    void argmin_axis(const T *A, int64_t *result, size_t outer, size_t len, size_t inner) {
+        arg_axis(A, result, outer, len, inner, min_identity<T>(),
+                 [](const T& x, const T& best) { return x < best; },
+                 [](const T *row, size_t n) { return argmin1_simd(row, n); });
+    }
+
+
+    // argmax_axis
+    template <typename T>
+    void argmax_axis(const T *A, int64_t *result, size_t outer, size_t len, size_t inner) {
+        arg_axis(A, result, outer, len, inner, max_identity<T>(),
+                 [](const T& x, const T& best) { return x > best; },
+                 [](const T *row, size_t n) { return argmax1_simd(row, n); });
+    }
+}
+
+
+#endif
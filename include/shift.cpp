@@ -6,9 +6,6 @@
 #include "simd_traits.cpp"
 #include "utils/utils.cpp"
 #include "utils/simd_operators.cpp"
-#ifdef __AVX2__
-    #include <immintrin.h>
-#endif
 #include <stdexcept>
 
 namespace internal {
@@ -18,11 +15,41 @@ namespace internal {
     template <typename T>
     std::vector<T> slli1_simd(const std::vector<T>& A, const int imm);
 
+    template <typename T>
+    void slli1_simd(const T *A, T *result, size_t n, const int imm);
+
 
     // srli1
     template <typename T>
     std::vector<T> srli1_simd(const std::vector<T>& A, const int imm);
 
+    template <typename T>
+    void srli1_simd(const T *A, T *result, size_t n, const int imm);
+
+
+    // srai1
+    template <typename T>
+    std::vector<T> srai1_simd(const std::vector<T>& A, const int imm);
+
+    template <typename T>
+    void srai1_simd(const T *A, T *result, size_t n, const int imm);
+
+
+    // sllv1: element i of A shifted left by element i of B
+    template <typename T>
+    std::vector<T> sllv1_simd(const std::vector<T>& A, const std::vector<T>& B);
+
+    template <typename T>
+    void sllv1_simd(const T *A, const T *B, T *result, size_t n);
+
+
+    // srlv1
+    template <typename T>
+    std::vector<T> srlv1_simd(const std::vector<T>& A, const std::vector<T>& B);
+
+    template <typename T>
+    void srlv1_simd(const T *A, const T *B, T *result, size_t n);
+
 
     // ========================== 2D =============================
 
@@ -34,6 +61,21 @@ namespace internal {
     // srli2
     template <typename T>
     std::vector<std::vector<T>> srli2_simd(const std::vector<std::vector<T>>& A, const int imm);
+
+
+    // srai2
+    template <typename T>
+    std::vector<std::vector<T>> srai2_simd(const std::vector<std::vector<T>>& A, const int imm);
+
+
+    // sllv2
+    template <typename T>
+    std::vector<std::vector<T>> sllv2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B);
+
+
+    // srlv2
+    template <typename T>
+    std::vector<std::vector<T>> srlv2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B);
 }
 
 namespace internal {
@@ -41,53 +83,120 @@ namespace internal {
  
     // slli1_simd
     template <typename T>
-    std::vector<T> slli1_simd(const std::vector<T>& A, const int imm8) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [imm8](const T& element) { return element << imm8; }); 
+    void slli1_simd(const T *A, T *result, size_t n, const int imm8) {
+        dispatch_unary_op_shift<T, slli_simd_traits>(A, result, n, imm8, [imm8](const T& element) { return shift_left(element, imm8); });
+    }
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [imm8](const T& element) { return element << imm8; }); 
-        #endif
+    template <typename T>
+    std::vector<T> slli1_simd(const std::vector<T>& A, const int imm8) {
+        std::vector<T> result(A.size());
+        slli1_simd(A.data(), result.data(), A.size(), imm8);
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd_shift<T, slli_simd_traits<T>>(A, imm8, [imm8](const T& element) { return element << imm8; });
-        #endif
+        return result;
     }
 
 
     // srli1_simd
+    template <typename T>
+    void srli1_simd(const T *A, T *result, size_t n, const int imm8) {
+        dispatch_unary_op_shift<T, srli_simd_traits>(A, result, n, imm8, [imm8](const T& element) { return shift_right_logical(element, imm8); });
+    }
+
     template <typename T>
     std::vector<T> srli1_simd(const std::vector<T>& A, const int imm8) {
-        if (A.size() < 32)
-            return apply_unary_op_plain(A, [imm8](const T& element) { return element >> imm8; });
+        std::vector<T> result(A.size());
+        srli1_simd(A.data(), result.data(), A.size(), imm8);
 
-        #ifdef __riscv
-            return apply_unary_op_plain(A, [imm8](const T& element) { return element >> imm8; });
-        #endif
+        return result;
+    }
+
+
+    // srai1_simd
+    template <typename T>
+    void srai1_simd(const T *A, T *result, size_t n, const int imm8) {
+        dispatch_unary_op_shift<T, srai_simd_traits>(A, result, n, imm8, [imm8](const T& element) { return shift_right_arith(element, imm8); });
+    }
+
+    template <typename T>
+    std::vector<T> srai1_simd(const std::vector<T>& A, const int imm8) {
+        std::vector<T> result(A.size());
+        srai1_simd(A.data(), result.data(), A.size(), imm8);
+
+        return result;
+    }
+
+
+    // sllv1_simd
+    template <typename T>
+    void sllv1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, sllv_simd_traits>(A, B, result, n, [](const T& a, const T& b) { return shift_left(a, b); });
+    }
+
+    template <typename T>
+    std::vector<T> sllv1_simd(const std::vector<T>& A, const std::vector<T>& B) {
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
+
+        std::vector<T> result(A.size());
+        sllv1_simd(A.data(), B.data(), result.data(), A.size());
+
+        return result;
+    }
 
-        #ifdef __AVX2__
-            return apply_unary_op_simd_shift<T, srli_simd_traits<T>>(A, imm8, [imm8](const T& element) { return element >> imm8; });
-        #endif
+
+    // srlv1_simd
+    template <typename T>
+    void srlv1_simd(const T *A, const T *B, T *result, size_t n) {
+        dispatch_binary_op<T, srlv_simd_traits>(A, B, result, n, [](const T& a, const T& b) { return shift_right_logical(a, b); });
+    }
+
+    template <typename T>
+    std::vector<T> srlv1_simd(const std::vector<T>& A, const std::vector<T>& B) {
+        if (A.size() != B.size())
+            throw std::invalid_argument("Input vectors must be of the same size.");
+
+        std::vector<T> result(A.size());
+        srlv1_simd(A.data(), B.data(), result.data(), A.size());
+
+        return result;
     }
 
 
     // ========================== 2D =============================
 
-    #ifdef __AVX2__
     // slli2_simd
     template <typename T>
     std::vector<std::vector<T>> slli2_simd(const std::vector<std::vector<T>>& A, const int imm8) {
-        return apply_unary_op_shift(A, imm8, slli1_simd<T>);
+        return apply_unary_op_shift(A, imm8, [](const std::vector<T>& a, const int imm) { return slli1_simd(a, imm); });
     }
 
 
     // srli2_simd
     template <typename T>
     std::vector<std::vector<T>> srli2_simd(const std::vector<std::vector<T>>& A, const int imm8) {
-        return apply_unary_op_shift(A, imm8, srli1_simd<T>);
+        return apply_unary_op_shift(A, imm8, [](const std::vector<T>& a, const int imm) { return srli1_simd(a, imm); });
+    }
+
+
+    // srai2_simd
+    template <typename T>
+    std::vector<std::vector<T>> srai2_simd(const std::vector<std::vector<T>>& A, const int imm8) {
+        return apply_unary_op_shift(A, imm8, [](const std::vector<T>& a, const int imm) { return srai1_simd(a, imm); });
     }
 
-    #endif
+
+    // sllv2_simd
+    template <typename T>
+    std::vector<std::vector<T>> sllv2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B) {
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) { return sllv1_simd(a, b); });
+    }
+
+
+    // srlv2_simd
+    template <typename T>
+    std::vector<std::vector<T>> srlv2_simd(const std::vector<std::vector<T>>& A, const std::vector<std::vector<T>>& B) {
+        return apply_binary_op(A, B, [](const std::vector<T>& a, const std::vector<T>& b) { return srlv1_simd(a, b); });
+    }
 }
 
 
@@ -1,14 +1,74 @@
 #ifndef SIMD_TRAITS_HPP
 #define SIMD_TRAITS_HPP
 
-#ifdef __AVX2__
+#include "utils/cpu_features.cpp"
+#if SIMD_HAS_AVX2
     #include <immintrin.h>
 #endif
 #include <cstdint>
+#include <cmath>
 #include <type_traits>
 
+// Every trait is declared on all targets so kernels can name it; only the
+// targets that have the instructions provide a definition.
+template <typename T> struct inner_product_simd_traits;
+template <typename T> struct and_simd_traits;
+template <typename T> struct or_simd_traits;
+template <typename T> struct xor_simd_traits;
+template <typename T> struct andnot_simd_traits;
+template <typename T> struct testc_simd_traits;
+template <typename T> struct slli_simd_traits;
+template <typename T> struct srli_simd_traits;
+template <typename T> struct srai_simd_traits;
+template <typename T> struct sllv_simd_traits;
+template <typename T> struct srlv_simd_traits;
+template <typename T> struct min_simd_traits;
+template <typename T> struct max_simd_traits;
+template <typename T> struct sqrt_simd_traits;
+template <typename T> struct rsqrt_simd_traits;
+template <typename T> struct rsqrt_ulp1_simd_traits;
+template <typename T> struct rsqrt_ulp4_simd_traits;
+template <typename T> struct exp_ulp4_simd_traits;
+template <typename T> struct log_ulp4_simd_traits;
+template <typename T> struct round_simd_traits;
+template <typename T> struct ceil_simd_traits;
+template <typename T> struct floor_simd_traits;
+template <typename T> struct abs_simd_traits;
+template <typename T> struct add_simd_traits;
+template <typename T> struct sub_simd_traits;
+template <typename T> struct mul_simd_traits;
+
+
+namespace internal {
+    // scalar shifts with the semantics of the vector instructions: a count
+    // outside [0, bits) clears the lane, or fills it with the sign bit for
+    // an arithmetic shift, instead of being undefined
+    template <typename T>
+    constexpr T shift_left(T a, unsigned long long count) noexcept {
+        using U = std::make_unsigned_t<T>;
+        return count >= sizeof(T) * 8 ? T(0) : static_cast<T>(static_cast<U>(static_cast<U>(a) << count));
+    }
+
+    template <typename T>
+    constexpr T shift_right_logical(T a, unsigned long long count) noexcept {
+        using U = std::make_unsigned_t<T>;
+        return count >= sizeof(T) * 8 ? T(0) : static_cast<T>(static_cast<U>(a) >> count);
+    }
+
+    // shift_right_arith: unsigned types have no sign and shift logically
+    template <typename T>
+    constexpr T shift_right_arith(T a, unsigned long long count) noexcept {
+        if constexpr (std::is_unsigned<T>::value)
+            return shift_right_logical(a, count);
+        else
+            return static_cast<T>(a >> (count >= sizeof(T) * 8 ? sizeof(T) * 8 - 1 : count));
+    }
+}
+
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX2_BEGIN
 
-#ifdef __AVX2__
 // inner_product_simd
 template <typename T>
 struct inner_product_simd_traits;
@@ -26,6 +86,8 @@ struct inner_product_simd_traits<float> {
         return _mm256_loadu_ps(ptr);
     }
 
+    static simd_type splat(scalar_type x) noexcept { return _mm256_set1_ps(x); }
+
     static simd_type mul_add(simd_type a, simd_type b, simd_type c) noexcept {
         return _mm256_fmadd_ps(a, b, c);
     }
@@ -53,6 +115,8 @@ struct inner_product_simd_traits<double> {
         return _mm256_loadu_pd(ptr);
     }
 
+    static simd_type splat(scalar_type x) noexcept { return _mm256_set1_pd(x); }
+
     static simd_type mul_add(simd_type a, simd_type b, simd_type c) noexcept {
         return _mm256_fmadd_pd(a, b, c);
     }
@@ -79,25 +143,17 @@ struct inner_product_simd_traits<int8_t> {
         return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
     }
 
+    // widened to 16 bits, then madd_epi16 multiplies and adds pairs
+    // straight into 32-bit lanes, exact for every 8-bit input (maddubs
+    // would saturate)
     static simd_type mul_add(simd_type a, simd_type b, simd_type acc) noexcept {
-        // չ
-        __m256i a_lo = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(a, 0));
+        __m256i a_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(a));
         __m256i a_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(a, 1));
-        __m256i b_lo = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(b, 0));
+        __m256i b_lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(b));
         __m256i b_hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(b, 1));
 
-        __m256i prod_lo = _mm256_mullo_epi16(a_lo, b_lo);
-        __m256i prod_hi = _mm256_mullo_epi16(a_hi, b_hi);
-
-        // չΪ32λۼ
-        __m256i acc_lo = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(prod_lo, 0));
-        __m256i acc_hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(prod_lo, 1));
-        acc = _mm256_add_epi32(acc, acc_lo);
-        acc = _mm256_add_epi32(acc, acc_hi);
-
-        acc_lo = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(prod_hi, 0));
-        acc_hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(prod_hi, 1));
-        return _mm256_add_epi32(acc, _mm256_add_epi32(acc_lo, acc_hi));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a_lo, b_lo));
+        return _mm256_add_epi32(acc, _mm256_madd_epi16(a_hi, b_hi));
     }
 
     static accum_type horizontal_sum(simd_type sum) noexcept {
@@ -106,7 +162,7 @@ struct inner_product_simd_traits<int8_t> {
         low = _mm_add_epi32(low, high);
         low = _mm_hadd_epi32(low, low);
         low = _mm_hadd_epi32(low, low);
-        return _mm_extract_epi32(low, 0) + _mm_extract_epi32(low, 1);
+        return static_cast<accum_type>(_mm_cvtsi128_si32(low));
     }
 };
 
@@ -123,25 +179,17 @@ struct inner_product_simd_traits<uint8_t> {
         return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
     }
 
+    // widened to 16 bits, then madd_epi16 multiplies and adds pairs
+    // straight into 32-bit lanes, exact for every 8-bit input (maddubs
+    // would saturate)
     static simd_type mul_add(simd_type a, simd_type b, simd_type acc) noexcept {
-        // չ
-        __m256i a_lo = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 0));
+        __m256i a_lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a));
         __m256i a_hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1));
-        __m256i b_lo = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 0));
+        __m256i b_lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b));
         __m256i b_hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1));
 
-        __m256i prod_lo = _mm256_mullo_epi16(a_lo, b_lo);
-        __m256i prod_hi = _mm256_mullo_epi16(a_hi, b_hi);
-
-        // չΪ32λۼ
-        __m256i acc_lo = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(prod_lo, 0));
-        __m256i acc_hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(prod_lo, 1));
-        acc = _mm256_add_epi32(acc, acc_lo);
-        acc = _mm256_add_epi32(acc, acc_hi);
-
-        acc_lo = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(prod_hi, 0));
-        acc_hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(prod_hi, 1));
-        return _mm256_add_epi32(acc, _mm256_add_epi32(acc_lo, acc_hi));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a_lo, b_lo));
+        return _mm256_add_epi32(acc, _mm256_madd_epi16(a_hi, b_hi));
     }
 
     static accum_type horizontal_sum(simd_type sum) noexcept {
@@ -150,7 +198,7 @@ struct inner_product_simd_traits<uint8_t> {
         low = _mm_add_epi32(low, high);
         low = _mm_hadd_epi32(low, low);
         low = _mm_hadd_epi32(low, low);
-        return _mm_extract_epi32(low, 0) + _mm_extract_epi32(low, 1);
+        return static_cast<accum_type>(_mm_cvtsi128_si32(low));
     }
 };
 
@@ -168,10 +216,7 @@ struct inner_product_simd_traits<int16_t> {
     }
 
     static simd_type mul_add(simd_type a, simd_type b, simd_type acc) noexcept {
-        __m256i prod = _mm256_mullo_epi16(a, b);
-        __m256i prod_lo = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(prod, 0));
-        __m256i prod_hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(prod, 1));
-        return _mm256_add_epi32(acc, _mm256_add_epi32(prod_lo, prod_hi));
+        return _mm256_add_epi32(acc, _mm256_madd_epi16(a, b));
     }
 
     static accum_type horizontal_sum(simd_type sum) noexcept {
@@ -180,7 +225,7 @@ struct inner_product_simd_traits<int16_t> {
         low = _mm_add_epi32(low, high);
         low = _mm_hadd_epi32(low, low);
         low = _mm_hadd_epi32(low, low);
-        return _mm_extract_epi32(low, 0) + _mm_extract_epi32(low, 1);
+        return static_cast<accum_type>(_mm_cvtsi128_si32(low));
     }
 };
 
@@ -197,11 +242,14 @@ struct inner_product_simd_traits<uint16_t> {
         return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
     }
 
+    // madd_epi16 is signed, so the 32-bit products are put together from
+    // their low and high halves instead
     static simd_type mul_add(simd_type a, simd_type b, simd_type acc) noexcept {
-        __m256i prod = _mm256_mullo_epi16(a, b);
-        __m256i prod_lo = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(prod, 0));
-        __m256i prod_hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(prod, 1));
-        return _mm256_add_epi32(acc, _mm256_add_epi32(prod_lo, prod_hi));
+        __m256i low = _mm256_mullo_epi16(a, b);
+        __m256i high = _mm256_mulhi_epu16(a, b);
+
+        acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(low, high));
+        return _mm256_add_epi32(acc, _mm256_unpackhi_epi16(low, high));
     }
 
     static accum_type horizontal_sum(simd_type sum) noexcept {
@@ -210,7 +258,7 @@ struct inner_product_simd_traits<uint16_t> {
         low = _mm_add_epi32(low, high);
         low = _mm_hadd_epi32(low, low);
         low = _mm_hadd_epi32(low, low);
-        return _mm_extract_epi32(low, 0) + _mm_extract_epi32(low, 1);
+        return static_cast<accum_type>(_mm_cvtsi128_si32(low));
     }
 };
 
@@ -237,7 +285,7 @@ struct inner_product_simd_traits<int32_t> {
         low = _mm_add_epi32(low, high);
         low = _mm_hadd_epi32(low, low);
         low = _mm_hadd_epi32(low, low);
-        return _mm_extract_epi32(low, 0) + _mm_extract_epi32(low, 1);
+        return static_cast<accum_type>(_mm_cvtsi128_si32(low));
     }
 };
 
@@ -264,7 +312,7 @@ struct inner_product_simd_traits<uint32_t> {
         low = _mm_add_epi32(low, high);
         low = _mm_hadd_epi32(low, low);
         low = _mm_hadd_epi32(low, low);
-        return _mm_extract_epi32(low, 0) + _mm_extract_epi32(low, 1);
+        return static_cast<accum_type>(_mm_cvtsi128_si32(low));
     }
 };
 
@@ -281,22 +329,21 @@ struct inner_product_simd_traits<int64_t> {
         return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
     }
 
+    // low 64 bits of the product from 32-bit halves: lo * lo plus the two
+    // cross terms shifted up, the same for either signedness
     static simd_type mul_add(simd_type a, simd_type b, simd_type acc) noexcept {
-        __m128i a_lo = _mm256_extracti128_si256(a, 0);
-        __m128i a_hi = _mm256_extracti128_si256(a, 1);
-        __m128i b_lo = _mm256_extracti128_si256(b, 0);
-        __m128i b_hi = _mm256_extracti128_si256(b, 1);
-
-        __m128i prod_lo = _mm_mul_epi32(a_lo, b_lo);
-        __m128i prod_hi = _mm_mul_epi32(a_hi, b_hi);
-        return _mm256_add_epi64(acc, _mm256_setr_m128i(prod_lo, prod_hi));
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                         _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        __m256i product = _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+        return _mm256_add_epi64(acc, product);
     }
 
     static accum_type horizontal_sum(simd_type sum) noexcept {
         __m128i low = _mm256_extracti128_si256(sum, 0);
         __m128i high = _mm256_extracti128_si256(sum, 1);
         low = _mm_add_epi64(low, high);
-        return _mm_extract_epi64(low, 0) + _mm_extract_epi64(low, 1);
+        return static_cast<accum_type>(static_cast<uint64_t>(_mm_extract_epi64(low, 0))
+                                       + static_cast<uint64_t>(_mm_extract_epi64(low, 1)));
     }
 };
 
@@ -307,37 +354,27 @@ struct inner_product_simd_traits<uint64_t> {
     using simd_type = __m256i;
     static constexpr size_t step = 4;
 
-    static simd_type zero() noexcept { 
-        return _mm256_setzero_si256(); 
-    }
+    static simd_type zero() noexcept { return _mm256_setzero_si256(); }
 
     static simd_type load(const scalar_type* ptr) noexcept {
         return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
     }
 
+    // low 64 bits of the product from 32-bit halves: lo * lo plus the two
+    // cross terms shifted up, the same for either signedness
     static simd_type mul_add(simd_type a, simd_type b, simd_type acc) noexcept {
-        // Ϊ 128-bit ͨ
-        __m128i a_lo = _mm256_extracti128_si256(a, 0);
-        __m128i a_hi = _mm256_extracti128_si256(a, 1);
-        __m128i b_lo = _mm256_extracti128_si256(b, 0);
-        __m128i b_hi = _mm256_extracti128_si256(b, 1);
-
-        // ޷ 64-bit ˷ (Ҫ⴦)
-        __m128i prod_lo = _mm_mul_epu32(a_lo, b_lo);  // ʹ޷ų˷
-        __m128i prod_hi = _mm_mul_epu32(a_hi, b_hi);
-
-        // ϲۼ
-        return _mm256_add_epi64(acc, _mm256_setr_m128i(prod_lo, prod_hi));
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                         _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        __m256i product = _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+        return _mm256_add_epi64(acc, product);
     }
 
     static accum_type horizontal_sum(simd_type sum) noexcept {
-        // 128-bit ˮƽ
         __m128i low = _mm256_extracti128_si256(sum, 0);
         __m128i high = _mm256_extracti128_si256(sum, 1);
         low = _mm_add_epi64(low, high);
-
-        // ȡս
-        return static_cast<uint64_t>(_mm_extract_epi64(low, 0)) + static_cast<uint64_t>(_mm_extract_epi64(low, 1));
+        return static_cast<accum_type>(static_cast<uint64_t>(_mm_extract_epi64(low, 0))
+                                       + static_cast<uint64_t>(_mm_extract_epi64(low, 1)));
     }
 };
 
@@ -640,9 +677,12 @@ struct testc_simd_traits<double> {
 };
 
 
-// slli_simd
+// slli_simd: one shift per lane width; bytes shift as 16-bit lanes and
+// drop the bits that crossed into the neighbouring byte
 template <typename T>
 struct slli_simd_traits {
+    static_assert(std::is_integral<T>::value, "Unsupported scalar type.");
+
     using scalar_type = T;
     using simd_type = __m256i;
     static constexpr size_t step = sizeof(__m256i) / sizeof(T);
@@ -655,18 +695,29 @@ struct slli_simd_traits {
         _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), val);
     }
 
+    // counts of bits or more (and negative ones) clear every lane
     static simd_type op(simd_type a, int imm8) noexcept {
-        for (int i = 0; i < imm8; ++i) {
-            a = _mm256_slli_epi32(a, 1);
+        const __m128i count = _mm_cvtsi32_si128(imm8);
+
+        if constexpr (sizeof(T) == 1) {
+            const __m256i keep = _mm256_set1_epi8(static_cast<char>(static_cast<unsigned>(imm8) >= 8 ? 0 : 0xff << imm8));
+            return _mm256_and_si256(_mm256_sll_epi16(a, count), keep);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_sll_epi16(a, count);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_sll_epi32(a, count);
+        } else {
+            return _mm256_sll_epi64(a, count);
         }
-        return a;
     }
 };
 
 
-// srli_simd
+// srli_simd: logical shift, zeros come in from the top whatever the sign
 template <typename T>
 struct srli_simd_traits {
+    static_assert(std::is_integral<T>::value, "Unsupported scalar type.");
+
     using scalar_type = T;
     using simd_type = __m256i;
     static constexpr size_t step = sizeof(__m256i) / sizeof(T);
@@ -680,14 +731,125 @@ struct srli_simd_traits {
     }
 
     static simd_type op(simd_type a, int imm8) noexcept {
-        for (int i = 0; i < imm8; ++i) {
-            a = _mm256_srli_epi32(a, 1);
+        const __m128i count = _mm_cvtsi32_si128(imm8);
+
+        if constexpr (sizeof(T) == 1) {
+            const __m256i keep = _mm256_set1_epi8(static_cast<char>(static_cast<unsigned>(imm8) >= 8 ? 0 : 0xff >> imm8));
+            return _mm256_and_si256(_mm256_srl_epi16(a, count), keep);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_srl_epi16(a, count);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_srl_epi32(a, count);
+        } else {
+            return _mm256_srl_epi64(a, count);
         }
-        return a;
     }
 };
 
 
+// srai_simd: arithmetic shift; counts past the lane width fill it with the
+// sign bit. AVX2 has no 8- or 64-bit form: bytes shift logically and have
+// the sign extended with (x ^ m) - m, and 64-bit lanes OR in the sign mask
+// shifted into the vacated bits.
+template <typename T>
+struct srai_simd_traits {
+    static_assert(std::is_integral<T>::value, "Unsupported scalar type.");
+
+    using scalar_type = T;
+    using simd_type = __m256i;
+    static constexpr size_t step = sizeof(__m256i) / sizeof(T);
+
+    static simd_type load(const scalar_type* ptr) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    }
+
+    static void store(scalar_type* ptr, simd_type val) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), val);
+    }
+
+    static simd_type op(simd_type a, int imm8) noexcept {
+        if constexpr (std::is_unsigned<T>::value)
+            return srli_simd_traits<T>::op(a, imm8);
+
+        constexpr unsigned bits = sizeof(T) * 8;
+        const unsigned n = static_cast<unsigned>(imm8) >= bits ? bits - 1 : static_cast<unsigned>(imm8);
+        const __m128i count = _mm_cvtsi32_si128(static_cast<int>(n));
+
+        if constexpr (sizeof(T) == 1) {
+            const __m256i m = _mm256_set1_epi8(static_cast<char>(0x80 >> n));
+            const __m256i shifted = _mm256_and_si256(_mm256_srl_epi16(a, count), _mm256_set1_epi8(static_cast<char>(0xff >> n)));
+            return _mm256_sub_epi8(_mm256_xor_si256(shifted, m), m);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_sra_epi16(a, count);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_sra_epi32(a, count);
+        } else {
+            const __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), a);
+            return _mm256_or_si256(_mm256_srl_epi64(a, count), _mm256_sll_epi64(sign, _mm_cvtsi32_si128(static_cast<int>(64 - n))));
+        }
+    }
+};
+
+
+namespace internal {
+    // shiftv_simd: per-lane counts taken from b; counts of the lane width
+    // or more clear the lane. 16-bit lanes shift as the two halves of each
+    // 32-bit lane, and bytes have no AVX2 form (they run scalar).
+    template <typename T, bool Left>
+    struct shiftv_simd {
+        using scalar_type = T;
+        using simd_type = __m256i;
+        static constexpr size_t step = sizeof(__m256i) / sizeof(T);
+
+        static simd_type load(const scalar_type* ptr) noexcept {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        }
+
+        static void store(scalar_type* ptr, simd_type val) noexcept {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), val);
+        }
+
+        static simd_type op(simd_type a, simd_type b) noexcept {
+            if constexpr (sizeof(T) == 2) {
+                const __m256i low = _mm256_set1_epi32(0x0000ffff);
+                const __m256i high = _mm256_set1_epi32(static_cast<int>(0xffff0000u));
+                const __m256i a_low = _mm256_and_si256(a, low), b_low = _mm256_and_si256(b, low);
+                const __m256i a_high = _mm256_and_si256(a, high), b_high = _mm256_srli_epi32(b, 16);
+
+                if constexpr (Left)
+                    return _mm256_or_si256(_mm256_and_si256(_mm256_sllv_epi32(a_low, b_low), low),
+                                           _mm256_sllv_epi32(a_high, b_high));
+                else
+                    return _mm256_or_si256(_mm256_srlv_epi32(a_low, b_low),
+                                           _mm256_and_si256(_mm256_srlv_epi32(a_high, b_high), high));
+            } else if constexpr (sizeof(T) == 4) {
+                return Left ? _mm256_sllv_epi32(a, b) : _mm256_srlv_epi32(a, b);
+            } else {
+                return Left ? _mm256_sllv_epi64(a, b) : _mm256_srlv_epi64(a, b);
+            }
+        }
+    };
+}
+
+
+// sllv_simd
+template <> struct sllv_simd_traits<int16_t> : internal::shiftv_simd<int16_t, true> {};
+template <> struct sllv_simd_traits<uint16_t> : internal::shiftv_simd<uint16_t, true> {};
+template <> struct sllv_simd_traits<int32_t> : internal::shiftv_simd<int32_t, true> {};
+template <> struct sllv_simd_traits<uint32_t> : internal::shiftv_simd<uint32_t, true> {};
+template <> struct sllv_simd_traits<int64_t> : internal::shiftv_simd<int64_t, true> {};
+template <> struct sllv_simd_traits<uint64_t> : internal::shiftv_simd<uint64_t, true> {};
+
+
+// srlv_simd
+template <> struct srlv_simd_traits<int16_t> : internal::shiftv_simd<int16_t, false> {};
+template <> struct srlv_simd_traits<uint16_t> : internal::shiftv_simd<uint16_t, false> {};
+template <> struct srlv_simd_traits<int32_t> : internal::shiftv_simd<int32_t, false> {};
+template <> struct srlv_simd_traits<uint32_t> : internal::shiftv_simd<uint32_t, false> {};
+template <> struct srlv_simd_traits<int64_t> : internal::shiftv_simd<int64_t, false> {};
+template <> struct srlv_simd_traits<uint64_t> : internal::shiftv_simd<uint64_t, false> {};
+
+
 // min_simd
 template <typename T>
 struct min_simd_traits;
@@ -1069,6 +1231,276 @@ struct rsqrt_simd_traits<float> {
 };
 
 
+// rsqrt_ulp1_simd: 1 / sqrt(a) in double, so the only error that matters
+// is the final rounding to float
+template <>
+struct rsqrt_ulp1_simd_traits<float> {
+    using scalar_type = float;
+    using simd_type = __m256;
+    static constexpr size_t step = 8;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_ps(ptr, val);
+    }
+
+    static simd_type op(simd_type a) noexcept {
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d lo = _mm256_div_pd(one, _mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a))));
+        const __m256d hi = _mm256_div_pd(one, _mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a, 1))));
+        return _mm256_set_m128(_mm256_cvtpd_ps(hi), _mm256_cvtpd_ps(lo));
+    }
+};
+
+
+// rsqrt_ulp4_simd: the 12-bit estimate refined by two Newton steps,
+// y += y * (1 - a * y * y) / 2, with the residual taken by FMA. The estimate
+// treats subnormals as 0, so they are scaled by 2^24 and the result by 2^12;
+// 0 and inf, where the step would give NaN, keep the estimate (inf and 0).
+template <>
+struct rsqrt_ulp4_simd_traits<float> {
+    using scalar_type = float;
+    using simd_type = __m256;
+    static constexpr size_t step = 8;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_ps(ptr, val);
+    }
+
+    static simd_type newton(simd_type a, simd_type y) noexcept {
+        const __m256 residual = _mm256_fnmadd_ps(_mm256_mul_ps(a, y), y, _mm256_set1_ps(1.0f));
+        return _mm256_fmadd_ps(_mm256_mul_ps(y, _mm256_set1_ps(0.5f)), residual, y);
+    }
+
+    static simd_type op(simd_type a) noexcept {
+        const __m256 subnormal = _mm256_and_ps(_mm256_cmp_ps(a, _mm256_set1_ps(1.17549435e-38f), _CMP_LT_OQ),
+                                               _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ));
+        const __m256 x = _mm256_blendv_ps(a, _mm256_mul_ps(a, _mm256_set1_ps(16777216.0f)), subnormal);
+
+        const __m256 estimate = _mm256_rsqrt_ps(x);
+        __m256 refined = newton(x, newton(x, estimate));
+        refined = _mm256_blendv_ps(refined, _mm256_mul_ps(refined, _mm256_set1_ps(4096.0f)), subnormal);
+
+        const __m256 edge = _mm256_or_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_EQ_OQ),
+                                         _mm256_cmp_ps(a, _mm256_set1_ps(INFINITY), _CMP_EQ_OQ));
+        return _mm256_blendv_ps(refined, estimate, edge);
+    }
+};
+
+
+// exp_ulp4_simd: exp(a) = 2^k * exp(r), k = round(a / ln 2), with r reduced
+// by a two-part ln 2 and exp(r) from its Taylor series. 2^k is applied as
+// two factors so both stay normal, which keeps gradual underflow and lets
+// overflow reach inf on its own.
+template <>
+struct exp_ulp4_simd_traits<float> {
+    using scalar_type = float;
+    using simd_type = __m256;
+    static constexpr size_t step = 8;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_ps(ptr, val);
+    }
+
+    static __m256 pow2(__m256i k) noexcept {
+        return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(k, _mm256_set1_epi32(127)), 23));
+    }
+
+    static simd_type op(simd_type a) noexcept {
+        const __m256 x = _mm256_min_ps(_mm256_max_ps(a, _mm256_set1_ps(-104.0f)), _mm256_set1_ps(89.0f));
+        const __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                         _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+        __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(0.693359375f), x);
+        r = _mm256_fnmadd_ps(k, _mm256_set1_ps(-2.12194440e-4f), r);
+
+        __m256 p = _mm256_set1_ps(1.0f / 5040.0f);
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f / 720.0f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f / 120.0f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f / 24.0f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f / 6.0f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(0.5f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.0f));
+
+        const __m256i ki = _mm256_cvtps_epi32(k);
+        const __m256i k1 = _mm256_srai_epi32(ki, 1);
+        const __m256 result = _mm256_mul_ps(_mm256_mul_ps(p, pow2(k1)), pow2(_mm256_sub_epi32(ki, k1)));
+
+        return _mm256_blendv_ps(result, a, _mm256_cmp_ps(a, a, _CMP_UNORD_Q));
+    }
+};
+
+template <>
+struct exp_ulp4_simd_traits<double> {
+    using scalar_type = double;
+    using simd_type = __m256d;
+    static constexpr size_t step = 4;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_pd(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_pd(ptr, val);
+    }
+
+    // 2^k for integral k in the normal range: k + 1023 lands in the low
+    // mantissa bits of 2^52 + k + 1023 and is shifted into the exponent
+    static __m256d pow2(__m256d k) noexcept {
+        const __m256d biased = _mm256_add_pd(k, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+        return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(biased), 52));
+    }
+
+    static simd_type op(simd_type a) noexcept {
+        const __m256d x = _mm256_min_pd(_mm256_max_pd(a, _mm256_set1_pd(-746.0)), _mm256_set1_pd(710.0));
+        const __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634)),
+                                          _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+        __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(6.93147180369123816490e-01), x);
+        r = _mm256_fnmadd_pd(k, _mm256_set1_pd(1.90821492927058770002e-10), r);
+
+        static constexpr double factorial[] = {
+            1.0, 1.0, 2.0, 6.0, 24.0, 120.0, 720.0, 5040.0, 40320.0, 362880.0,
+            3628800.0, 39916800.0, 479001600.0, 6227020800.0
+        };
+
+        __m256d p = _mm256_set1_pd(1.0 / factorial[13]);
+        for (int i = 12; i >= 0; --i)
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / factorial[i]));
+
+        const __m256d k1 = _mm256_floor_pd(_mm256_mul_pd(k, _mm256_set1_pd(0.5)));
+        const __m256d result = _mm256_mul_pd(_mm256_mul_pd(p, pow2(k1)), pow2(_mm256_sub_pd(k, k1)));
+
+        return _mm256_blendv_pd(result, a, _mm256_cmp_pd(a, a, _CMP_UNORD_Q));
+    }
+};
+
+
+// log_ulp4_simd: a = m * 2^e with m in [sqrt(1/2), sqrt(2)), and log(m) from
+// the fdlibm series in s = f / (2 + f), f = m - 1. Subnormal inputs are
+// scaled into the normal range first; 0, negatives, inf and NaN are patched
+// in at the end.
+template <>
+struct log_ulp4_simd_traits<float> {
+    using scalar_type = float;
+    using simd_type = __m256;
+    static constexpr size_t step = 8;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_ps(ptr, val);
+    }
+
+    static simd_type op(simd_type a) noexcept {
+        const __m256 subnormal = _mm256_cmp_ps(a, _mm256_set1_ps(1.17549435e-38f), _CMP_LT_OQ);
+        const __m256 x = _mm256_blendv_ps(a, _mm256_mul_ps(a, _mm256_set1_ps(8388608.0f)), subnormal);
+
+        const __m256i bits = _mm256_castps_si256(x);
+        __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+        e = _mm256_sub_ps(e, _mm256_and_ps(subnormal, _mm256_set1_ps(23.0f)));
+
+        __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                       _mm256_set1_epi32(0x3f800000)));
+        const __m256 upper = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+        m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), upper);
+        e = _mm256_add_ps(e, _mm256_and_ps(upper, _mm256_set1_ps(1.0f)));
+
+        const __m256 f = _mm256_sub_ps(m, _mm256_set1_ps(1.0f));
+        const __m256 s = _mm256_div_ps(f, _mm256_add_ps(f, _mm256_set1_ps(2.0f)));
+        const __m256 z = _mm256_mul_ps(s, s);
+
+        __m256 R = _mm256_set1_ps(1.4798198640e-01f);
+        R = _mm256_fmadd_ps(R, z, _mm256_set1_ps(1.5313838422e-01f));
+        R = _mm256_fmadd_ps(R, z, _mm256_set1_ps(1.8183572590e-01f));
+        R = _mm256_fmadd_ps(R, z, _mm256_set1_ps(2.2222198546e-01f));
+        R = _mm256_fmadd_ps(R, z, _mm256_set1_ps(2.8571429849e-01f));
+        R = _mm256_fmadd_ps(R, z, _mm256_set1_ps(4.0000000596e-01f));
+        R = _mm256_fmadd_ps(R, z, _mm256_set1_ps(6.6666668653e-01f));
+        R = _mm256_mul_ps(R, z);
+
+        // e * ln2_hi - ((hfsq - (s * (hfsq + R) + e * ln2_lo)) - f)
+        const __m256 hfsq = _mm256_mul_ps(_mm256_mul_ps(f, f), _mm256_set1_ps(0.5f));
+        const __m256 tail = _mm256_fmadd_ps(s, _mm256_add_ps(hfsq, R), _mm256_mul_ps(e, _mm256_set1_ps(9.0580006145e-06f)));
+        __m256 result = _mm256_fmsub_ps(e, _mm256_set1_ps(6.9313812256e-01f), _mm256_sub_ps(_mm256_sub_ps(hfsq, tail), f));
+
+        result = _mm256_blendv_ps(result, _mm256_set1_ps(-INFINITY), _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_EQ_OQ));
+        result = _mm256_blendv_ps(result, _mm256_set1_ps(NAN), _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_LT_OQ));
+        result = _mm256_blendv_ps(result, a, _mm256_cmp_ps(a, _mm256_set1_ps(INFINITY), _CMP_EQ_OQ));
+        return _mm256_blendv_ps(result, a, _mm256_cmp_ps(a, a, _CMP_UNORD_Q));
+    }
+};
+
+template <>
+struct log_ulp4_simd_traits<double> {
+    using scalar_type = double;
+    using simd_type = __m256d;
+    static constexpr size_t step = 4;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_pd(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_pd(ptr, val);
+    }
+
+    static simd_type op(simd_type a) noexcept {
+        const __m256d subnormal = _mm256_cmp_pd(a, _mm256_set1_pd(2.2250738585072014e-308), _CMP_LT_OQ);
+        const __m256d x = _mm256_blendv_pd(a, _mm256_mul_pd(a, _mm256_set1_pd(18014398509481984.0)), subnormal);
+
+        // the biased exponent becomes a double through the mantissa of 2^52
+        const __m256i bits = _mm256_castpd_si256(x);
+        const __m256d two52 = _mm256_set1_pd(4503599627370496.0);
+        __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(two52))),
+                                  _mm256_set1_pd(4503599627370496.0 + 1023.0));
+        e = _mm256_sub_pd(e, _mm256_and_pd(subnormal, _mm256_set1_pd(54.0)));
+
+        __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL)),
+                                                        _mm256_set1_epi64x(0x3ff0000000000000LL)));
+        const __m256d upper = _mm256_cmp_pd(m, _mm256_set1_pd(1.4142135623730951), _CMP_GT_OQ);
+        m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), upper);
+        e = _mm256_add_pd(e, _mm256_and_pd(upper, _mm256_set1_pd(1.0)));
+
+        const __m256d f = _mm256_sub_pd(m, _mm256_set1_pd(1.0));
+        const __m256d s = _mm256_div_pd(f, _mm256_add_pd(f, _mm256_set1_pd(2.0)));
+        const __m256d z = _mm256_mul_pd(s, s);
+
+        __m256d R = _mm256_set1_pd(1.479819860511658591e-01);
+        R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(1.531383769920937332e-01));
+        R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(1.818357216161805012e-01));
+        R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(2.222219843214978396e-01));
+        R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(2.857142874366239149e-01));
+        R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(3.999999999940941908e-01));
+        R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(6.666666666666735130e-01));
+        R = _mm256_mul_pd(R, z);
+
+        const __m256d hfsq = _mm256_mul_pd(_mm256_mul_pd(f, f), _mm256_set1_pd(0.5));
+        const __m256d tail = _mm256_fmadd_pd(s, _mm256_add_pd(hfsq, R), _mm256_mul_pd(e, _mm256_set1_pd(1.90821492927058770002e-10)));
+        __m256d result = _mm256_fmsub_pd(e, _mm256_set1_pd(6.93147180369123816490e-01), _mm256_sub_pd(_mm256_sub_pd(hfsq, tail), f));
+
+        result = _mm256_blendv_pd(result, _mm256_set1_pd(-INFINITY), _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_EQ_OQ));
+        result = _mm256_blendv_pd(result, _mm256_set1_pd(NAN), _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_LT_OQ));
+        result = _mm256_blendv_pd(result, a, _mm256_cmp_pd(a, _mm256_set1_pd(INFINITY), _CMP_EQ_OQ));
+        return _mm256_blendv_pd(result, a, _mm256_cmp_pd(a, a, _CMP_UNORD_Q));
+    }
+};
+
+
 // round_simd
 template <typename T>
 struct round_simd_traits;
@@ -1087,8 +1519,15 @@ struct round_simd_traits<float> {
         _mm256_storeu_ps(ptr, val);
     }
 
+    // half-way cases round away from zero, as std::round does
     static simd_type op(simd_type a) noexcept {
-        return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT);
+        const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+        const __m256 sign = _mm256_and_ps(a, sign_bit);
+        const __m256 truncated = _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const __m256 fraction = _mm256_andnot_ps(sign_bit, _mm256_sub_ps(a, truncated));
+        const __m256 away = _mm256_and_ps(_mm256_cmp_ps(fraction, _mm256_set1_ps(0.5f), _CMP_GE_OQ),
+                                          _mm256_or_ps(sign, _mm256_set1_ps(1.0f)));
+        return _mm256_or_ps(_mm256_add_ps(truncated, away), sign);
     }
 };
 
@@ -1107,7 +1546,13 @@ struct round_simd_traits<double> {
     }
 
     static simd_type op(simd_type a) noexcept {
-        return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT);
+        const __m256d sign_bit = _mm256_set1_pd(-0.0);
+        const __m256d sign = _mm256_and_pd(a, sign_bit);
+        const __m256d truncated = _mm256_round_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const __m256d fraction = _mm256_andnot_pd(sign_bit, _mm256_sub_pd(a, truncated));
+        const __m256d away = _mm256_and_pd(_mm256_cmp_pd(fraction, _mm256_set1_pd(0.5), _CMP_GE_OQ),
+                                           _mm256_or_pd(sign, _mm256_set1_pd(1.0)));
+        return _mm256_or_pd(_mm256_add_pd(truncated, away), sign);
     }
 };
 
@@ -1299,6 +1744,216 @@ struct abs_simd_traits<double> {
     }
 };
 
+// add_simd
+template <typename T>
+struct add_simd_traits {
+    static_assert(std::is_integral<T>::value, "Unsupported scalar type.");
+
+    using scalar_type = T;
+    using simd_type = __m256i;
+    static constexpr size_t step = sizeof(__m256i) / sizeof(T);
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (sizeof(T) == 1)
+            return _mm256_add_epi8(a, b);
+        else if constexpr (sizeof(T) == 2)
+            return _mm256_add_epi16(a, b);
+        else if constexpr (sizeof(T) == 4)
+            return _mm256_add_epi32(a, b);
+        else
+            return _mm256_add_epi64(a, b);
+    }
+};
+
+template <>
+struct add_simd_traits<float> {
+    using scalar_type = float;
+    using simd_type = __m256;
+    static constexpr size_t step = 8;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_ps(ptr, val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm256_add_ps(a, b);
+    }
+};
+
+template <>
+struct add_simd_traits<double> {
+    using scalar_type = double;
+    using simd_type = __m256d;
+    static constexpr size_t step = 4;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_pd(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_pd(ptr, val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm256_add_pd(a, b);
+    }
+};
+
+// sub_simd
+template <typename T>
+struct sub_simd_traits {
+    static_assert(std::is_integral<T>::value, "Unsupported scalar type.");
+
+    using scalar_type = T;
+    using simd_type = __m256i;
+    static constexpr size_t step = sizeof(__m256i) / sizeof(T);
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (sizeof(T) == 1)
+            return _mm256_sub_epi8(a, b);
+        else if constexpr (sizeof(T) == 2)
+            return _mm256_sub_epi16(a, b);
+        else if constexpr (sizeof(T) == 4)
+            return _mm256_sub_epi32(a, b);
+        else
+            return _mm256_sub_epi64(a, b);
+    }
+};
+
+template <>
+struct sub_simd_traits<float> {
+    using scalar_type = float;
+    using simd_type = __m256;
+    static constexpr size_t step = 8;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_ps(ptr, val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm256_sub_ps(a, b);
+    }
+};
+
+template <>
+struct sub_simd_traits<double> {
+    using scalar_type = double;
+    using simd_type = __m256d;
+    static constexpr size_t step = 4;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_pd(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_pd(ptr, val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm256_sub_pd(a, b);
+    }
+};
+
+// mul_simd: low half of the product, as integer * wraps. Bytes multiply as
+// 16-bit lanes, even and odd bytes apart; 64-bit lanes are put together
+// from 32 x 32 -> 64 partial products
+template <typename T>
+struct mul_simd_traits {
+    static_assert(std::is_integral<T>::value, "Unsupported scalar type.");
+
+    using scalar_type = T;
+    using simd_type = __m256i;
+    static constexpr size_t step = sizeof(__m256i) / sizeof(T);
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (sizeof(T) == 1) {
+            const __m256i low = _mm256_set1_epi16(0x00ff);
+            const __m256i even = _mm256_and_si256(_mm256_mullo_epi16(a, b), low);
+            const __m256i odd = _mm256_mullo_epi16(_mm256_srli_epi16(a, 8), _mm256_andnot_si256(low, b));
+            return _mm256_or_si256(even, odd);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_mullo_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_mullo_epi32(a, b);
+        } else {
+            const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                                   _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+            return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+        }
+    }
+};
+
+template <>
+struct mul_simd_traits<float> {
+    using scalar_type = float;
+    using simd_type = __m256;
+    static constexpr size_t step = 8;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_ps(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_ps(ptr, val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm256_mul_ps(a, b);
+    }
+};
+
+template <>
+struct mul_simd_traits<double> {
+    using scalar_type = double;
+    using simd_type = __m256d;
+    static constexpr size_t step = 4;
+
+    static simd_type load(const scalar_type *ptr) noexcept {
+        return _mm256_loadu_pd(ptr);
+    }
+
+    static void store(scalar_type *ptr, simd_type val) noexcept {
+        _mm256_storeu_pd(ptr, val);
+    }
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm256_mul_pd(a, b);
+    }
+};
+
+SIMD_TARGET_END
 #endif
 
 
@@ -0,0 +1,762 @@
+#ifndef SIMD_TRAITS_AVX512_HPP
+#define SIMD_TRAITS_AVX512_HPP
+
+#include "simd_traits.cpp"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// 512-bit counterparts of the traits in simd_traits.cpp. Besides load, store
+// and op they provide masked load/store and tail_mask(n), so the AVX-512
+// drivers finish a row with one masked block instead of a scalar loop.
+template <typename T, typename = void> struct and_avx512_traits;
+template <typename T, typename = void> struct or_avx512_traits;
+template <typename T, typename = void> struct xor_avx512_traits;
+template <typename T, typename = void> struct andnot_avx512_traits;
+template <typename T, typename = void> struct slli_avx512_traits;
+template <typename T, typename = void> struct srli_avx512_traits;
+template <typename T, typename = void> struct srai_avx512_traits;
+template <typename T, typename = void> struct sllv_avx512_traits;
+template <typename T, typename = void> struct srlv_avx512_traits;
+template <typename T, typename = void> struct min_avx512_traits;
+template <typename T, typename = void> struct max_avx512_traits;
+template <typename T, typename = void> struct sqrt_avx512_traits;
+template <typename T, typename = void> struct rsqrt_avx512_traits;
+template <typename T, typename = void> struct rsqrt_ulp1_avx512_traits;
+template <typename T, typename = void> struct rsqrt_ulp4_avx512_traits;
+template <typename T, typename = void> struct round_avx512_traits;
+template <typename T, typename = void> struct ceil_avx512_traits;
+template <typename T, typename = void> struct floor_avx512_traits;
+template <typename T, typename = void> struct abs_avx512_traits;
+template <typename T, typename = void> struct add_avx512_traits;
+template <typename T, typename = void> struct sub_avx512_traits;
+template <typename T, typename = void> struct mul_avx512_traits;
+
+
+namespace internal {
+    // families without a 512-bit counterpart map to this incomplete type, so
+    // has_simd_traits rejects them
+    template <typename T>
+    struct no_avx512_traits;
+
+    // avx512_of: the AVX-512 trait family standing in for an AVX2 one
+    template <template <typename> class Traits>
+    struct avx512_of {
+        template <typename T>
+        using traits = no_avx512_traits<T>;
+    };
+
+    template <template <typename> class Traits, typename T>
+    using avx512_traits_t = typename avx512_of<Traits>::template traits<T>;
+
+    template <typename T>
+    using if_integral = std::enable_if_t<std::is_integral<T>::value>;
+}
+
+#define SIMD_AVX512_COUNTERPART(name) \
+namespace internal { \
+    template <> \
+    struct avx512_of<name##_simd_traits> { \
+        template <typename T> \
+        using traits = name##_avx512_traits<T>; \
+    }; \
+}
+
+SIMD_AVX512_COUNTERPART(and)
+SIMD_AVX512_COUNTERPART(or)
+SIMD_AVX512_COUNTERPART(xor)
+SIMD_AVX512_COUNTERPART(andnot)
+SIMD_AVX512_COUNTERPART(slli)
+SIMD_AVX512_COUNTERPART(srli)
+SIMD_AVX512_COUNTERPART(srai)
+SIMD_AVX512_COUNTERPART(sllv)
+SIMD_AVX512_COUNTERPART(srlv)
+SIMD_AVX512_COUNTERPART(min)
+SIMD_AVX512_COUNTERPART(max)
+SIMD_AVX512_COUNTERPART(sqrt)
+SIMD_AVX512_COUNTERPART(rsqrt)
+SIMD_AVX512_COUNTERPART(rsqrt_ulp1)
+SIMD_AVX512_COUNTERPART(rsqrt_ulp4)
+SIMD_AVX512_COUNTERPART(round)
+SIMD_AVX512_COUNTERPART(ceil)
+SIMD_AVX512_COUNTERPART(floor)
+SIMD_AVX512_COUNTERPART(abs)
+SIMD_AVX512_COUNTERPART(add)
+SIMD_AVX512_COUNTERPART(sub)
+SIMD_AVX512_COUNTERPART(mul)
+
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX512_BEGIN
+
+namespace internal {
+    // Ops use the zero-masking intrinsics with every lane set. GCC's unmasked
+    // forms merge into an undefined register, which -Wall reports as used
+    // uninitialised once they are inlined into the drivers; all-ones masks
+    // compile to the same unmasked instructions.
+    constexpr __mmask16 all_lanes16 = 0xFFFF;
+    constexpr __mmask8 all_lanes8 = 0xFF;
+
+    // avx512_io: load/store shared by every 512-bit trait of one lane type
+    template <typename T>
+    struct avx512_io {
+        static_assert(std::is_integral<T>::value, "Unsupported scalar type.");
+
+        using scalar_type = T;
+        using simd_type = __m512i;
+        using mask_type = __mmask64;
+        static constexpr size_t step = sizeof(__m512i) / sizeof(T);
+
+        static simd_type load(const scalar_type *ptr) noexcept {
+            return _mm512_loadu_si512(ptr);
+        }
+
+        static void store(scalar_type *ptr, simd_type val) noexcept {
+            _mm512_storeu_si512(ptr, val);
+        }
+
+        // the first n lanes, n < step
+        static mask_type tail_mask(size_t n) noexcept {
+            return n >= 64 ? ~static_cast<mask_type>(0) : (static_cast<mask_type>(1) << n) - 1;
+        }
+
+        static simd_type load(const scalar_type *ptr, mask_type mask) noexcept {
+            if constexpr (sizeof(T) == 1)
+                return _mm512_maskz_loadu_epi8(mask, ptr);
+            else if constexpr (sizeof(T) == 2)
+                return _mm512_maskz_loadu_epi16(static_cast<__mmask32>(mask), ptr);
+            else if constexpr (sizeof(T) == 4)
+                return _mm512_maskz_loadu_epi32(static_cast<__mmask16>(mask), ptr);
+            else
+                return _mm512_maskz_loadu_epi64(static_cast<__mmask8>(mask), ptr);
+        }
+
+        static void store(scalar_type *ptr, simd_type val, mask_type mask) noexcept {
+            if constexpr (sizeof(T) == 1)
+                _mm512_mask_storeu_epi8(ptr, mask, val);
+            else if constexpr (sizeof(T) == 2)
+                _mm512_mask_storeu_epi16(ptr, static_cast<__mmask32>(mask), val);
+            else if constexpr (sizeof(T) == 4)
+                _mm512_mask_storeu_epi32(ptr, static_cast<__mmask16>(mask), val);
+            else
+                _mm512_mask_storeu_epi64(ptr, static_cast<__mmask8>(mask), val);
+        }
+    };
+
+    template <>
+    struct avx512_io<float> {
+        using scalar_type = float;
+        using simd_type = __m512;
+        using mask_type = __mmask16;
+        static constexpr size_t step = 16;
+
+        static simd_type load(const scalar_type *ptr) noexcept {
+            return _mm512_loadu_ps(ptr);
+        }
+
+        static void store(scalar_type *ptr, simd_type val) noexcept {
+            _mm512_storeu_ps(ptr, val);
+        }
+
+        static mask_type tail_mask(size_t n) noexcept {
+            return static_cast<mask_type>((1u << n) - 1);
+        }
+
+        static simd_type load(const scalar_type *ptr, mask_type mask) noexcept {
+            return _mm512_maskz_loadu_ps(mask, ptr);
+        }
+
+        static void store(scalar_type *ptr, simd_type val, mask_type mask) noexcept {
+            _mm512_mask_storeu_ps(ptr, mask, val);
+        }
+    };
+
+    template <>
+    struct avx512_io<double> {
+        using scalar_type = double;
+        using simd_type = __m512d;
+        using mask_type = __mmask8;
+        static constexpr size_t step = 8;
+
+        static simd_type load(const scalar_type *ptr) noexcept {
+            return _mm512_loadu_pd(ptr);
+        }
+
+        static void store(scalar_type *ptr, simd_type val) noexcept {
+            _mm512_storeu_pd(ptr, val);
+        }
+
+        static mask_type tail_mask(size_t n) noexcept {
+            return static_cast<mask_type>((1u << n) - 1);
+        }
+
+        static simd_type load(const scalar_type *ptr, mask_type mask) noexcept {
+            return _mm512_maskz_loadu_pd(mask, ptr);
+        }
+
+        static void store(scalar_type *ptr, simd_type val, mask_type mask) noexcept {
+            _mm512_mask_storeu_pd(ptr, mask, val);
+        }
+    };
+}
+
+
+// and_avx512
+template <typename T>
+struct and_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_and_si512(a, b);
+    }
+};
+
+template <>
+struct and_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_and_ps(a, b);
+    }
+};
+
+template <>
+struct and_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_and_pd(a, b);
+    }
+};
+
+
+// or_avx512
+template <typename T>
+struct or_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_or_si512(a, b);
+    }
+};
+
+template <>
+struct or_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_or_ps(a, b);
+    }
+};
+
+template <>
+struct or_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_or_pd(a, b);
+    }
+};
+
+
+// xor_avx512
+template <typename T>
+struct xor_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_xor_si512(a, b);
+    }
+};
+
+template <>
+struct xor_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_xor_ps(a, b);
+    }
+};
+
+template <>
+struct xor_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_xor_pd(a, b);
+    }
+};
+
+
+// andnot_avx512
+template <typename T>
+struct andnot_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_maskz_andnot_epi64(internal::all_lanes8, a, b);
+    }
+};
+
+template <>
+struct andnot_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_andnot_ps(a, b);
+    }
+};
+
+template <>
+struct andnot_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_andnot_pd(a, b);
+    }
+};
+
+
+// slli_avx512: logical shifts within each lane; bytes shift as 16-bit lanes
+// and drop the bits that crossed into the neighbouring byte
+template <typename T>
+struct slli_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, int imm8) noexcept {
+        const __m128i count = _mm_cvtsi32_si128(imm8);
+
+        if constexpr (sizeof(T) == 1) {
+            const __m512i keep = _mm512_set1_epi8(static_cast<char>(static_cast<unsigned>(imm8) >= 8 ? 0 : 0xff << imm8));
+            return _mm512_and_si512(_mm512_sll_epi16(a, count), keep);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm512_sll_epi16(a, count);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_maskz_sll_epi32(internal::all_lanes16, a, count);
+        } else {
+            return _mm512_maskz_sll_epi64(internal::all_lanes8, a, count);
+        }
+    }
+};
+
+
+// srli_avx512
+template <typename T>
+struct srli_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, int imm8) noexcept {
+        const __m128i count = _mm_cvtsi32_si128(imm8);
+
+        if constexpr (sizeof(T) == 1) {
+            const __m512i keep = _mm512_set1_epi8(static_cast<char>(static_cast<unsigned>(imm8) >= 8 ? 0 : 0xff >> imm8));
+            return _mm512_and_si512(_mm512_srl_epi16(a, count), keep);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm512_srl_epi16(a, count);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_maskz_srl_epi32(internal::all_lanes16, a, count);
+        } else {
+            return _mm512_maskz_srl_epi64(internal::all_lanes8, a, count);
+        }
+    }
+};
+
+
+// srai_avx512: arithmetic shift, with 64-bit lanes native here; bytes shift
+// logically and have the sign extended with (x ^ m) - m
+template <typename T>
+struct srai_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, int imm8) noexcept {
+        if constexpr (std::is_unsigned<T>::value)
+            return srli_avx512_traits<T>::op(a, imm8);
+
+        constexpr unsigned bits = sizeof(T) * 8;
+        const unsigned n = static_cast<unsigned>(imm8) >= bits ? bits - 1 : static_cast<unsigned>(imm8);
+        const __m128i count = _mm_cvtsi32_si128(static_cast<int>(n));
+
+        if constexpr (sizeof(T) == 1) {
+            const __m512i m = _mm512_set1_epi8(static_cast<char>(0x80 >> n));
+            const __m512i shifted = _mm512_and_si512(_mm512_srl_epi16(a, count), _mm512_set1_epi8(static_cast<char>(0xff >> n)));
+            return _mm512_sub_epi8(_mm512_xor_si512(shifted, m), m);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm512_sra_epi16(a, count);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_maskz_sra_epi32(internal::all_lanes16, a, count);
+        } else {
+            return _mm512_maskz_sra_epi64(internal::all_lanes8, a, count);
+        }
+    }
+};
+
+
+namespace internal {
+    // shiftv_avx512: per-lane counts taken from b; bytes shift as the two
+    // halves of each 16-bit lane
+    template <typename T, bool Left>
+    struct shiftv_avx512 : avx512_io<T> {
+        using simd_type = __m512i;
+
+        static simd_type op(simd_type a, simd_type b) noexcept {
+            if constexpr (sizeof(T) == 1) {
+                const __m512i low = _mm512_set1_epi16(0x00ff);
+                const __m512i high = _mm512_set1_epi16(static_cast<short>(0xff00));
+                const __m512i a_low = _mm512_and_si512(a, low), b_low = _mm512_and_si512(b, low);
+                const __m512i a_high = _mm512_and_si512(a, high), b_high = _mm512_srli_epi16(b, 8);
+
+                if constexpr (Left)
+                    return _mm512_or_si512(_mm512_and_si512(_mm512_sllv_epi16(a_low, b_low), low),
+                                           _mm512_sllv_epi16(a_high, b_high));
+                else
+                    return _mm512_or_si512(_mm512_srlv_epi16(a_low, b_low),
+                                           _mm512_and_si512(_mm512_srlv_epi16(a_high, b_high), high));
+            } else if constexpr (sizeof(T) == 2) {
+                return Left ? _mm512_sllv_epi16(a, b) : _mm512_srlv_epi16(a, b);
+            } else if constexpr (sizeof(T) == 4) {
+                return Left ? _mm512_maskz_sllv_epi32(internal::all_lanes16, a, b) : _mm512_maskz_srlv_epi32(internal::all_lanes16, a, b);
+            } else {
+                return Left ? _mm512_maskz_sllv_epi64(internal::all_lanes8, a, b) : _mm512_maskz_srlv_epi64(internal::all_lanes8, a, b);
+            }
+        }
+    };
+}
+
+
+// sllv_avx512
+template <typename T>
+struct sllv_avx512_traits<T, internal::if_integral<T>> : internal::shiftv_avx512<T, true> {};
+
+
+// srlv_avx512
+template <typename T>
+struct srlv_avx512_traits<T, internal::if_integral<T>> : internal::shiftv_avx512<T, false> {};
+
+
+// min_avx512
+template <typename T>
+struct min_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (std::is_signed<T>::value) {
+            if constexpr (sizeof(T) == 1)
+                return _mm512_min_epi8(a, b);
+            else if constexpr (sizeof(T) == 2)
+                return _mm512_min_epi16(a, b);
+            else if constexpr (sizeof(T) == 4)
+                return _mm512_maskz_min_epi32(internal::all_lanes16, a, b);
+            else
+                return _mm512_maskz_min_epi64(internal::all_lanes8, a, b);
+        } else {
+            if constexpr (sizeof(T) == 1)
+                return _mm512_min_epu8(a, b);
+            else if constexpr (sizeof(T) == 2)
+                return _mm512_min_epu16(a, b);
+            else if constexpr (sizeof(T) == 4)
+                return _mm512_maskz_min_epu32(internal::all_lanes16, a, b);
+            else
+                return _mm512_maskz_min_epu64(internal::all_lanes8, a, b);
+        }
+    }
+};
+
+template <>
+struct min_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_maskz_min_ps(internal::all_lanes16, a, b);
+    }
+};
+
+template <>
+struct min_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_maskz_min_pd(internal::all_lanes8, a, b);
+    }
+};
+
+
+// max_avx512
+template <typename T>
+struct max_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (std::is_signed<T>::value) {
+            if constexpr (sizeof(T) == 1)
+                return _mm512_max_epi8(a, b);
+            else if constexpr (sizeof(T) == 2)
+                return _mm512_max_epi16(a, b);
+            else if constexpr (sizeof(T) == 4)
+                return _mm512_maskz_max_epi32(internal::all_lanes16, a, b);
+            else
+                return _mm512_maskz_max_epi64(internal::all_lanes8, a, b);
+        } else {
+            if constexpr (sizeof(T) == 1)
+                return _mm512_max_epu8(a, b);
+            else if constexpr (sizeof(T) == 2)
+                return _mm512_max_epu16(a, b);
+            else if constexpr (sizeof(T) == 4)
+                return _mm512_maskz_max_epu32(internal::all_lanes16, a, b);
+            else
+                return _mm512_maskz_max_epu64(internal::all_lanes8, a, b);
+        }
+    }
+};
+
+template <>
+struct max_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_maskz_max_ps(internal::all_lanes16, a, b);
+    }
+};
+
+template <>
+struct max_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_maskz_max_pd(internal::all_lanes8, a, b);
+    }
+};
+
+
+// sqrt_avx512
+template <>
+struct sqrt_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_maskz_sqrt_ps(internal::all_lanes16, a);
+    }
+};
+
+template <>
+struct sqrt_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_maskz_sqrt_pd(internal::all_lanes8, a);
+    }
+};
+
+
+// rsqrt_avx512
+template <>
+struct rsqrt_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_maskz_rsqrt14_ps(internal::all_lanes16, a);
+    }
+};
+
+
+// rsqrt_ulp1_avx512: computed in double, as rsqrt_ulp1_simd
+template <>
+struct rsqrt_ulp1_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __m512d wide_lo = _mm512_maskz_cvtps_pd(internal::all_lanes8, _mm512_maskz_extractf32x8_ps(internal::all_lanes8, a, 0));
+        const __m512d wide_hi = _mm512_maskz_cvtps_pd(internal::all_lanes8, _mm512_maskz_extractf32x8_ps(internal::all_lanes8, a, 1));
+        const __m512d lo = _mm512_div_pd(one, _mm512_maskz_sqrt_pd(internal::all_lanes8, wide_lo));
+        const __m512d hi = _mm512_div_pd(one, _mm512_maskz_sqrt_pd(internal::all_lanes8, wide_hi));
+        return _mm512_insertf32x8(_mm512_castps256_ps512(_mm512_maskz_cvtpd_ps(internal::all_lanes8, lo)),
+                                  _mm512_maskz_cvtpd_ps(internal::all_lanes8, hi), 1);
+    }
+};
+
+
+// rsqrt_ulp4_avx512: the 14-bit estimate needs a single Newton step;
+// subnormals are scaled as in rsqrt_ulp4_simd, 0 and inf keep the estimate
+template <>
+struct rsqrt_ulp4_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        const __mmask16 subnormal = _mm512_cmp_ps_mask(a, _mm512_set1_ps(1.17549435e-38f), _CMP_LT_OQ)
+                                  & _mm512_cmp_ps_mask(a, _mm512_setzero_ps(), _CMP_GT_OQ);
+        const __m512 x = _mm512_mask_mul_ps(a, subnormal, a, _mm512_set1_ps(16777216.0f));
+
+        const __m512 y = _mm512_maskz_rsqrt14_ps(internal::all_lanes16, x);
+        const __m512 residual = _mm512_fnmadd_ps(_mm512_mul_ps(x, y), y, _mm512_set1_ps(1.0f));
+        __m512 refined = _mm512_fmadd_ps(_mm512_mul_ps(y, _mm512_set1_ps(0.5f)), residual, y);
+        refined = _mm512_mask_mul_ps(refined, subnormal, refined, _mm512_set1_ps(4096.0f));
+        const __mmask16 edge = _mm512_cmp_ps_mask(a, _mm512_setzero_ps(), _CMP_EQ_OQ)
+                             | _mm512_cmp_ps_mask(a, _mm512_set1_ps(INFINITY), _CMP_EQ_OQ);
+        return _mm512_mask_blend_ps(edge, refined, y);
+    }
+};
+
+
+// round_avx512: half-way cases round away from zero, as std::round does
+template <>
+struct round_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        const __m512 sign = _mm512_and_ps(a, _mm512_set1_ps(-0.0f));
+        const __m512 truncated = _mm512_maskz_roundscale_ps(internal::all_lanes16, a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const __mmask16 away = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_sub_ps(a, truncated)),
+                                                  _mm512_set1_ps(0.5f), _CMP_GE_OQ);
+        const __m512 rounded = _mm512_mask_add_ps(truncated, away, truncated,
+                                                  _mm512_or_ps(sign, _mm512_set1_ps(1.0f)));
+        return _mm512_or_ps(rounded, sign);
+    }
+};
+
+template <>
+struct round_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a) noexcept {
+        const __m512d sign = _mm512_and_pd(a, _mm512_set1_pd(-0.0));
+        const __m512d truncated = _mm512_maskz_roundscale_pd(internal::all_lanes8, a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const __mmask8 away = _mm512_cmp_pd_mask(_mm512_abs_pd(_mm512_sub_pd(a, truncated)),
+                                                 _mm512_set1_pd(0.5), _CMP_GE_OQ);
+        const __m512d rounded = _mm512_mask_add_pd(truncated, away, truncated,
+                                                   _mm512_or_pd(sign, _mm512_set1_pd(1.0)));
+        return _mm512_or_pd(rounded, sign);
+    }
+};
+
+
+// ceil_avx512
+template <>
+struct ceil_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_maskz_roundscale_ps(internal::all_lanes16, a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+    }
+};
+
+template <>
+struct ceil_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_maskz_roundscale_pd(internal::all_lanes8, a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+    }
+};
+
+
+// floor_avx512
+template <>
+struct floor_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_maskz_roundscale_ps(internal::all_lanes16, a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+};
+
+template <>
+struct floor_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_maskz_roundscale_pd(internal::all_lanes8, a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    }
+};
+
+
+// abs_avx512
+template <typename T>
+struct abs_avx512_traits<T, std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value>>
+    : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a) noexcept {
+        if constexpr (sizeof(T) == 1)
+            return _mm512_abs_epi8(a);
+        else if constexpr (sizeof(T) == 2)
+            return _mm512_abs_epi16(a);
+        else if constexpr (sizeof(T) == 4)
+            return _mm512_maskz_abs_epi32(internal::all_lanes16, a);
+        else
+            return _mm512_maskz_abs_epi64(internal::all_lanes8, a);
+    }
+};
+
+template <>
+struct abs_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_abs_ps(a);
+    }
+};
+
+template <>
+struct abs_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a) noexcept {
+        return _mm512_abs_pd(a);
+    }
+};
+
+
+// add_avx512
+template <typename T>
+struct add_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (sizeof(T) == 1)
+            return _mm512_add_epi8(a, b);
+        else if constexpr (sizeof(T) == 2)
+            return _mm512_add_epi16(a, b);
+        else if constexpr (sizeof(T) == 4)
+            return _mm512_add_epi32(a, b);
+        else
+            return _mm512_add_epi64(a, b);
+    }
+};
+
+template <>
+struct add_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_add_ps(a, b);
+    }
+};
+
+template <>
+struct add_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_add_pd(a, b);
+    }
+};
+
+
+// sub_avx512
+template <typename T>
+struct sub_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (sizeof(T) == 1)
+            return _mm512_sub_epi8(a, b);
+        else if constexpr (sizeof(T) == 2)
+            return _mm512_sub_epi16(a, b);
+        else if constexpr (sizeof(T) == 4)
+            return _mm512_sub_epi32(a, b);
+        else
+            return _mm512_sub_epi64(a, b);
+    }
+};
+
+template <>
+struct sub_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_sub_ps(a, b);
+    }
+};
+
+template <>
+struct sub_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_sub_pd(a, b);
+    }
+};
+
+
+// mul_avx512: bytes as in mul_simd
+template <typename T>
+struct mul_avx512_traits<T, internal::if_integral<T>> : internal::avx512_io<T> {
+    using simd_type = __m512i;
+
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        if constexpr (sizeof(T) == 1) {
+            const __m512i low = _mm512_set1_epi16(0x00ff);
+            const __m512i even = _mm512_and_si512(_mm512_mullo_epi16(a, b), low);
+            const __m512i odd = _mm512_mullo_epi16(_mm512_srli_epi16(a, 8), _mm512_maskz_andnot_epi64(internal::all_lanes8, low, b));
+            return _mm512_or_si512(even, odd);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm512_mullo_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_mullo_epi32(a, b);
+        } else {
+            return _mm512_mullo_epi64(a, b);
+        }
+    }
+};
+
+template <>
+struct mul_avx512_traits<float> : internal::avx512_io<float> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_mul_ps(a, b);
+    }
+};
+
+template <>
+struct mul_avx512_traits<double> : internal::avx512_io<double> {
+    static simd_type op(simd_type a, simd_type b) noexcept {
+        return _mm512_mul_pd(a, b);
+    }
+};
+
+SIMD_TARGET_END
+#endif
+
+
+#endif
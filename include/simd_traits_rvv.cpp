@@ -0,0 +1,489 @@
+#ifndef SIMD_TRAITS_RVV_HPP
+#define SIMD_TRAITS_RVV_HPP
+
+#include "simd_traits.cpp"
+#include "utils/cpu_features.cpp"
+#if SIMD_HAS_RVV
+    #include <riscv_vector.h>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// RISC-V Vector traits. The vector length is only known at run time, so
+// instead of a step these traits take the vl returned by setvl(n) on every
+// load, store and op; the drivers loop on setvl and never need a scalar tail.
+template <typename T, typename = void> struct and_rvv_traits;
+template <typename T, typename = void> struct or_rvv_traits;
+template <typename T, typename = void> struct xor_rvv_traits;
+template <typename T, typename = void> struct andnot_rvv_traits;
+template <typename T, typename = void> struct slli_rvv_traits;
+template <typename T, typename = void> struct srli_rvv_traits;
+template <typename T, typename = void> struct srai_rvv_traits;
+template <typename T, typename = void> struct sllv_rvv_traits;
+template <typename T, typename = void> struct srlv_rvv_traits;
+template <typename T, typename = void> struct min_rvv_traits;
+template <typename T, typename = void> struct max_rvv_traits;
+template <typename T, typename = void> struct sqrt_rvv_traits;
+template <typename T, typename = void> struct rsqrt_rvv_traits;
+template <typename T, typename = void> struct rsqrt_ulp1_rvv_traits;
+template <typename T, typename = void> struct rsqrt_ulp4_rvv_traits;
+template <typename T, typename = void> struct round_rvv_traits;
+template <typename T, typename = void> struct ceil_rvv_traits;
+template <typename T, typename = void> struct floor_rvv_traits;
+template <typename T, typename = void> struct abs_rvv_traits;
+template <typename T, typename = void> struct add_rvv_traits;
+template <typename T, typename = void> struct sub_rvv_traits;
+template <typename T, typename = void> struct mul_rvv_traits;
+
+
+namespace internal {
+    template <typename T>
+    struct no_rvv_traits;
+
+    // rvv_of: the RVV trait family standing in for an AVX2 one
+    template <template <typename> class Traits>
+    struct rvv_of {
+        template <typename T>
+        using traits = no_rvv_traits<T>;
+    };
+
+    template <template <typename> class Traits, typename T>
+    using rvv_traits_t = typename rvv_of<Traits>::template traits<T>;
+}
+
+#define SIMD_RVV_COUNTERPART(name) \
+namespace internal { \
+    template <> \
+    struct rvv_of<name##_simd_traits> { \
+        template <typename T> \
+        using traits = name##_rvv_traits<T>; \
+    }; \
+}
+
+SIMD_RVV_COUNTERPART(and)
+SIMD_RVV_COUNTERPART(or)
+SIMD_RVV_COUNTERPART(xor)
+SIMD_RVV_COUNTERPART(andnot)
+SIMD_RVV_COUNTERPART(slli)
+SIMD_RVV_COUNTERPART(srli)
+SIMD_RVV_COUNTERPART(srai)
+SIMD_RVV_COUNTERPART(sllv)
+SIMD_RVV_COUNTERPART(srlv)
+SIMD_RVV_COUNTERPART(min)
+SIMD_RVV_COUNTERPART(max)
+SIMD_RVV_COUNTERPART(sqrt)
+SIMD_RVV_COUNTERPART(rsqrt)
+SIMD_RVV_COUNTERPART(rsqrt_ulp1)
+SIMD_RVV_COUNTERPART(rsqrt_ulp4)
+SIMD_RVV_COUNTERPART(round)
+SIMD_RVV_COUNTERPART(ceil)
+SIMD_RVV_COUNTERPART(floor)
+SIMD_RVV_COUNTERPART(abs)
+SIMD_RVV_COUNTERPART(add)
+SIMD_RVV_COUNTERPART(sub)
+SIMD_RVV_COUNTERPART(mul)
+
+
+#if SIMD_HAS_RVV
+namespace internal {
+    // rvv_io: setvl/load/store/splat for one lane type, at LMUL=4 so each
+    // instruction covers four registers of a memory-bound loop
+    template <typename T>
+    struct rvv_io;
+
+    #define SIMD_RVV_IO(type, vector_type, sew, suffix, splat_op) \
+    template <> \
+    struct rvv_io<type> { \
+        using scalar_type = type; \
+        using simd_type = vector_type; \
+        \
+        static size_t setvl(size_t n) noexcept { \
+            return __riscv_vsetvl_e##sew##m4(n); \
+        } \
+        \
+        static simd_type load(const scalar_type *ptr, size_t vl) noexcept { \
+            return __riscv_vle##sew##_v_##suffix##m4(ptr, vl); \
+        } \
+        \
+        static void store(scalar_type *ptr, simd_type val, size_t vl) noexcept { \
+            __riscv_vse##sew##_v_##suffix##m4(ptr, val, vl); \
+        } \
+        \
+        static simd_type splat(scalar_type value, size_t vl) noexcept { \
+            return __riscv_##splat_op##_##suffix##m4(value, vl); \
+        } \
+    };
+
+    SIMD_RVV_IO(int8_t, vint8m4_t, 8, i8, vmv_v_x)
+    SIMD_RVV_IO(uint8_t, vuint8m4_t, 8, u8, vmv_v_x)
+    SIMD_RVV_IO(int16_t, vint16m4_t, 16, i16, vmv_v_x)
+    SIMD_RVV_IO(uint16_t, vuint16m4_t, 16, u16, vmv_v_x)
+    SIMD_RVV_IO(int32_t, vint32m4_t, 32, i32, vmv_v_x)
+    SIMD_RVV_IO(uint32_t, vuint32m4_t, 32, u32, vmv_v_x)
+    SIMD_RVV_IO(int64_t, vint64m4_t, 64, i64, vmv_v_x)
+    SIMD_RVV_IO(uint64_t, vuint64m4_t, 64, u64, vmv_v_x)
+    SIMD_RVV_IO(float, vfloat32m4_t, 32, f32, vfmv_v_f)
+    SIMD_RVV_IO(double, vfloat64m4_t, 64, f64, vfmv_v_f)
+
+    #undef SIMD_RVV_IO
+
+    // has_rvv_io: lane types with a vector register mapping
+    template <typename T, typename = void>
+    struct has_rvv_io : std::false_type {};
+
+    template <typename T>
+    struct has_rvv_io<T, std::void_t<decltype(sizeof(rvv_io<T>))>> : std::true_type {};
+
+    template <typename T>
+    using if_rvv_integral = std::enable_if_t<std::is_integral<T>::value && has_rvv_io<T>::value>;
+
+    template <typename T>
+    using if_rvv_float = std::enable_if_t<std::is_floating_point<T>::value && has_rvv_io<T>::value>;
+
+    template <typename T>
+    using if_rvv_any = std::enable_if_t<has_rvv_io<T>::value>;
+
+    // as_unsigned_rvv / as_signed_rvv: the same lanes viewed with the other
+    // signedness, for shift counts and logical shifts of signed lanes
+    #define SIMD_RVV_REINTERPRET(sew) \
+    inline vuint##sew##m4_t as_unsigned_rvv(vint##sew##m4_t v) noexcept { \
+        return __riscv_vreinterpret_v_i##sew##m4_u##sew##m4(v); \
+    } \
+    \
+    inline vuint##sew##m4_t as_unsigned_rvv(vuint##sew##m4_t v) noexcept { \
+        return v; \
+    } \
+    \
+    inline vint##sew##m4_t as_signed_rvv(vuint##sew##m4_t v) noexcept { \
+        return __riscv_vreinterpret_v_u##sew##m4_i##sew##m4(v); \
+    }
+
+    SIMD_RVV_REINTERPRET(8)
+    SIMD_RVV_REINTERPRET(16)
+    SIMD_RVV_REINTERPRET(32)
+    SIMD_RVV_REINTERPRET(64)
+
+    #undef SIMD_RVV_REINTERPRET
+
+    // shiftv_rvv: per-lane counts taken from b. The hardware only reads the
+    // low log2(SEW) bits of a count, so lanes with a count of the lane width
+    // or more are cleared explicitly, as the x86 kernels do.
+    template <typename T, bool Left>
+    struct shiftv_rvv : rvv_io<T> {
+        using simd_type = typename rvv_io<T>::simd_type;
+
+        static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+            using U = std::make_unsigned_t<T>;
+            const auto count = as_unsigned_rvv(b);
+            const auto overflow = __riscv_vmsgeu(count, static_cast<U>(sizeof(T) * 8), vl);
+
+            simd_type shifted;
+            if constexpr (Left)
+                shifted = __riscv_vsll(a, count, vl);
+            else if constexpr (std::is_unsigned<T>::value)
+                shifted = __riscv_vsrl(a, count, vl);
+            else
+                shifted = as_signed_rvv(__riscv_vsrl(as_unsigned_rvv(a), count, vl));
+
+            return __riscv_vmerge(shifted, T(0), overflow, vl);
+        }
+    };
+
+    // round_rvv: convert with the given rounding mode and back; lanes too
+    // large to hold a fraction (and NaN) pass through, and the sign is put
+    // back so -0.4 rounds to -0.0 as it does in <cmath>
+    template <typename T, typename V>
+    V round_rvv(V a, unsigned int frm, size_t vl) noexcept {
+        const T exact = std::is_same<T, float>::value ? static_cast<T>(8388608.0) : static_cast<T>(4503599627370496.0);
+
+        auto rounded = __riscv_vfcvt_f(__riscv_vfcvt_x_rm(a, frm, vl), vl);
+        auto fractional = __riscv_vmflt(__riscv_vfabs(a, vl), exact, vl);
+
+        return __riscv_vfsgnj(__riscv_vmerge(a, rounded, fractional, vl), a, vl);
+    }
+}
+
+
+// and_rvv
+template <typename T>
+struct and_rvv_traits<T, internal::if_rvv_integral<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        return __riscv_vand(a, b, vl);
+    }
+};
+
+
+// or_rvv
+template <typename T>
+struct or_rvv_traits<T, internal::if_rvv_integral<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        return __riscv_vor(a, b, vl);
+    }
+};
+
+
+// xor_rvv
+template <typename T>
+struct xor_rvv_traits<T, internal::if_rvv_integral<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        return __riscv_vxor(a, b, vl);
+    }
+};
+
+
+// andnot_rvv: ~a & b
+template <typename T>
+struct andnot_rvv_traits<T, internal::if_rvv_integral<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        return __riscv_vand(__riscv_vnot(a, vl), b, vl);
+    }
+};
+
+
+// slli_rvv: vsll only reads the low bits of the count, so counts of the
+// lane width or more are handled here and clear every lane
+template <typename T>
+struct slli_rvv_traits<T, internal::if_rvv_integral<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, int imm8, size_t vl) noexcept {
+        if (static_cast<unsigned>(imm8) >= sizeof(T) * 8)
+            return internal::rvv_io<T>::splat(T(0), vl);
+
+        return __riscv_vsll(a, static_cast<size_t>(imm8), vl);
+    }
+};
+
+
+// srli_rvv: logical shift; signed lanes shift arithmetically and then clear
+// the copies of the sign bit
+template <typename T>
+struct srli_rvv_traits<T, internal::if_rvv_integral<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, int imm8, size_t vl) noexcept {
+        if (static_cast<unsigned>(imm8) >= sizeof(T) * 8)
+            return internal::rvv_io<T>::splat(T(0), vl);
+
+        if constexpr (std::is_unsigned<T>::value) {
+            return __riscv_vsrl(a, static_cast<size_t>(imm8), vl);
+        } else {
+            using U = std::make_unsigned_t<T>;
+            const T keep = static_cast<T>(static_cast<U>(~U(0)) >> imm8);
+            return __riscv_vand(__riscv_vsra(a, static_cast<size_t>(imm8), vl), keep, vl);
+        }
+    }
+};
+
+
+// srai_rvv: counts past the lane width fill it with the sign bit
+template <typename T>
+struct srai_rvv_traits<T, internal::if_rvv_integral<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, int imm8, size_t vl) noexcept {
+        if constexpr (std::is_unsigned<T>::value) {
+            return srli_rvv_traits<T>::op(a, imm8, vl);
+        } else {
+            constexpr unsigned bits = sizeof(T) * 8;
+            const unsigned n = static_cast<unsigned>(imm8) >= bits ? bits - 1 : static_cast<unsigned>(imm8);
+            return __riscv_vsra(a, static_cast<size_t>(n), vl);
+        }
+    }
+};
+
+
+// sllv_rvv
+template <typename T>
+struct sllv_rvv_traits<T, internal::if_rvv_integral<T>> : internal::shiftv_rvv<T, true> {};
+
+
+// srlv_rvv
+template <typename T>
+struct srlv_rvv_traits<T, internal::if_rvv_integral<T>> : internal::shiftv_rvv<T, false> {};
+
+
+// min_rvv
+template <typename T>
+struct min_rvv_traits<T, internal::if_rvv_any<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        if constexpr (std::is_floating_point<T>::value)
+            return __riscv_vfmin(a, b, vl);
+        else if constexpr (std::is_signed<T>::value)
+            return __riscv_vmin(a, b, vl);
+        else
+            return __riscv_vminu(a, b, vl);
+    }
+};
+
+
+// max_rvv
+template <typename T>
+struct max_rvv_traits<T, internal::if_rvv_any<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        if constexpr (std::is_floating_point<T>::value)
+            return __riscv_vfmax(a, b, vl);
+        else if constexpr (std::is_signed<T>::value)
+            return __riscv_vmax(a, b, vl);
+        else
+            return __riscv_vmaxu(a, b, vl);
+    }
+};
+
+
+// sqrt_rvv
+template <typename T>
+struct sqrt_rvv_traits<T, internal::if_rvv_float<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        return __riscv_vfsqrt(a, vl);
+    }
+};
+
+
+// rsqrt_rvv: the 7-bit estimate refined by one Newton step,
+// y * (1.5 - 0.5 * a * y * y), to about the precision of _mm256_rsqrt_ps
+template <>
+struct rsqrt_rvv_traits<float> : internal::rvv_io<float> {
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        simd_type y = __riscv_vfrsqrt7(a, vl);
+        simd_type half_a_yy = __riscv_vfmul(__riscv_vfmul(__riscv_vfmul(a, y, vl), y, vl), 0.5f, vl);
+        return __riscv_vfmul(y, __riscv_vfrsub(half_a_yy, 1.5f, vl), vl);
+    }
+};
+
+
+// rsqrt_ulp1_rvv: computed in double, as rsqrt_ulp1_simd
+template <>
+struct rsqrt_ulp1_rvv_traits<float> : internal::rvv_io<float> {
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        vfloat64m8_t wide = __riscv_vfsqrt(__riscv_vfwcvt_f_f_v_f64m8(a, vl), vl);
+        return __riscv_vfncvt_f_f_w_f32m4(__riscv_vfrdiv(wide, 1.0, vl), vl);
+    }
+};
+
+
+// rsqrt_ulp4_rvv: two Newton steps, y += y * (1 - a * y * y) / 2, take the
+// 7-bit estimate to full precision; lanes that turn NaN (a = 0 or inf)
+// keep the estimate
+template <>
+struct rsqrt_ulp4_rvv_traits<float> : internal::rvv_io<float> {
+    static simd_type newton(simd_type a, simd_type y, size_t vl) noexcept {
+        simd_type residual = __riscv_vfnmsac(splat(1.0f, vl), __riscv_vfmul(a, y, vl), y, vl);
+        return __riscv_vfmacc(y, __riscv_vfmul(y, 0.5f, vl), residual, vl);
+    }
+
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        simd_type y = __riscv_vfrsqrt7(a, vl);
+        simd_type refined = newton(a, newton(a, y, vl), vl);
+        return __riscv_vmerge(refined, y, __riscv_vmfne(refined, refined, vl), vl);
+    }
+};
+
+
+// round_rvv: half-way cases away from zero, as std::round does
+template <typename T>
+struct round_rvv_traits<T, internal::if_rvv_float<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        return internal::round_rvv<T>(a, __RISCV_FRM_RMM, vl);
+    }
+};
+
+
+// ceil_rvv
+template <typename T>
+struct ceil_rvv_traits<T, internal::if_rvv_float<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        return internal::round_rvv<T>(a, __RISCV_FRM_RUP, vl);
+    }
+};
+
+
+// floor_rvv
+template <typename T>
+struct floor_rvv_traits<T, internal::if_rvv_float<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        return internal::round_rvv<T>(a, __RISCV_FRM_RDN, vl);
+    }
+};
+
+
+// abs_rvv
+template <typename T>
+struct abs_rvv_traits<T, std::enable_if_t<std::is_signed<T>::value && internal::has_rvv_io<T>::value>>
+    : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, size_t vl) noexcept {
+        if constexpr (std::is_floating_point<T>::value)
+            return __riscv_vfabs(a, vl);
+        else
+            return __riscv_vmax(a, __riscv_vneg(a, vl), vl);
+    }
+};
+
+
+// add_rvv
+template <typename T>
+struct add_rvv_traits<T, internal::if_rvv_any<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        if constexpr (std::is_floating_point<T>::value)
+            return __riscv_vfadd(a, b, vl);
+        else
+            return __riscv_vadd(a, b, vl);
+    }
+};
+
+
+// sub_rvv
+template <typename T>
+struct sub_rvv_traits<T, internal::if_rvv_any<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        if constexpr (std::is_floating_point<T>::value)
+            return __riscv_vfsub(a, b, vl);
+        else
+            return __riscv_vsub(a, b, vl);
+    }
+};
+
+
+// mul_rvv
+template <typename T>
+struct mul_rvv_traits<T, internal::if_rvv_any<T>> : internal::rvv_io<T> {
+    using simd_type = typename internal::rvv_io<T>::simd_type;
+
+    static simd_type op(simd_type a, simd_type b, size_t vl) noexcept {
+        if constexpr (std::is_floating_point<T>::value)
+            return __riscv_vfmul(a, b, vl);
+        else
+            return __riscv_vmul(a, b, vl);
+    }
+};
+#endif
+
+
+#endif
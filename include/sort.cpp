@@ -22,6 +22,18 @@ namespace internal {
     // sort2
     template <typename T, typename Compare>
     void sort2(std::vector<std::vector<T>>& A, Compare comp = CompareRows<T>{});
+
+
+    // ============================ flat ====================================
+
+    // sort1
+    template <typename T, typename Compare>
+    void sort1(T *A, size_t n, Compare comp = std::less<T>{});
+
+
+    // sort2 (sorts each row of a row-major matrix with leading dimension lda)
+    template <typename T, typename Compare>
+    void sort2(T *A, size_t rows, size_t cols, size_t lda, Compare comp = std::less<T>{});
 }
 
 namespace internal {
@@ -45,6 +57,25 @@ namespace internal {
             }
         }
     }
+
+
+    // ============================ flat ====================================
+
+    template <typename T, typename Compare>
+    void sort1(T *A, size_t n, Compare comp) {
+        if (n < 8192) {
+            std::sort(A, A + n, comp);
+        } else {
+            boost::sort::pdqsort(A, A + n, comp);
+        }
+    }
+
+
+    template <typename T, typename Compare>
+    void sort2(T *A, size_t rows, size_t cols, size_t lda, Compare comp) {
+        for (size_t i = 0; i < rows; ++i)
+            sort1(A + i * lda, cols, comp);
+    }
 }
 
 #endif
@@ -0,0 +1,311 @@
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include "simd_traits.cpp"
+#include "utils/simd_operators.cpp"
+#include "parallel_for.cpp"
+#include "reduce.cpp"
+#include "matrix_operations.cpp"
+
+// Delta degrees of freedom for the whole-array var and std. A bare integer
+// is an axis there as for every other reduction, so ddof is named:
+// a.var(ddof_t{1}) is the sample variance, a.var(1) the variance along axis 1.
+struct ddof_t {
+    explicit constexpr ddof_t(size_t count) noexcept : value(count) {}
+
+    size_t value;
+};
+
+namespace internal {
+    // Every statistic is one pass over the data: Welford's update within a
+    // lane or column, Chan's merge between lanes and threads. The divisor
+    // is n - ddof; with n <= ddof the result is NaN, as numpy gives
+
+    // ================================= 1D ====================================
+    // var1
+    template <typename T>
+    T var1_simd(const T *A, size_t n, size_t ddof = 0);
+
+
+    // std1: square root of var1
+    template <typename T>
+    T std1_simd(const T *A, size_t n, size_t ddof = 0);
+
+
+    // ============================== along an axis ==============================
+    // A is viewed as [outer, len, inner] with the reduced axis in the middle;
+    // result is [outer, inner]
+
+    // var_axis
+    template <typename T>
+    void var_axis(const T *A, T *result, size_t outer, size_t len, size_t inner, size_t ddof = 0);
+
+
+    // std_axis
+    template <typename T>
+    void std_axis(const T *A, T *result, size_t outer, size_t len, size_t inner, size_t ddof = 0);
+
+
+    // ============================= covariance ================================
+    // X holds vars variables of obs observations each: [vars, obs] when
+    // rowvar, [obs, vars] otherwise; result is [vars, vars]
+
+    // cov: normalised by obs - ddof
+    template <typename T>
+    void cov(const T *X, T *result, size_t vars, size_t obs, bool rowvar, size_t ddof = 1);
+
+
+    // corrcoef: cov scaled to a unit diagonal, clipped to [-1, 1]
+    template <typename T>
+    void corrcoef(const T *X, T *result, size_t vars, size_t obs, bool rowvar);
+}
+
+
+namespace internal {
+    // variance: m2 / (count - ddof), NaN when count <= ddof
+    template <typename T>
+    T variance(T m2, size_t count, size_t ddof) noexcept {
+        return count > ddof ? m2 / static_cast<T>(count - ddof) : std::numeric_limits<T>::quiet_NaN();
+    }
+
+
+    // ================================= 1D ====================================
+    // var1_simd
+    template <typename T>
+    T var1_simd(const T *A, size_t n, size_t ddof) {
+        static_assert(std::is_floating_point<T>::value, "var needs a floating-point type.");
+
+        const moments<T> m = dispatch_moments_op(A, n);
+        return variance(m.m2, m.count, ddof);
+    }
+
+
+    // std1_simd
+    template <typename T>
+    T std1_simd(const T *A, size_t n, size_t ddof) {
+        return std::sqrt(var1_simd(A, n, ddof));
+    }
+
+
+    // ============================== along an axis ==============================
+    // moments_axis: a contiguous axis is one dispatch_moments_op per row. A
+    // strided one streams its rows through a tile of per-column means and
+    // M2s; the columns share the count, so 1 / k is one division per row
+    // and the update vectorises across the tile
+    template <typename T>
+    void moments_axis(const T *A, T *result, size_t outer, size_t len, size_t inner, size_t ddof, bool root) {
+        static_assert(std::is_floating_point<T>::value, "var needs a floating-point type.");
+
+        auto finish = [&](T m2) {
+            const T v = variance(m2, len, ddof);
+            return root ? std::sqrt(v) : v;
+        };
+
+        if (inner == 1) {
+            parallel_rows(outer, len, [&](size_t o) {
+                result[o] = finish(dispatch_moments_op(A + o * len, len).m2);
+            });
+            return;
+        }
+
+        const size_t tile = std::max<size_t>(reduce_tile_bytes / (2 * sizeof(T)), 1);
+
+        parallel_rows(outer, len * inner, [&](size_t o) {
+            const T *a = A + o * len * inner;
+            T *r = result + o * inner;
+
+            parallel_chunks<T>(inner, [&](size_t begin, size_t end) {
+                std::vector<T> mean(std::min(tile, end - begin)), m2(mean.size());
+
+                for (size_t j = begin; j < end; j += tile) {
+                    const size_t count = std::min(tile, end - j);
+                    std::fill(mean.begin(), mean.begin() + count, T(0));
+                    std::fill(m2.begin(), m2.begin() + count, T(0));
+
+                    for (size_t k = 0; k < len; ++k) {
+                        const T *row = a + k * inner + j;
+                        const T scale = T(1) / static_cast<T>(k + 1);
+
+                        for (size_t m = 0; m < count; ++m) {
+                            const T delta = row[m] - mean[m];
+                            mean[m] += delta * scale;
+                            m2[m] += delta * (row[m] - mean[m]);
+                        }
+                    }
+
+                    for (size_t m = 0; m < count; ++m)
+                        r[j + m] = finish(m2[m]);
+                }
+            });
+        });
+    }
+
+
+    // var_axis
+    template <typename T>
+    void var_axis(const T *A, T *result, size_t outer, size_t len, size_t inner, size_t ddof) {
+        moments_axis(A, result, outer, len, inner, ddof, false);
+    }
+
+
+    // std_axis
+    template <typename T>
+    void std_axis(const T *A, T *result, size_t outer, size_t len, size_t inner, size_t ddof) {
+        moments_axis(A, result, outer, len, inner, ddof, true);
+    }
+
+
+    // ============================= covariance ================================
+    // from this many variables on, the data is centred and the co-moments
+    // come from one gemm; below it the O(vars^2) update per observation
+    // costs less than the centred copy
+    constexpr size_t cov_gemm_min_vars = 16;
+
+    // comoments: count, means and the upper triangle of the co-moment
+    // matrix, sum of (x_i - mean_i)(x_j - mean_j)
+    template <typename T>
+    struct comoments {
+        size_t count = 0;
+        std::vector<T> mean;
+        std::vector<T> c;
+    };
+
+    // merge_comoments: Chan's merge, extended to the cross terms
+    template <typename T>
+    comoments<T> merge_comoments(const comoments<T>& a, const comoments<T>& b) {
+        if (a.count == 0)
+            return b;
+        if (b.count == 0)
+            return a;
+
+        const size_t vars = a.mean.size();
+        comoments<T> result;
+        result.count = a.count + b.count;
+        result.mean.resize(vars);
+        result.c.resize(vars * vars);
+
+        const T weight = static_cast<T>(b.count) / static_cast<T>(result.count);
+        const T spread = static_cast<T>(a.count) * weight;
+
+        std::vector<T> delta(vars);
+        for (size_t i = 0; i < vars; ++i) {
+            delta[i] = b.mean[i] - a.mean[i];
+            result.mean[i] = a.mean[i] + delta[i] * weight;
+        }
+
+        for (size_t i = 0; i < vars; ++i)
+            for (size_t j = i; j < vars; ++j)
+                result.c[i * vars + j] = a.c[i * vars + j] + b.c[i * vars + j] + delta[i] * delta[j] * spread;
+
+        return result;
+    }
+
+    // cov_comoments: single pass, Welford's update of the co-moments per
+    // observation within a chunk, Chan's merge across chunks. The chunks
+    // split the obs * vars elements, and each takes the observations that
+    // start inside it
+    template <typename T>
+    void cov_comoments(const T *X, T *result, size_t vars, size_t obs, bool rowvar, size_t ddof) {
+        const auto total = parallel_reduce<T>(obs * vars, [&](size_t begin, size_t end) {
+            comoments<T> state;
+            state.mean.assign(vars, T(0));
+            state.c.assign(vars * vars, T(0));
+
+            std::vector<T> x(vars), delta(vars);
+            for (size_t t = (begin + vars - 1) / vars; t < (end + vars - 1) / vars; ++t) {
+                for (size_t i = 0; i < vars; ++i)
+                    x[i] = rowvar ? X[i * obs + t] : X[t * vars + i];
+
+                ++state.count;
+                const T scale = T(1) / static_cast<T>(state.count);
+                for (size_t i = 0; i < vars; ++i) {
+                    delta[i] = x[i] - state.mean[i];
+                    state.mean[i] += delta[i] * scale;
+                }
+
+                for (size_t i = 0; i < vars; ++i)
+                    for (size_t j = i; j < vars; ++j)
+                        state.c[i * vars + j] += delta[i] * (x[j] - state.mean[j]);
+            }
+
+            return state;
+        }, [](const comoments<T>& later, const comoments<T>& earlier) {
+            return merge_comoments(earlier, later);
+        });
+
+        for (size_t i = 0; i < vars; ++i) {
+            for (size_t j = i; j < vars; ++j) {
+                const T value = total.count > 0 ? variance(total.c[i * vars + j], obs, ddof)
+                                                : std::numeric_limits<T>::quiet_NaN();
+                result[i * vars + j] = value;
+                result[j * vars + i] = value;
+            }
+        }
+    }
+
+    // cov_gemm: the mean of each variable, a centred copy, then Xc Xc^T (or
+    // Xc^T Xc) through dot
+    template <typename T>
+    void cov_gemm(const T *X, T *result, size_t vars, size_t obs, bool rowvar, size_t ddof) {
+        std::vector<T> mean(vars), centred(vars * obs);
+
+        if (rowvar) {
+            mean_axis(X, mean.data(), vars, obs, 1);
+            parallel_rows(vars, obs, [&](size_t i) {
+                dispatch_binary_op<T, sub_simd_traits>(X + i * obs, 1, &mean[i], 0, &centred[i * obs], obs,
+                                                       [](T a, T b) { return a - b; });
+            });
+
+            dot(false, true, vars, vars, obs, centred.data(), obs, centred.data(), obs, result, vars);
+        } else {
+            mean_axis(X, mean.data(), 1, obs, vars);
+            parallel_rows(obs, vars, [&](size_t t) {
+                dispatch_binary_op<T, sub_simd_traits>(X + t * vars, mean.data(), &centred[t * vars], vars,
+                                                       [](T a, T b) { return a - b; });
+            });
+
+            dot(true, false, vars, vars, obs, centred.data(), vars, centred.data(), vars, result, vars);
+        }
+
+        const T scale = obs > ddof ? T(1) / static_cast<T>(obs - ddof) : std::numeric_limits<T>::quiet_NaN();
+        for (size_t i = 0; i < vars * vars; ++i)
+            result[i] *= scale;
+    }
+
+    // cov
+    template <typename T>
+    void cov(const T *X, T *result, size_t vars, size_t obs, bool rowvar, size_t ddof) {
+        static_assert(std::is_floating_point<T>::value, "cov needs a floating-point type.");
+
+        if (vars == 0)
+            return;
+
+        if (vars >= cov_gemm_min_vars && obs > 0)
+            cov_gemm(X, result, vars, obs, rowvar, ddof);
+        else
+            cov_comoments(X, result, vars, obs, rowvar, ddof);
+    }
+
+
+    // corrcoef: ddof cancels out, so the covariance is left unnormalised
+    template <typename T>
+    void corrcoef(const T *X, T *result, size_t vars, size_t obs, bool rowvar) {
+        cov(X, result, vars, obs, rowvar, 0);
+
+        std::vector<T> scale(vars);
+        for (size_t i = 0; i < vars; ++i)
+            scale[i] = T(1) / std::sqrt(result[i * vars + i]);
+
+        for (size_t i = 0; i < vars; ++i)
+            for (size_t j = 0; j < vars; ++j)
+                result[i * vars + j] = std::clamp(result[i * vars + j] * scale[i] * scale[j], T(-1), T(1));
+    }
+}
+
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef ACCURACY_HPP
+#define ACCURACY_HPP
+
+#include <optional>
+
+// Error bound the transcendental and reciprocal kernels must meet, in units
+// in the last place of the result. Kernels with a faster form (rsqrt, exp,
+// log) switch to it under ulp4 or approx; the rest meet ulp1 in every mode.
+// Until a thread sets a mode each kernel runs at its default: rsqrt at
+// default_rsqrt_accuracy, the hardware estimate it always returned, and
+// everything else at default_accuracy. Lazy expressions pick their kernels
+// when built and do not follow it.
+enum class accuracy {
+    ulp1 = 0,   // within 1 ULP
+    ulp4 = 1,   // within 4 ULP: in-tree polynomials, Newton-refined estimates
+    approx = 2  // hardware estimates as they are (rsqrt to about 12 bits)
+};
+
+inline constexpr accuracy default_accuracy = accuracy::ulp1;
+inline constexpr accuracy default_rsqrt_accuracy = accuracy::approx;
+
+
+namespace internal {
+    // empty until the thread sets a mode
+    inline std::optional<accuracy>& thread_accuracy() noexcept {
+        thread_local std::optional<accuracy> mode;
+        return mode;
+    }
+
+    // kernel_accuracy / rsqrt_accuracy: the mode a kernel runs at
+    inline accuracy kernel_accuracy() noexcept {
+        return thread_accuracy().value_or(default_accuracy);
+    }
+
+    inline accuracy rsqrt_accuracy() noexcept {
+        return thread_accuracy().value_or(default_rsqrt_accuracy);
+    }
+}
+
+
+// Accuracy set on the calling thread, empty while every kernel runs at its
+// default. Kernels read it before splitting work across OpenMP threads, so
+// the workers' own settings do not matter.
+inline std::optional<accuracy> get_accuracy() noexcept {
+    return internal::thread_accuracy();
+}
+
+inline void set_accuracy(accuracy mode) noexcept {
+    internal::thread_accuracy() = mode;
+}
+
+
+// accuracy_scope: mode for the calling thread until the end of the scope
+class accuracy_scope {
+public:
+    explicit accuracy_scope(accuracy mode) noexcept : __previous(internal::thread_accuracy()) {
+        set_accuracy(mode);
+    }
+
+    ~accuracy_scope() {
+        internal::thread_accuracy() = __previous;
+    }
+
+    accuracy_scope(const accuracy_scope&) = delete;
+    accuracy_scope& operator=(const accuracy_scope&) = delete;
+
+private:
+    std::optional<accuracy> __previous;
+};
+
+
+// How floating-point sum, mean and vdot accumulate. The error of fast grows
+// with n (several digits lost over 1e8 floats); pairwise sums blocks as a
+// tree, at about the same speed; compensated carries the rounding error of
+// every add next to the sum, about 2x the work but accurate to a rounding
+// or so for any n, which lets float data stay in float. Integers are exact
+// and ignore it.
+enum class summation {
+    fast = 0,        // several SIMD accumulators, error O(n) roundings
+    pairwise = 1,    // blocks of fast combined as a tree, O(log n)
+    compensated = 2  // TwoSum (and TwoProduct for vdot) in every lane, O(1)
+};
+
+
+namespace internal {
+    inline summation& thread_summation() noexcept {
+        thread_local summation mode = summation::fast;
+        return mode;
+    }
+}
+
+
+// Summation on the calling thread, read before work is split as accuracy is.
+inline summation get_summation() noexcept {
+    return internal::thread_summation();
+}
+
+inline void set_summation(summation mode) noexcept {
+    internal::thread_summation() = mode;
+}
+
+
+// summation_scope: mode for the calling thread until the end of the scope
+class summation_scope {
+public:
+    explicit summation_scope(summation mode) noexcept : __previous(get_summation()) {
+        set_summation(mode);
+    }
+
+    ~summation_scope() {
+        set_summation(__previous);
+    }
+
+    summation_scope(const summation_scope&) = delete;
+    summation_scope& operator=(const summation_scope&) = delete;
+
+private:
+    summation __previous;
+};
+
+
+#endif
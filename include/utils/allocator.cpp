@@ -0,0 +1,259 @@
+#ifndef ALLOCATOR_HPP
+#define ALLOCATOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace internal {
+    // memory_pool: per-thread free lists of 64-byte aligned blocks, one list
+    // per power-of-two size class, so repeated same-shape ops reuse buffers
+    // (and their already-faulted pages) instead of going back to malloc
+    class memory_pool {
+    public:
+        static constexpr size_t alignment = 64;
+
+        void *allocate(size_t bytes);
+
+        void deallocate(void *ptr, size_t bytes) noexcept;
+
+        // free every cached block
+        void release() noexcept;
+
+        size_t cached_bytes() const noexcept;
+
+        ~memory_pool();
+
+        // blocks up to 2^max_class bytes (the default limit) are rounded up
+        // to their class, so any of them can later be cached and handed out
+        // for any request of that class; larger ones are never cached and
+        // keep their exact size
+        static constexpr size_t max_class = 28;
+
+        static bool pooled(size_t bytes) noexcept;
+
+        // class of a pooled size
+        static size_t size_class(size_t bytes) noexcept;
+
+        // bytes actually allocated for a request
+        static size_t block_size(size_t bytes) noexcept;
+
+    private:
+        static constexpr size_t min_class = 6;
+        static constexpr size_t num_classes = max_class + 1;
+
+        std::vector<void *> __free[num_classes];
+        size_t __cached = 0;
+    };
+
+
+    // upper bound on the bytes each thread keeps cached
+    inline std::atomic<size_t> memory_pool_limit{static_cast<size_t>(256) << 20};
+
+    // the calling thread's pool, or nullptr once it has been torn down at
+    // thread exit
+    memory_pool *local_memory_pool() noexcept;
+}
+
+// Cache-line aligned allocator that default-initialises instead of
+// value-initialising. Aligned buffers keep SIMD loads and stores from
+// straddling cache lines, and resizing a std::vector of a trivial type leaves
+// the new elements untouched rather than zeroing memory a kernel is about to
+// overwrite.
+template <typename T, size_t Alignment = 64>
+class aligned_allocator {
+public:
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of two no smaller than alignof(T).");
+
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() noexcept = default;
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+    T *allocate(size_t n) {
+        if constexpr (Alignment <= internal::memory_pool::alignment) {
+            if (internal::memory_pool *pool = internal::local_memory_pool())
+                return static_cast<T *>(pool->allocate(n * sizeof(T)));
+
+            return static_cast<T *>(::operator new(internal::memory_pool::block_size(n * sizeof(T)),
+                                                   std::align_val_t(internal::memory_pool::alignment)));
+        }
+
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept {
+        if constexpr (Alignment <= internal::memory_pool::alignment) {
+            internal::memory_pool *pool = internal::local_memory_pool();
+            if (pool) {
+                pool->deallocate(ptr, n * sizeof(T));
+                return;
+            }
+
+            // the thread is exiting
+            ::operator delete(ptr, std::align_val_t(internal::memory_pool::alignment));
+            return;
+        }
+
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void *>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *ptr, Args&&... args) {
+        ::new (static_cast<void *>(ptr)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept {
+    return false;
+}
+
+
+// Limit on the bytes of freed ndarray buffers each thread keeps for reuse.
+inline void set_memory_pool_limit(size_t bytes) noexcept {
+    internal::memory_pool_limit.store(bytes, std::memory_order_relaxed);
+}
+
+// Return the calling thread's cached buffers to the system.
+inline void release_memory_pool() noexcept {
+    if (internal::memory_pool *pool = internal::local_memory_pool())
+        pool->release();
+}
+
+
+// Tag selecting the ndarray constructor that skips zero-filling.
+struct uninitialized_t {
+    explicit uninitialized_t() = default;
+};
+
+inline constexpr uninitialized_t uninitialized{};
+
+
+namespace internal {
+    // memory_pool
+    inline bool memory_pool::pooled(size_t bytes) noexcept {
+        return bytes <= static_cast<size_t>(1) << max_class;
+    }
+
+    inline size_t memory_pool::size_class(size_t bytes) noexcept {
+        size_t cls = min_class;
+        while (cls < max_class && (static_cast<size_t>(1) << cls) < bytes)
+            ++cls;
+
+        return cls;
+    }
+
+    inline size_t memory_pool::block_size(size_t bytes) noexcept {
+        return pooled(bytes) ? static_cast<size_t>(1) << size_class(bytes) : bytes;
+    }
+
+    inline void *memory_pool::allocate(size_t bytes) {
+        if (!pooled(bytes))
+            return ::operator new(bytes, std::align_val_t(alignment));
+
+        const size_t cls = size_class(bytes);
+        const size_t block = static_cast<size_t>(1) << cls;
+
+        if (!__free[cls].empty()) {
+            void *ptr = __free[cls].back();
+            __free[cls].pop_back();
+            __cached -= block;
+            return ptr;
+        }
+
+        return ::operator new(block, std::align_val_t(alignment));
+    }
+
+    inline void memory_pool::deallocate(void *ptr, size_t bytes) noexcept {
+        const size_t cls = size_class(bytes);
+        const size_t block = static_cast<size_t>(1) << cls;
+        const size_t limit = memory_pool_limit.load(std::memory_order_relaxed);
+
+        if (!pooled(bytes) || __cached + block > limit) {
+            ::operator delete(ptr, std::align_val_t(alignment));
+            return;
+        }
+
+        try {
+            __free[cls].push_back(ptr);
+            __cached += block;
+        } catch (...) {
+            ::operator delete(ptr, std::align_val_t(alignment));
+        }
+    }
+
+    inline void memory_pool::release() noexcept {
+        for (std::vector<void *>& blocks : __free) {
+            for (void *ptr : blocks)
+                ::operator delete(ptr, std::align_val_t(alignment));
+
+            blocks.clear();
+        }
+
+        __cached = 0;
+    }
+
+    inline size_t memory_pool::cached_bytes() const noexcept {
+        return __cached;
+    }
+
+    inline memory_pool::~memory_pool() {
+        release();
+    }
+
+
+    // local_memory_pool: the flags are trivially destructible, so they stay
+    // readable while other thread_local and static objects are destroyed
+    inline thread_local memory_pool *tls_memory_pool = nullptr;
+    inline thread_local bool tls_memory_pool_destroyed = false;
+
+    struct memory_pool_guard {
+        ~memory_pool_guard() {
+            delete tls_memory_pool;
+            tls_memory_pool = nullptr;
+            tls_memory_pool_destroyed = true;
+        }
+    };
+
+    inline memory_pool *local_memory_pool() noexcept {
+        if (tls_memory_pool_destroyed)
+            return nullptr;
+
+        if (!tls_memory_pool) {
+            thread_local memory_pool_guard guard;
+            tls_memory_pool = new (std::nothrow) memory_pool();
+        }
+
+        return tls_memory_pool;
+    }
+}
+
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef CPU_FEATURES_HPP
+#define CPU_FEATURES_HPP
+
+#include <atomic>
+
+// SIMD kernels are compiled for their instruction set through target regions
+// instead of global -m flags, and picked at run time from CPUID, so a single
+// binary runs on any x86-64 host.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define SIMD_HAS_AVX2 1
+#else
+    #define SIMD_HAS_AVX2 0
+#endif
+
+// RISC-V builds select the V extension at compile time (-march=rv64gcv). The
+// RVV kernels have not been run on hardware or an emulator yet, so they are
+// also opt-in through NUMPYCPP_ENABLE_RVV until a test run covers them.
+#if defined(NUMPYCPP_ENABLE_RVV) && defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 12000
+    #define SIMD_HAS_RVV 1
+#else
+    #define SIMD_HAS_RVV 0
+#endif
+
+// A template takes its target from its first declaration, so declarations
+// made outside a target region carry SIMD_TARGET_AVX2 explicitly.
+#if SIMD_HAS_AVX2
+    #define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma")))
+
+    #if defined(__clang__)
+        #define SIMD_TARGET_AVX2_BEGIN \
+            _Pragma("clang attribute push (__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+        #define SIMD_TARGET_AVX512_BEGIN \
+            _Pragma("clang attribute push (__attribute__((target(\"avx512f,avx512bw,avx512dq,avx512vl,avx2,fma\"))), apply_to = function)")
+        #define SIMD_TARGET_END _Pragma("clang attribute pop")
+    #else
+        #define SIMD_TARGET_AVX2_BEGIN \
+            _Pragma("GCC push_options") \
+            _Pragma("GCC target(\"avx2,fma\")")
+        #define SIMD_TARGET_AVX512_BEGIN \
+            _Pragma("GCC push_options") \
+            _Pragma("GCC target(\"avx512f,avx512bw,avx512dq,avx512vl,avx2,fma\")")
+        #define SIMD_TARGET_END _Pragma("GCC pop_options")
+    #endif
+#else
+    #define SIMD_TARGET_AVX2
+    #define SIMD_TARGET_AVX512
+#endif
+
+
+// Instruction set levels. Values are distinct identifiers; ordering between
+// levels goes through rank(), which is only meaningful within one architecture.
+enum class simd_level {
+    scalar = 0,
+    avx2 = 1,
+    avx512 = 2,
+    rvv = 3
+};
+
+
+// rank: a higher rank implies the lower ones of the same architecture
+inline constexpr int rank(simd_level level) noexcept {
+    switch (level) {
+        case simd_level::avx2:   return 1;
+        case simd_level::avx512: return 2;
+        case simd_level::rvv:    return 1;
+        default:                 return 0;
+    }
+}
+
+
+namespace internal {
+    // detect_simd_level: best level this CPU (and OS) supports
+    inline simd_level detect_simd_level() noexcept {
+        #if SIMD_HAS_AVX2
+            __builtin_cpu_init();
+
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+                return simd_level::avx512;
+
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return simd_level::avx2;
+        #elif SIMD_HAS_RVV
+            return simd_level::rvv;
+        #endif
+
+        return simd_level::scalar;
+    }
+
+    inline std::atomic<simd_level>& active_simd_level() noexcept {
+        static std::atomic<simd_level> level{detect_simd_level()};
+        return level;
+    }
+
+    // same_simd_family: scalar is part of every family, rvv only of its own
+    inline constexpr bool same_simd_family(simd_level a, simd_level b) noexcept {
+        return a == simd_level::scalar || b == simd_level::scalar ||
+               (a == simd_level::rvv) == (b == simd_level::rvv);
+    }
+
+    inline bool simd_level_at_least(simd_level level) noexcept {
+        const simd_level active = active_simd_level().load(std::memory_order_relaxed);
+        return same_simd_family(active, level) && rank(active) >= rank(level);
+    }
+}
+
+
+// Level the kernels currently dispatch to.
+inline simd_level get_simd_level() noexcept {
+    return internal::active_simd_level().load(std::memory_order_relaxed);
+}
+
+// Cap dispatch at level (e.g. to compare against the scalar path). Levels the
+// CPU does not support, including those of another architecture, are clamped
+// to the detected one.
+inline void set_simd_level(simd_level level) noexcept {
+    static const simd_level detected = internal::detect_simd_level();
+    const bool lower = internal::same_simd_family(level, detected) && rank(level) < rank(detected);
+    internal::active_simd_level().store(lower ? level : detected, std::memory_order_relaxed);
+}
+
+
+#endif
@@ -3,7 +3,15 @@
 
 #include <vector>
 #include "../simd_traits.cpp"
+#include "../simd_traits_avx512.cpp"
+#include "../simd_traits_rvv.cpp"
+#include "../parallel_for.cpp"
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 template <typename T, typename Traits, typename UnaryOp>
 std::vector<T> apply_unary_op_plain(const std::vector<T>& A, UnaryOp unary_op);
@@ -16,23 +24,521 @@ std::vector<std::vector<T>> apply_binary_op_plain(const std::vector<std::vector<
                                                   const std::vector<std::vector<T>>& B,
                                                   BinaryOp binary_op);
 
-#ifdef __AVX2__
+// flat variants: result may alias any of the inputs
+template <typename T, typename UnaryOp>
+void apply_unary_op_plain(const T *A, T *result, size_t n, UnaryOp unary_op);
+
+template <typename T, typename BinaryOp>
+void apply_binary_op_plain(const T *A, const T *B, T *result, size_t n, BinaryOp binary_op);
+
+// broadcast variants: inc_a/inc_b are 1 for a contiguous operand and 0 for one
+// whose single element is repeated across the row
+template <typename T, typename BinaryOp>
+void apply_binary_op_plain(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n,
+                           BinaryOp binary_op);
+
+// two-output variants: unary_op returns a std::pair, written to first and
+// second, so ops like sincos share their work between both results
+template <typename T, typename UnaryOp>
+void apply_unary_op_plain_pair(const T *A, T *first, T *second, size_t n, UnaryOp unary_op);
+
+// reduce variants: A folded into one value starting from identity, as
+// binary_op(element, accumulator). With the element first the hardware
+// min/max and the scalar ones agree on skipping NaN elements
+template <typename T, typename BinaryOp>
+T reduce_op_plain(const T *A, size_t n, T identity, BinaryOp binary_op);
+
+// compensated sums: every add is a TwoSum, which also yields its exact
+// rounding error; the errors are added up on the side, and the answer is
+// the pair {sum, compensation} passed to internal::compensated_total
+template <typename T>
+std::pair<T, T> sum_compensated_plain(const T *A, size_t n);
+
+// inner products: A[i] * B[i] folded as add_op(mul_op(a, b), acc). The
+// compensated form also adds the exact error of every product, taken with
+// an FMA (TwoProduct)
+template <typename T, typename AddOp, typename MulOp>
+T dot_op_plain(const T *A, const T *B, size_t n, AddOp add_op, MulOp mul_op);
+
+template <typename T>
+std::pair<T, T> dot_compensated_plain(const T *A, const T *B, size_t n);
+
+// moments: count, mean and sum of squared deviations (M2) of A in one pass
+namespace internal {
+    template <typename T>
+    struct moments;
+}
+
+template <typename T>
+internal::moments<T> moments_op_plain(const T *A, size_t n);
+
+#if SIMD_HAS_AVX2
 template <typename T, typename Traits, typename UnaryOp>
+SIMD_TARGET_AVX2
 std::vector<T> apply_unary_op_simd(const std::vector<T>& A, UnaryOp unary_op);
 
 template <typename T, typename Traits, typename BinaryOp>
+SIMD_TARGET_AVX2
 std::vector<std::vector<T>> apply_binary_op_simd(const std::vector<std::vector<T>>& A,
                                                  const std::vector<std::vector<T>>& B,
                                                  BinaryOp binary_op);
+
+template <typename T, typename Traits, typename UnaryOp>
+SIMD_TARGET_AVX2
+void apply_unary_op_simd(const T *A, T *result, size_t n, UnaryOp unary_op);
+
+template <typename T, typename Traits, typename UnaryOp>
+SIMD_TARGET_AVX2
+void apply_unary_op_simd_shift(const T *A, T *result, size_t n, const int imm8, UnaryOp unary_op);
+
+template <typename T, typename Traits>
+SIMD_TARGET_AVX2
+void apply_unary_op_simd_pair(const T *A, T *first, T *second, size_t n);
+
+template <typename T, typename Traits, typename BinaryOp>
+SIMD_TARGET_AVX2
+void apply_binary_op_simd(const T *A, const T *B, T *result, size_t n, BinaryOp binary_op);
+
+template <typename T, typename Traits, typename BinaryOp>
+SIMD_TARGET_AVX2
+void apply_binary_op_simd(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n,
+                          BinaryOp binary_op);
+
+template <typename T, typename Traits, typename BinaryOp>
+SIMD_TARGET_AVX2
+T reduce_op_simd(const T *A, size_t n, T identity, BinaryOp binary_op);
+
+template <typename T, typename Add, typename Sub>
+SIMD_TARGET_AVX2
+std::pair<T, T> sum_compensated_simd(const T *A, size_t n);
+
+// Traits are the inner_product_simd_traits of T
+template <typename T, typename Traits>
+SIMD_TARGET_AVX2
+T dot_op_simd(const T *A, const T *B, size_t n);
+
+template <typename T, typename Inner, typename Add, typename Sub>
+SIMD_TARGET_AVX2
+std::pair<T, T> dot_compensated_simd(const T *A, const T *B, size_t n);
+
+template <typename T, typename Add, typename Sub, typename Mul>
+SIMD_TARGET_AVX2
+internal::moments<T> moments_op_simd(const T *A, size_t n);
+
+// AVX-512 drivers: Traits provide masked load/store, so there is no scalar
+// head or tail and no scalar op to pass
+template <typename T, typename Traits>
+SIMD_TARGET_AVX512
+void apply_unary_op_avx512(const T *A, T *result, size_t n);
+
+template <typename T, typename Traits>
+SIMD_TARGET_AVX512
+void apply_unary_op_avx512_shift(const T *A, T *result, size_t n, const int imm8);
+
+template <typename T, typename Traits>
+SIMD_TARGET_AVX512
+void apply_unary_op_avx512_pair(const T *A, T *first, T *second, size_t n);
+
+template <typename T, typename Traits>
+SIMD_TARGET_AVX512
+void apply_binary_op_avx512(const T *A, const T *B, T *result, size_t n);
+
+template <typename T, typename Traits>
+SIMD_TARGET_AVX512
+void apply_binary_op_avx512(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n);
+
+template <typename T, typename Traits, typename BinaryOp>
+SIMD_TARGET_AVX512
+T reduce_op_avx512(const T *A, size_t n, T identity, BinaryOp binary_op);
+
+template <typename T, typename Add, typename Sub>
+SIMD_TARGET_AVX512
+std::pair<T, T> sum_compensated_avx512(const T *A, size_t n);
+
+template <typename T, typename Add, typename Sub, typename Mul>
+SIMD_TARGET_AVX512
+internal::moments<T> moments_op_avx512(const T *A, size_t n);
+#endif
+
+#if SIMD_HAS_RVV
+// RVV drivers: strip-mined on setvl, so the last pass simply runs shorter
+template <typename T, typename Traits>
+void apply_unary_op_rvv(const T *A, T *result, size_t n);
+
+template <typename T, typename Traits>
+void apply_unary_op_rvv_shift(const T *A, T *result, size_t n, const int imm8);
+
+template <typename T, typename Traits>
+void apply_binary_op_rvv(const T *A, const T *B, T *result, size_t n);
+
+template <typename T, typename Traits>
+void apply_binary_op_rvv(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n);
+
+template <typename T, typename Traits, typename BinaryOp>
+T reduce_op_rvv(const T *A, size_t n, T identity, BinaryOp binary_op);
+
+template <typename T, typename Add, typename Sub>
+std::pair<T, T> sum_compensated_rvv(const T *A, size_t n);
+
+template <typename T, typename Add, typename Sub, typename Mul>
+internal::moments<T> moments_op_rvv(const T *A, size_t n);
+#endif
+
+// dispatch: pick the widest SIMD driver whose traits exist for T and whose
+// instruction set the CPU supports (AVX-512, then AVX2; RVV on RISC-V),
+// otherwise the plain loop
+template <typename T, template <typename> class Traits, typename UnaryOp>
+void dispatch_unary_op(const T *A, T *result, size_t n, UnaryOp unary_op);
+
+template <typename T, template <typename> class Traits, typename UnaryOp>
+void dispatch_unary_op_shift(const T *A, T *result, size_t n, const int imm8, UnaryOp unary_op);
+
+template <typename T, template <typename> class Traits, typename UnaryOp>
+void dispatch_unary_op_pair(const T *A, T *first, T *second, size_t n, UnaryOp unary_op);
+
+template <typename T, template <typename> class Traits, typename BinaryOp>
+void dispatch_binary_op(const T *A, const T *B, T *result, size_t n, BinaryOp binary_op);
+
+template <typename T, template <typename> class Traits, typename BinaryOp>
+void dispatch_binary_op(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n,
+                        BinaryOp binary_op);
+
+template <typename T, template <typename> class Traits, typename BinaryOp>
+T dispatch_reduce_op(const T *A, size_t n, T identity, BinaryOp binary_op);
+
+// compensated sum of a floating-point T
+template <typename T>
+T dispatch_sum_compensated(const T *A, size_t n);
+
+// inner products; the SIMD drivers cover floating-point T, whose products
+// stay in T (the integer inner_product_simd_traits widen instead)
+template <typename T, typename AddOp, typename MulOp>
+T dispatch_dot_op(const T *A, const T *B, size_t n, AddOp add_op, MulOp mul_op);
+
+template <typename T>
+T dispatch_dot_compensated(const T *A, const T *B, size_t n);
+
+// moments of a floating-point T; the chunks are merged by Chan's formula
+template <typename T>
+internal::moments<T> dispatch_moments_op(const T *A, size_t n);
+
+// serial forms: the drivers the dispatchers would pick, run on the calling
+// thread, for callers that split the work themselves
+template <typename T, template <typename> class Traits, typename BinaryOp>
+T dispatch_reduce_op_serial(const T *A, size_t n, T identity, BinaryOp binary_op);
+
+template <typename T, typename AddOp, typename MulOp>
+T dispatch_dot_op_serial(const T *A, const T *B, size_t n, AddOp add_op, MulOp mul_op);
+
+
+namespace internal {
+    // fold_lanes: the lanes of an accumulator folded as a pairwise tree,
+    // which keeps the rounding error of a sum at O(log n) in the lane count
+    template <typename T, typename BinaryOp>
+    T fold_lanes(T *lanes, size_t count, BinaryOp binary_op) {
+        while (count > 1) {
+            const size_t half = (count + 1) / 2;
+            for (size_t k = 0; k + half < count; ++k)
+                lanes[k] = binary_op(lanes[k + half], lanes[k]);
+
+            count = half;
+        }
+
+        return lanes[0];
+    }
+
+    // two_sum: s becomes fl(s + x) and c gains the exact rounding error of
+    // that add (Knuth's TwoSum, which needs no ordering of |s| and |x|)
+    template <typename T>
+    void two_sum(T& s, T& c, T x) noexcept {
+        const T t = s + x;
+        const T z = t - s;
+        c += (s - (t - z)) + (x - z);
+        s = t;
+    }
+
+    // fold_compensated: lanes of sums and compensations as one pair
+    template <typename T>
+    std::pair<T, T> fold_compensated(const T *sums, const T *comps, size_t count) noexcept {
+        std::pair<T, T> result(T(0), T(0));
+        for (size_t k = 0; k < count; ++k) {
+            two_sum(result.first, result.second, sums[k]);
+            result.second += comps[k];
+        }
+
+        return result;
+    }
+
+    // combine_compensated: partial pairs merged by one more TwoSum
+    template <typename T>
+    std::pair<T, T> combine_compensated(const std::pair<T, T>& later, std::pair<T, T> earlier) noexcept {
+        two_sum(earlier.first, earlier.second, later.first);
+        earlier.second += later.second;
+        return earlier;
+    }
+
+    // compensated_total: sum + compensation. A sum that has reached inf or
+    // NaN leaves a NaN compensation behind and is the answer as it is
+    template <typename T>
+    T compensated_total(const std::pair<T, T>& result) noexcept {
+        return std::isfinite(result.first) ? result.first + result.second : result.first;
+    }
+
+    template <typename T>
+    struct moments {
+        size_t count = 0;
+        T mean = T(0);
+        T m2 = T(0);
+    };
+
+    // welford_update: one more element, by Welford's recurrence
+    template <typename T>
+    void welford_update(moments<T>& m, T x) noexcept {
+        ++m.count;
+        const T delta = x - m.mean;
+        m.mean += delta / static_cast<T>(m.count);
+        m.m2 += delta * (x - m.mean);
+    }
+
+    // merge_moments: the moments of two disjoint parts as one, by the
+    // pairwise formula of Chan, Golub and LeVeque
+    template <typename T>
+    moments<T> merge_moments(const moments<T>& a, const moments<T>& b) noexcept {
+        if (a.count == 0)
+            return b;
+        if (b.count == 0)
+            return a;
+
+        moments<T> result;
+        result.count = a.count + b.count;
+
+        const T delta = b.mean - a.mean;
+        const T weight = static_cast<T>(b.count) / static_cast<T>(result.count);
+        result.mean = a.mean + delta * weight;
+        result.m2 = a.m2 + b.m2 + delta * delta * static_cast<T>(a.count) * weight;
+
+        return result;
+    }
+
+    // the SIMD moment drivers take tiles of this many blocks per lane: a
+    // tile is summed, its squared deviations from its own mean are summed
+    // while it is still in L1, and it is merged into the running lanes by
+    // Chan's formula, so memory is read once and no lane divides per element
+    constexpr size_t moments_tile_blocks = 16;
+
+    // moments are merged as a balanced tree over leaves of this many
+    // elements (SIMD drivers) or of moments_plain_block (the scalar
+    // update), so no M2 is one long running sum
+    constexpr size_t moments_block = 1 << 14;
+    constexpr size_t moments_plain_block = 256;
+
+    // pairwise_moments: leaf(A, count) on the leaves of A, split on leaf
+    // boundaries
+    template <typename T, typename Leaf>
+    moments<T> pairwise_moments(const T *A, size_t n, size_t block, Leaf leaf) {
+        if (n <= block)
+            return leaf(A, n);
+
+        const size_t half = (n / 2 + block - 1) / block * block;
+        return merge_moments(pairwise_moments(A, half, block, leaf), pairwise_moments(A + half, n - half, block, leaf));
+    }
+}
+
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX2_BEGIN
+
+namespace internal {
+    // stores are aligned to the register width by peeling the head
+    constexpr size_t simd_alignment = 32;
+
+    // outputs at least this large bypass the cache with non-temporal stores;
+    // they would be evicted before anything reads them back anyway
+    constexpr size_t stream_min_bytes = static_cast<size_t>(1) << 22;
+
+    inline void stream_store(float *ptr, __m256 val) noexcept { _mm256_stream_ps(ptr, val); }
+
+    inline void stream_store(double *ptr, __m256d val) noexcept { _mm256_stream_pd(ptr, val); }
+
+    template <typename T>
+    inline void stream_store(T *ptr, __m256i val) noexcept {
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(ptr), val);
+    }
+
+    // has_stream_store: a stream_store overload takes what Traits::load
+    // returns; keyed on Traits so no vector type is a template argument
+    template <typename Traits, typename = void>
+    struct has_stream_store : std::false_type {};
+
+    template <typename Traits>
+    struct has_stream_store<Traits, std::void_t<decltype(stream_store(
+        std::declval<typename Traits::scalar_type *>(),
+        Traits::load(std::declval<const typename Traits::scalar_type *>())))>>
+        : std::true_type {};
+
+    // avx2_mask_io: maskload/maskstore for 32- and 64-bit lanes; AVX2 has no
+    // masked access to narrower lanes, which keep a scalar head and tail
+    template <typename T, typename = void>
+    struct avx2_mask_io;
+
+    template <>
+    struct avx2_mask_io<float> {
+        using simd_type = __m256;
+
+        static __m256i tail_mask(size_t n) noexcept {
+            return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        }
+
+        static simd_type load(const float *ptr, __m256i mask) noexcept {
+            return _mm256_maskload_ps(ptr, mask);
+        }
+
+        static void store(float *ptr, simd_type val, __m256i mask) noexcept {
+            _mm256_maskstore_ps(ptr, mask, val);
+        }
+    };
+
+    template <>
+    struct avx2_mask_io<double> {
+        using simd_type = __m256d;
+
+        static __m256i tail_mask(size_t n) noexcept {
+            return _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(n)), _mm256_setr_epi64x(0, 1, 2, 3));
+        }
+
+        static simd_type load(const double *ptr, __m256i mask) noexcept {
+            return _mm256_maskload_pd(ptr, mask);
+        }
+
+        static void store(double *ptr, simd_type val, __m256i mask) noexcept {
+            _mm256_maskstore_pd(ptr, mask, val);
+        }
+    };
+
+    template <typename T>
+    struct avx2_mask_io<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 4>> {
+        using simd_type = __m256i;
+
+        static __m256i tail_mask(size_t n) noexcept {
+            return avx2_mask_io<float>::tail_mask(n);
+        }
+
+        static simd_type load(const T *ptr, __m256i mask) noexcept {
+            return _mm256_maskload_epi32(reinterpret_cast<const int *>(ptr), mask);
+        }
+
+        static void store(T *ptr, simd_type val, __m256i mask) noexcept {
+            _mm256_maskstore_epi32(reinterpret_cast<int *>(ptr), mask, val);
+        }
+    };
+
+    template <typename T>
+    struct avx2_mask_io<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 8>> {
+        using simd_type = __m256i;
+
+        static __m256i tail_mask(size_t n) noexcept {
+            return avx2_mask_io<double>::tail_mask(n);
+        }
+
+        static simd_type load(const T *ptr, __m256i mask) noexcept {
+            return _mm256_maskload_epi64(reinterpret_cast<const long long *>(ptr), mask);
+        }
+
+        static void store(T *ptr, simd_type val, __m256i mask) noexcept {
+            _mm256_maskstore_epi64(reinterpret_cast<long long *>(ptr), mask, val);
+        }
+    };
+
+    // has_mask_io: Traits fills one 256-bit register with lanes avx2_mask_io
+    // can load and store. Decided from the lane type and count, since vector
+    // register types lose their attributes as template arguments
+    template <typename Traits, typename = void>
+    struct has_mask_io : std::false_type {};
+
+    template <typename Traits>
+    struct has_mask_io<Traits, std::enable_if_t<
+        sizeof(typename Traits::scalar_type) >= 4 && sizeof(typename Traits::simd_type) == 32
+        && Traits::step * sizeof(typename Traits::scalar_type) == 32>>
+        : std::true_type {};
+
+    // load_lanes: Traits::load, or a masked load of the active lanes only;
+    // traits on another register type get them through a zeroed buffer
+    template <typename Traits>
+    typename Traits::simd_type load_lanes(const typename Traits::scalar_type *ptr) noexcept {
+        return Traits::load(ptr);
+    }
+
+    template <typename Traits>
+    typename Traits::simd_type load_lanes(const typename Traits::scalar_type *ptr, __m256i mask) noexcept {
+        using io = avx2_mask_io<typename Traits::scalar_type>;
+
+        if constexpr (has_mask_io<Traits>::value) {
+            return io::load(ptr, mask);
+        } else {
+            typename Traits::scalar_type lanes[Traits::step] = {};
+            io::store(lanes, io::load(ptr, mask), mask);
+            return Traits::load(lanes);
+        }
+    }
+
+    // simd_loop: Traits::step lanes of vec_op(i) per store. With masked
+    // access the unaligned head and the tail are single blocks of
+    // vec_op(i, mask); otherwise they fall back to result[i] = scalar_op(i)
+    template <typename Traits, typename VecOp, typename ScalarOp>
+    void simd_loop(typename Traits::scalar_type *result, size_t n, VecOp vec_op, ScalarOp scalar_op) {
+        using T = typename Traits::scalar_type;
+        const size_t simd_step = Traits::step;
+
+        const uintptr_t address = reinterpret_cast<uintptr_t>(result);
+        size_t head = address % sizeof(T) != 0
+            ? 0 : (simd_alignment - address % simd_alignment) % simd_alignment / sizeof(T);
+        head = std::min(head, n);
+
+        size_t i = 0;
+        if constexpr (has_mask_io<Traits>::value) {
+            if (head != 0) {
+                const __m256i mask = avx2_mask_io<T>::tail_mask(head);
+                avx2_mask_io<T>::store(result, vec_op(0, mask), mask);
+                i = head;
+            }
+        } else {
+            for (; i < head; ++i)
+                result[i] = scalar_op(i);
+        }
+
+        if constexpr (has_stream_store<Traits>::value) {
+            if (n * sizeof(T) >= stream_min_bytes && reinterpret_cast<uintptr_t>(result + i) % simd_alignment == 0) {
+                for (; i + simd_step <= n; i += simd_step)
+                    stream_store(&result[i], vec_op(i));
+
+                _mm_sfence();
+            }
+        }
+
+        for (; i + simd_step <= n; i += simd_step)
+            Traits::store(&result[i], vec_op(i));
+
+        if constexpr (has_mask_io<Traits>::value) {
+            if (i < n) {
+                const __m256i mask = avx2_mask_io<T>::tail_mask(n - i);
+                avx2_mask_io<T>::store(&result[i], vec_op(i, mask), mask);
+            }
+        } else {
+            for (; i < n; ++i)
+                result[i] = scalar_op(i);
+        }
+    }
+}
+
+SIMD_TARGET_END
 #endif
 
+
 // implementation
 template <typename T, typename UnaryOp>
 std::vector<T> apply_unary_op_plain(const std::vector<T>& A, UnaryOp unary_op) {
     std::vector<T> result(A.size());
-    
-    for (size_t i = 0; i < A.size(); ++i)
-        result[i] = unary_op(A[i]);
+    apply_unary_op_plain(A.data(), result.data(), A.size(), unary_op);
 
     return result;
 }
@@ -40,9 +546,7 @@ std::vector<T> apply_unary_op_plain(const std::vector<T>& A, UnaryOp unary_op) {
 template <typename T, typename BinaryOp>
 std::vector<T> apply_binary_op_plain(const std::vector<T>& A, const std::vector<T>& B, BinaryOp binary_op) {
     std::vector<T> result(A.size());
-
-    for (size_t i = 0; i < A.size(); ++i)
-        result[i] = binary_op(A[i], B[i]);
+    apply_binary_op_plain(A.data(), B.data(), result.data(), A.size(), binary_op);
 
     return result;
 }
@@ -59,24 +563,96 @@ std::vector<std::vector<T>> apply_binary_op_plain(const std::vector<std::vector<
     return result;
 }
 
-#ifdef __AVX2__
+template <typename T, typename UnaryOp>
+void apply_unary_op_plain(const T *A, T *result, size_t n, UnaryOp unary_op) {
+    for (size_t i = 0; i < n; ++i)
+        result[i] = unary_op(A[i]);
+}
+
+template <typename T, typename BinaryOp>
+void apply_binary_op_plain(const T *A, const T *B, T *result, size_t n, BinaryOp binary_op) {
+    for (size_t i = 0; i < n; ++i)
+        result[i] = binary_op(A[i], B[i]);
+}
+
+template <typename T, typename BinaryOp>
+void apply_binary_op_plain(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n,
+                           BinaryOp binary_op) {
+    for (size_t i = 0; i < n; ++i)
+        result[i] = binary_op(A[i * inc_a], B[i * inc_b]);
+}
+
+template <typename T, typename UnaryOp>
+void apply_unary_op_plain_pair(const T *A, T *first, T *second, size_t n, UnaryOp unary_op) {
+    for (size_t i = 0; i < n; ++i) {
+        const auto values = unary_op(A[i]);
+        first[i] = static_cast<T>(values.first);
+        second[i] = static_cast<T>(values.second);
+    }
+}
+
+template <typename T, typename BinaryOp>
+T reduce_op_plain(const T *A, size_t n, T identity, BinaryOp binary_op) {
+    T result = identity;
+    for (size_t i = 0; i < n; ++i)
+        result = binary_op(A[i], result);
+
+    return result;
+}
+
+template <typename T>
+std::pair<T, T> sum_compensated_plain(const T *A, size_t n) {
+    std::pair<T, T> result(T(0), T(0));
+    for (size_t i = 0; i < n; ++i)
+        internal::two_sum(result.first, result.second, A[i]);
+
+    return result;
+}
+
+template <typename T>
+internal::moments<T> moments_op_plain(const T *A, size_t n) {
+    return internal::pairwise_moments(A, n, internal::moments_plain_block, [](const T *a, size_t count) {
+        internal::moments<T> result;
+        for (size_t i = 0; i < count; ++i)
+            internal::welford_update(result, a[i]);
+
+        return result;
+    });
+}
+
+template <typename T, typename AddOp, typename MulOp>
+T dot_op_plain(const T *A, const T *B, size_t n, AddOp add_op, MulOp mul_op) {
+    T result = T(0);
+    for (size_t i = 0; i < n; ++i)
+        result = add_op(mul_op(A[i], B[i]), result);
+
+    return result;
+}
+
+// the product only feeds the FMA and the TwoSum, never a bare add, so it
+// is not contracted into one
+template <typename T>
+std::pair<T, T> dot_compensated_plain(const T *A, const T *B, size_t n) {
+    std::pair<T, T> result(T(0), T(0));
+    for (size_t i = 0; i < n; ++i) {
+        const T p = A[i] * B[i];
+        result.second += std::fma(A[i], B[i], -p);
+        internal::two_sum(result.first, result.second, p);
+    }
+
+    return result;
+}
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX2_BEGIN
+
 template <typename T, typename Traits, typename UnaryOp>
 std::vector<T> apply_unary_op_simd(const std::vector<T>& A, UnaryOp unary_op) {
     if (A.empty())
         throw std::invalid_argument("Input vector can't be empty");
 
     std::vector<T> result(A.size());
-    size_t i;
-    const size_t simd_step = Traits::step;
-
-    for (i = 0; i <= A.size() - simd_step; i += simd_step) {
-        auto vec_a = Traits::load(&A[i]);
-        auto vec_result = Traits::op(vec_a);
-        Traits::store(&result[i], vec_result);
-    }
-
-    for (; i < A.size(); ++i)
-        result[i] = unary_op(A[i]);
+    apply_unary_op_simd<T, Traits>(A.data(), result.data(), A.size(), unary_op);
 
     return result;
 }
@@ -85,19 +661,9 @@ template <typename T, typename Traits, typename UnaryOp>
 std::vector<T> apply_unary_op_simd_shift(const std::vector<T>& A, const int imm8, UnaryOp unary_op) {
     if (A.empty())
     throw std::invalid_argument("Input vector can't be empty");
-    
-    std::vector<T> result(A.size());
-    size_t i;
-    const size_t simd_step = Traits::step;
-    
-    for (i = 0; i <= A.size() - simd_step; i += simd_step) {
-        auto vec_a = Traits::load(&A[i]);
-        auto vec_result = Traits::op(vec_a, imm8);
-        Traits::store(&result[i], vec_result);
-    }
 
-    for (; i < A.size(); ++i)
-        result[i] = unary_op(A[i]);
+    std::vector<T> result(A.size());
+    apply_unary_op_simd_shift<T, Traits>(A.data(), result.data(), A.size(), imm8, unary_op);
 
     return result;
 }
@@ -113,23 +679,1037 @@ std::vector<T> apply_binary_op_simd(const std::vector<T>& A,
         throw std::invalid_argument("Input vectors must be of the same size.");
 
     std::vector<T> result(A.size());
-    size_t i;
+    apply_binary_op_simd<T, Traits>(A.data(), B.data(), result.data(), A.size(), binary_op);
+
+    return result;
+}
+
+template <typename T, typename Traits, typename UnaryOp>
+void apply_unary_op_simd(const T *A, T *result, size_t n, UnaryOp unary_op) {
+    internal::simd_loop<Traits>(result, n,
+        [&](size_t i, auto... mask) { return Traits::op(internal::load_lanes<Traits>(&A[i], mask...)); },
+        [&](size_t i) { return unary_op(A[i]); });
+}
+
+template <typename T, typename Traits, typename UnaryOp>
+void apply_unary_op_simd_shift(const T *A, T *result, size_t n, const int imm8, UnaryOp unary_op) {
+    internal::simd_loop<Traits>(result, n,
+        [&](size_t i, auto... mask) { return Traits::op(internal::load_lanes<Traits>(&A[i], mask...), imm8); },
+        [&](size_t i) { return unary_op(A[i]); });
+}
+
+// the tail runs through a zero-padded lane buffer rather than a scalar op,
+// so every element gets the same vector rounding wherever it sits
+template <typename T, typename Traits>
+void apply_unary_op_simd_pair(const T *A, T *first, T *second, size_t n) {
     const size_t simd_step = Traits::step;
 
-    for (i = 0; i <= A.size() - simd_step; i += simd_step) {
-        auto vec_a = Traits::load(&A[i]);
-        auto vec_b = Traits::load(&B[i]);
-        auto vec_result = Traits::op(vec_a, vec_b);
-        Traits::store(&result[i], vec_result);
+    size_t i = 0;
+    for (; i + simd_step <= n; i += simd_step) {
+        const auto values = Traits::op(Traits::load(&A[i]));
+        Traits::store(&first[i], values.first);
+        Traits::store(&second[i], values.second);
     }
 
-    for (; i < A.size(); ++i)
-        result[i] = binary_op(A[i], B[i]);
+    if (i < n) {
+        T lanes[Traits::step] = {}, first_lanes[Traits::step], second_lanes[Traits::step];
+        std::copy(A + i, A + n, lanes);
+
+        const auto values = Traits::op(Traits::load(lanes));
+        Traits::store(first_lanes, values.first);
+        Traits::store(second_lanes, values.second);
+
+        std::copy(first_lanes, first_lanes + (n - i), first + i);
+        std::copy(second_lanes, second_lanes + (n - i), second + i);
+    }
+}
+
+template <typename T, typename Traits, typename BinaryOp>
+void apply_binary_op_simd(const T *A, const T *B, T *result, size_t n, BinaryOp binary_op) {
+    internal::simd_loop<Traits>(result, n,
+        [&](size_t i, auto... mask) {
+            return Traits::op(internal::load_lanes<Traits>(&A[i], mask...), internal::load_lanes<Traits>(&B[i], mask...));
+        },
+        [&](size_t i) { return binary_op(A[i], B[i]); });
+}
+
+template <typename T, typename Traits, typename BinaryOp>
+void apply_binary_op_simd(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n,
+                          BinaryOp binary_op) {
+    // a repeated operand is splatted into a register once, outside the loop
+    T lanes[Traits::step];
+    std::fill(lanes, lanes + Traits::step, inc_a == 0 ? A[0] : B[0]);
+    const auto vec_splat = Traits::load(lanes);
+
+    internal::simd_loop<Traits>(result, n,
+        [&](size_t i, auto... mask) {
+            auto vec_a = inc_a == 0 ? vec_splat : internal::load_lanes<Traits>(&A[i], mask...);
+            auto vec_b = inc_b == 0 ? vec_splat : internal::load_lanes<Traits>(&B[i], mask...);
+            return Traits::op(vec_a, vec_b);
+        },
+        [&](size_t i) { return binary_op(A[i * inc_a], B[i * inc_b]); });
+}
+
+// four independent accumulators keep that many ops in flight; the tail is
+// one more block padded with identity
+template <typename T, typename Traits, typename BinaryOp>
+T reduce_op_simd(const T *A, size_t n, T identity, BinaryOp binary_op) {
+    constexpr size_t step = Traits::step;
+
+    T lanes[step];
+    std::fill(lanes, lanes + step, identity);
+    auto acc0 = Traits::load(lanes), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+    size_t i = 0;
+    for (; i + 4 * step <= n; i += 4 * step) {
+        acc0 = Traits::op(Traits::load(&A[i]), acc0);
+        acc1 = Traits::op(Traits::load(&A[i + step]), acc1);
+        acc2 = Traits::op(Traits::load(&A[i + 2 * step]), acc2);
+        acc3 = Traits::op(Traits::load(&A[i + 3 * step]), acc3);
+    }
+
+    for (; i + step <= n; i += step)
+        acc0 = Traits::op(Traits::load(&A[i]), acc0);
+
+    if (i < n) {
+        std::copy(A + i, A + n, lanes);
+        acc1 = Traits::op(Traits::load(lanes), acc1);
+    }
+
+    Traits::store(lanes, Traits::op(Traits::op(acc1, acc0), Traits::op(acc3, acc2)));
+    return internal::fold_lanes(lanes, step, binary_op);
+}
+
+// four pairs of sum and compensation registers, one TwoSum per block; the
+// tail is padded with zeros, which add no error
+template <typename T, typename Add, typename Sub>
+std::pair<T, T> sum_compensated_simd(const T *A, size_t n) {
+    using simd_type = typename Add::simd_type;
+    constexpr size_t step = Add::step;
+
+    auto two_sum = [](simd_type& s, simd_type& c, simd_type x) {
+        const simd_type t = Add::op(s, x);
+        const simd_type z = Sub::op(t, s);
+        c = Add::op(c, Add::op(Sub::op(s, Sub::op(t, z)), Sub::op(x, z)));
+        s = t;
+    };
+
+    T sums[4 * step] = {}, comps[4 * step];
+    simd_type s0 = Add::load(sums), s1 = s0, s2 = s0, s3 = s0;
+    simd_type c0 = s0, c1 = s0, c2 = s0, c3 = s0;
+
+    size_t i = 0;
+    for (; i + 4 * step <= n; i += 4 * step) {
+        two_sum(s0, c0, Add::load(&A[i]));
+        two_sum(s1, c1, Add::load(&A[i + step]));
+        two_sum(s2, c2, Add::load(&A[i + 2 * step]));
+        two_sum(s3, c3, Add::load(&A[i + 3 * step]));
+    }
+
+    for (; i + step <= n; i += step)
+        two_sum(s0, c0, Add::load(&A[i]));
+
+    if (i < n) {
+        std::copy(A + i, A + n, sums);
+        two_sum(s1, c1, Add::load(sums));
+    }
+
+    Add::store(sums, s0);
+    Add::store(sums + step, s1);
+    Add::store(sums + 2 * step, s2);
+    Add::store(sums + 3 * step, s3);
+    Add::store(comps, c0);
+    Add::store(comps + step, c1);
+    Add::store(comps + 2 * step, c2);
+    Add::store(comps + 3 * step, c3);
+
+    return internal::fold_compensated(sums, comps, 4 * step);
+}
+
+// four FMA accumulators, each reduced by horizontal_sum
+template <typename T, typename Traits>
+T dot_op_simd(const T *A, const T *B, size_t n) {
+    constexpr size_t step = Traits::step;
+
+    auto acc0 = Traits::zero(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+    size_t i = 0;
+    for (; i + 4 * step <= n; i += 4 * step) {
+        acc0 = Traits::mul_add(Traits::load(&A[i]), Traits::load(&B[i]), acc0);
+        acc1 = Traits::mul_add(Traits::load(&A[i + step]), Traits::load(&B[i + step]), acc1);
+        acc2 = Traits::mul_add(Traits::load(&A[i + 2 * step]), Traits::load(&B[i + 2 * step]), acc2);
+        acc3 = Traits::mul_add(Traits::load(&A[i + 3 * step]), Traits::load(&B[i + 3 * step]), acc3);
+    }
+
+    for (; i + step <= n; i += step)
+        acc0 = Traits::mul_add(Traits::load(&A[i]), Traits::load(&B[i]), acc0);
+
+    if (i < n) {
+        T a[step] = {}, b[step] = {};
+        std::copy(A + i, A + n, a);
+        std::copy(B + i, B + n, b);
+        acc1 = Traits::mul_add(Traits::load(a), Traits::load(b), acc1);
+    }
+
+    return (Traits::horizontal_sum(acc0) + Traits::horizontal_sum(acc1))
+         + (Traits::horizontal_sum(acc2) + Traits::horizontal_sum(acc3));
+}
+
+// Dot2 of Ogita, Rump and Oishi: the product is rounded through an FMA
+// with zero, so it cannot be contracted into the TwoSum that follows, and
+// a second FMA recovers its exact error
+template <typename T, typename Inner, typename Add, typename Sub>
+std::pair<T, T> dot_compensated_simd(const T *A, const T *B, size_t n) {
+    using simd_type = typename Inner::simd_type;
+    constexpr size_t step = Inner::step;
+    const simd_type zero = Inner::zero();
+
+    auto dot2 = [zero](simd_type& s, simd_type& c, simd_type a, simd_type b) {
+        const simd_type p = Inner::mul_add(a, b, zero);
+        const simd_type e = Inner::mul_add(a, b, Sub::op(zero, p));
+        const simd_type t = Add::op(s, p);
+        const simd_type z = Sub::op(t, s);
+        c = Add::op(c, Add::op(e, Add::op(Sub::op(s, Sub::op(t, z)), Sub::op(p, z))));
+        s = t;
+    };
+
+    simd_type s0 = zero, s1 = zero, c0 = zero, c1 = zero;
+
+    size_t i = 0;
+    for (; i + 2 * step <= n; i += 2 * step) {
+        dot2(s0, c0, Inner::load(&A[i]), Inner::load(&B[i]));
+        dot2(s1, c1, Inner::load(&A[i + step]), Inner::load(&B[i + step]));
+    }
+
+    for (; i + step <= n; i += step)
+        dot2(s0, c0, Inner::load(&A[i]), Inner::load(&B[i]));
+
+    if (i < n) {
+        T a[step] = {}, b[step] = {};
+        std::copy(A + i, A + n, a);
+        std::copy(B + i, B + n, b);
+        dot2(s1, c1, Inner::load(a), Inner::load(b));
+    }
+
+    T sums[2 * step], comps[2 * step];
+    Add::store(sums, s0);
+    Add::store(sums + step, s1);
+    Add::store(comps, c0);
+    Add::store(comps + step, c1);
+
+    return internal::fold_compensated(sums, comps, 2 * step);
+}
+
+// four registers of lanes in tiles of moments_tile_blocks blocks; the lanes
+// are merged at the end and the rest of A goes through welford_update
+template <typename T, typename Add, typename Sub, typename Mul>
+internal::moments<T> moments_op_simd(const T *A, size_t n) {
+    using simd_type = typename Add::simd_type;
+    constexpr size_t step = Add::step;
+    constexpr size_t blocks = internal::moments_tile_blocks;
+    constexpr size_t tile = 4 * step * blocks;
+
+    T buffer[4 * step] = {};
+    const simd_type zero = Add::load(buffer);
+    auto splat = [&buffer](T x) {
+        std::fill(buffer, buffer + step, x);
+        return Add::load(buffer);
+    };
+
+    simd_type mean[4] = {zero, zero, zero, zero}, m2[4] = {zero, zero, zero, zero};
+
+    size_t tiles = 0, i = 0;
+    for (; i + tile <= n; i += tile, ++tiles) {
+        const T *a = A + i;
+
+        simd_type tile_mean[4] = {zero, zero, zero, zero}, tile_m2[4] = {zero, zero, zero, zero};
+        for (size_t b = 0; b < blocks; ++b)
+            for (size_t r = 0; r < 4; ++r)
+                tile_mean[r] = Add::op(tile_mean[r], Add::load(a + (4 * b + r) * step));
+
+        const simd_type scale = splat(T(1) / T(blocks));
+        for (size_t r = 0; r < 4; ++r)
+            tile_mean[r] = Mul::op(tile_mean[r], scale);
+
+        for (size_t b = 0; b < blocks; ++b) {
+            for (size_t r = 0; r < 4; ++r) {
+                const simd_type d = Sub::op(Add::load(a + (4 * b + r) * step), tile_mean[r]);
+                tile_m2[r] = Add::op(tile_m2[r], Mul::op(d, d));
+            }
+        }
+
+        // the running lanes hold tiles * blocks elements, the new tile blocks
+        const simd_type weight = splat(T(1) / T(tiles + 1));
+        const simd_type spread = splat(T(blocks) * T(tiles) / T(tiles + 1));
+        for (size_t r = 0; r < 4; ++r) {
+            const simd_type delta = Sub::op(tile_mean[r], mean[r]);
+            mean[r] = Add::op(mean[r], Mul::op(delta, weight));
+            m2[r] = Add::op(Add::op(m2[r], tile_m2[r]), Mul::op(Mul::op(delta, delta), spread));
+        }
+    }
+
+    internal::moments<T> result;
+    if (tiles > 0) {
+        T means[4 * step], m2s[4 * step];
+        for (size_t r = 0; r < 4; ++r) {
+            Add::store(means + r * step, mean[r]);
+            Add::store(m2s + r * step, m2[r]);
+        }
+
+        for (size_t k = 0; k < 4 * step; ++k) {
+            internal::moments<T> lane;
+            lane.count = tiles * blocks;
+            lane.mean = means[k];
+            lane.m2 = m2s[k];
+            result = internal::merge_moments(result, lane);
+        }
+    }
+
+    for (; i < n; ++i)
+        internal::welford_update(result, A[i]);
+
+    return result;
+}
+
+SIMD_TARGET_END
+#endif
+
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX512_BEGIN
+
+namespace internal {
+    inline void stream_store(float *ptr, __m512 val) noexcept { _mm512_stream_ps(ptr, val); }
+
+    inline void stream_store(double *ptr, __m512d val) noexcept { _mm512_stream_pd(ptr, val); }
+
+    template <typename T>
+    inline void stream_store(T *ptr, __m512i val) noexcept {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(ptr), val);
+    }
+
+    // simd_loop_avx512: result[i] for Traits::step lanes of vec_op(i) per
+    // store; the unaligned head and the tail are single masked blocks of
+    // vec_op(i, mask), whose inactive lanes are neither read nor written
+    template <typename Traits, typename VecOp>
+    void simd_loop_avx512(typename Traits::scalar_type *result, size_t n, VecOp vec_op) {
+        using T = typename Traits::scalar_type;
+        constexpr size_t simd_step = Traits::step;
+        constexpr size_t alignment = sizeof(typename Traits::simd_type);
+
+        const uintptr_t address = reinterpret_cast<uintptr_t>(result);
+        size_t i = 0;
+
+        if (address % sizeof(T) == 0) {
+            const size_t head = std::min((alignment - address % alignment) % alignment / sizeof(T), n);
+            if (head != 0) {
+                const auto mask = Traits::tail_mask(head);
+                Traits::store(result, vec_op(0, mask), mask);
+                i = head;
+            }
+        }
+
+        if (n * sizeof(T) >= stream_min_bytes && reinterpret_cast<uintptr_t>(result + i) % alignment == 0) {
+            for (; i + simd_step <= n; i += simd_step)
+                stream_store(&result[i], vec_op(i));
+
+            _mm_sfence();
+        }
+
+        for (; i + simd_step <= n; i += simd_step)
+            Traits::store(&result[i], vec_op(i));
+
+        if (i < n) {
+            const auto mask = Traits::tail_mask(n - i);
+            Traits::store(&result[i], vec_op(i, mask), mask);
+        }
+    }
+}
+
+template <typename T, typename Traits>
+void apply_unary_op_avx512(const T *A, T *result, size_t n) {
+    internal::simd_loop_avx512<Traits>(result, n,
+        [&](size_t i, auto... mask) { return Traits::op(Traits::load(&A[i], mask...)); });
+}
+
+template <typename T, typename Traits>
+void apply_unary_op_avx512_shift(const T *A, T *result, size_t n, const int imm8) {
+    internal::simd_loop_avx512<Traits>(result, n,
+        [&](size_t i, auto... mask) { return Traits::op(Traits::load(&A[i], mask...), imm8); });
+}
+
+// the tail is one masked block, so every element gets the same vector rounding
+template <typename T, typename Traits>
+void apply_unary_op_avx512_pair(const T *A, T *first, T *second, size_t n) {
+    const size_t simd_step = Traits::step;
+
+    size_t i = 0;
+    for (; i + simd_step <= n; i += simd_step) {
+        const auto values = Traits::op(Traits::load(&A[i]));
+        Traits::store(&first[i], values.first);
+        Traits::store(&second[i], values.second);
+    }
+
+    if (i < n) {
+        const auto mask = Traits::tail_mask(n - i);
+        const auto values = Traits::op(Traits::load(&A[i], mask));
+        Traits::store(&first[i], values.first, mask);
+        Traits::store(&second[i], values.second, mask);
+    }
+}
+
+template <typename T, typename Traits>
+void apply_binary_op_avx512(const T *A, const T *B, T *result, size_t n) {
+    internal::simd_loop_avx512<Traits>(result, n,
+        [&](size_t i, auto... mask) { return Traits::op(Traits::load(&A[i], mask...), Traits::load(&B[i], mask...)); });
+}
+
+template <typename T, typename Traits>
+void apply_binary_op_avx512(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n) {
+    T lanes[Traits::step];
+    std::fill(lanes, lanes + Traits::step, inc_a == 0 ? A[0] : B[0]);
+    const auto vec_splat = Traits::load(lanes);
+
+    internal::simd_loop_avx512<Traits>(result, n,
+        [&](size_t i, auto... mask) {
+            auto vec_a = inc_a == 0 ? vec_splat : Traits::load(&A[i], mask...);
+            auto vec_b = inc_b == 0 ? vec_splat : Traits::load(&B[i], mask...);
+            return Traits::op(vec_a, vec_b);
+        });
+}
+
+// as reduce_op_simd, on 512-bit accumulators
+template <typename T, typename Traits, typename BinaryOp>
+T reduce_op_avx512(const T *A, size_t n, T identity, BinaryOp binary_op) {
+    constexpr size_t step = Traits::step;
+
+    T lanes[step];
+    std::fill(lanes, lanes + step, identity);
+    auto acc0 = Traits::load(lanes), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+    size_t i = 0;
+    for (; i + 4 * step <= n; i += 4 * step) {
+        acc0 = Traits::op(Traits::load(&A[i]), acc0);
+        acc1 = Traits::op(Traits::load(&A[i + step]), acc1);
+        acc2 = Traits::op(Traits::load(&A[i + 2 * step]), acc2);
+        acc3 = Traits::op(Traits::load(&A[i + 3 * step]), acc3);
+    }
+
+    for (; i + step <= n; i += step)
+        acc0 = Traits::op(Traits::load(&A[i]), acc0);
+
+    if (i < n) {
+        std::copy(A + i, A + n, lanes);
+        acc1 = Traits::op(Traits::load(lanes), acc1);
+    }
+
+    Traits::store(lanes, Traits::op(Traits::op(acc1, acc0), Traits::op(acc3, acc2)));
+    return internal::fold_lanes(lanes, step, binary_op);
+}
+
+// as sum_compensated_simd, on 512-bit registers
+template <typename T, typename Add, typename Sub>
+std::pair<T, T> sum_compensated_avx512(const T *A, size_t n) {
+    using simd_type = typename Add::simd_type;
+    constexpr size_t step = Add::step;
+
+    auto two_sum = [](simd_type& s, simd_type& c, simd_type x) {
+        const simd_type t = Add::op(s, x);
+        const simd_type z = Sub::op(t, s);
+        c = Add::op(c, Add::op(Sub::op(s, Sub::op(t, z)), Sub::op(x, z)));
+        s = t;
+    };
+
+    T sums[4 * step] = {}, comps[4 * step];
+    simd_type s0 = Add::load(sums), s1 = s0, s2 = s0, s3 = s0;
+    simd_type c0 = s0, c1 = s0, c2 = s0, c3 = s0;
+
+    size_t i = 0;
+    for (; i + 4 * step <= n; i += 4 * step) {
+        two_sum(s0, c0, Add::load(&A[i]));
+        two_sum(s1, c1, Add::load(&A[i + step]));
+        two_sum(s2, c2, Add::load(&A[i + 2 * step]));
+        two_sum(s3, c3, Add::load(&A[i + 3 * step]));
+    }
+
+    for (; i + step <= n; i += step)
+        two_sum(s0, c0, Add::load(&A[i]));
+
+    if (i < n) {
+        std::copy(A + i, A + n, sums);
+        two_sum(s1, c1, Add::load(sums));
+    }
+
+    Add::store(sums, s0);
+    Add::store(sums + step, s1);
+    Add::store(sums + 2 * step, s2);
+    Add::store(sums + 3 * step, s3);
+    Add::store(comps, c0);
+    Add::store(comps + step, c1);
+    Add::store(comps + 2 * step, c2);
+    Add::store(comps + 3 * step, c3);
+
+    return internal::fold_compensated(sums, comps, 4 * step);
+}
+
+// as moments_op_simd, on 512-bit registers
+template <typename T, typename Add, typename Sub, typename Mul>
+internal::moments<T> moments_op_avx512(const T *A, size_t n) {
+    using simd_type = typename Add::simd_type;
+    constexpr size_t step = Add::step;
+    constexpr size_t blocks = internal::moments_tile_blocks;
+    constexpr size_t tile = 4 * step * blocks;
+
+    T buffer[4 * step] = {};
+    const simd_type zero = Add::load(buffer);
+    auto splat = [&buffer](T x) {
+        std::fill(buffer, buffer + step, x);
+        return Add::load(buffer);
+    };
+
+    simd_type mean[4] = {zero, zero, zero, zero}, m2[4] = {zero, zero, zero, zero};
+
+    size_t tiles = 0, i = 0;
+    for (; i + tile <= n; i += tile, ++tiles) {
+        const T *a = A + i;
+
+        simd_type tile_mean[4] = {zero, zero, zero, zero}, tile_m2[4] = {zero, zero, zero, zero};
+        for (size_t b = 0; b < blocks; ++b)
+            for (size_t r = 0; r < 4; ++r)
+                tile_mean[r] = Add::op(tile_mean[r], Add::load(a + (4 * b + r) * step));
+
+        const simd_type scale = splat(T(1) / T(blocks));
+        for (size_t r = 0; r < 4; ++r)
+            tile_mean[r] = Mul::op(tile_mean[r], scale);
+
+        for (size_t b = 0; b < blocks; ++b) {
+            for (size_t r = 0; r < 4; ++r) {
+                const simd_type d = Sub::op(Add::load(a + (4 * b + r) * step), tile_mean[r]);
+                tile_m2[r] = Add::op(tile_m2[r], Mul::op(d, d));
+            }
+        }
+
+        // the running lanes hold tiles * blocks elements, the new tile blocks
+        const simd_type weight = splat(T(1) / T(tiles + 1));
+        const simd_type spread = splat(T(blocks) * T(tiles) / T(tiles + 1));
+        for (size_t r = 0; r < 4; ++r) {
+            const simd_type delta = Sub::op(tile_mean[r], mean[r]);
+            mean[r] = Add::op(mean[r], Mul::op(delta, weight));
+            m2[r] = Add::op(Add::op(m2[r], tile_m2[r]), Mul::op(Mul::op(delta, delta), spread));
+        }
+    }
+
+    internal::moments<T> result;
+    if (tiles > 0) {
+        T means[4 * step], m2s[4 * step];
+        for (size_t r = 0; r < 4; ++r) {
+            Add::store(means + r * step, mean[r]);
+            Add::store(m2s + r * step, m2[r]);
+        }
+
+        for (size_t k = 0; k < 4 * step; ++k) {
+            internal::moments<T> lane;
+            lane.count = tiles * blocks;
+            lane.mean = means[k];
+            lane.m2 = m2s[k];
+            result = internal::merge_moments(result, lane);
+        }
+    }
+
+    for (; i < n; ++i)
+        internal::welford_update(result, A[i]);
 
     return result;
 }
 
+SIMD_TARGET_END
 #endif
 
 
+#if SIMD_HAS_RVV
+template <typename T, typename Traits>
+void apply_unary_op_rvv(const T *A, T *result, size_t n) {
+    for (size_t i = 0, vl; i < n; i += vl) {
+        vl = Traits::setvl(n - i);
+        Traits::store(&result[i], Traits::op(Traits::load(&A[i], vl), vl), vl);
+    }
+}
+
+template <typename T, typename Traits>
+void apply_unary_op_rvv_shift(const T *A, T *result, size_t n, const int imm8) {
+    for (size_t i = 0, vl; i < n; i += vl) {
+        vl = Traits::setvl(n - i);
+        Traits::store(&result[i], Traits::op(Traits::load(&A[i], vl), imm8, vl), vl);
+    }
+}
+
+template <typename T, typename Traits>
+void apply_binary_op_rvv(const T *A, const T *B, T *result, size_t n) {
+    for (size_t i = 0, vl; i < n; i += vl) {
+        vl = Traits::setvl(n - i);
+        Traits::store(&result[i], Traits::op(Traits::load(&A[i], vl), Traits::load(&B[i], vl), vl), vl);
+    }
+}
+
+template <typename T, typename Traits>
+void apply_binary_op_rvv(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n) {
+    for (size_t i = 0, vl; i < n; i += vl) {
+        vl = Traits::setvl(n - i);
+        auto vec_a = inc_a == 0 ? Traits::splat(A[0], vl) : Traits::load(&A[i], vl);
+        auto vec_b = inc_b == 0 ? Traits::splat(B[0], vl) : Traits::load(&B[i], vl);
+        Traits::store(&result[i], Traits::op(vec_a, vec_b, vl), vl);
+    }
+}
+
+// whole registers only: a shorter vl would leave the accumulator's tail
+// lanes undefined, so the last partial register is folded in scalar
+template <typename T, typename Traits, typename BinaryOp>
+T reduce_op_rvv(const T *A, size_t n, T identity, BinaryOp binary_op) {
+    const size_t vlmax = Traits::setvl(n);
+    if (vlmax == 0)
+        return identity;
+
+    auto acc = Traits::splat(identity, vlmax);
+    size_t i = 0;
+    for (; i + vlmax <= n; i += vlmax)
+        acc = Traits::op(Traits::load(&A[i], vlmax), acc, vlmax);
+
+    std::vector<T> lanes(vlmax);
+    Traits::store(lanes.data(), acc, vlmax);
+
+    T result = internal::fold_lanes(lanes.data(), vlmax, binary_op);
+    for (; i < n; ++i)
+        result = binary_op(A[i], result);
+
+    return result;
+}
+
+// whole registers as reduce_op_rvv, then TwoSum in scalar for the rest
+template <typename T, typename Add, typename Sub>
+std::pair<T, T> sum_compensated_rvv(const T *A, size_t n) {
+    const size_t vlmax = Add::setvl(n);
+    if (vlmax == 0)
+        return std::pair<T, T>(T(0), T(0));
+
+    auto s = Add::splat(T(0), vlmax), c = s;
+    size_t i = 0;
+    for (; i + vlmax <= n; i += vlmax) {
+        const auto x = Add::load(&A[i], vlmax);
+        const auto t = Add::op(s, x, vlmax);
+        const auto z = Sub::op(t, s, vlmax);
+        const auto e = Add::op(Sub::op(s, Sub::op(t, z, vlmax), vlmax), Sub::op(x, z, vlmax), vlmax);
+        c = Add::op(c, e, vlmax);
+        s = t;
+    }
+
+    std::vector<T> sums(vlmax), comps(vlmax);
+    Add::store(sums.data(), s, vlmax);
+    Add::store(comps.data(), c, vlmax);
+
+    auto result = internal::fold_compensated(sums.data(), comps.data(), vlmax);
+    for (; i < n; ++i)
+        internal::two_sum(result.first, result.second, A[i]);
+
+    return result;
+}
+
+// as moments_op_simd with one register group of vlmax lanes
+template <typename T, typename Add, typename Sub, typename Mul>
+internal::moments<T> moments_op_rvv(const T *A, size_t n) {
+    constexpr size_t blocks = internal::moments_tile_blocks;
+    const size_t vlmax = Add::setvl(n);
+    if (vlmax == 0)
+        return internal::moments<T>();
+
+    const size_t tile = vlmax * blocks;
+    auto mean = Add::splat(T(0), vlmax), m2 = mean;
+
+    size_t tiles = 0, i = 0;
+    for (; i + tile <= n; i += tile, ++tiles) {
+        const T *a = A + i;
+
+        auto tile_mean = Add::splat(T(0), vlmax), tile_m2 = tile_mean;
+        for (size_t b = 0; b < blocks; ++b)
+            tile_mean = Add::op(tile_mean, Add::load(a + b * vlmax, vlmax), vlmax);
+
+        tile_mean = Mul::op(tile_mean, Add::splat(T(1) / T(blocks), vlmax), vlmax);
+        for (size_t b = 0; b < blocks; ++b) {
+            const auto d = Sub::op(Add::load(a + b * vlmax, vlmax), tile_mean, vlmax);
+            tile_m2 = Add::op(tile_m2, Mul::op(d, d, vlmax), vlmax);
+        }
+
+        const auto delta = Sub::op(tile_mean, mean, vlmax);
+        const auto spread = Add::splat(T(blocks) * T(tiles) / T(tiles + 1), vlmax);
+        mean = Add::op(mean, Mul::op(delta, Add::splat(T(1) / T(tiles + 1), vlmax), vlmax), vlmax);
+        m2 = Add::op(Add::op(m2, tile_m2, vlmax), Mul::op(Mul::op(delta, delta, vlmax), spread, vlmax), vlmax);
+    }
+
+    internal::moments<T> result;
+    if (tiles > 0) {
+        std::vector<T> means(vlmax), m2s(vlmax);
+        Add::store(means.data(), mean, vlmax);
+        Add::store(m2s.data(), m2, vlmax);
+
+        for (size_t k = 0; k < vlmax; ++k) {
+            internal::moments<T> lane;
+            lane.count = tiles * blocks;
+            lane.mean = means[k];
+            lane.m2 = m2s[k];
+            result = internal::merge_moments(result, lane);
+        }
+    }
+
+    for (; i < n; ++i)
+        internal::welford_update(result, A[i]);
+
+    return result;
+}
+#endif
+
+
+namespace internal {
+    // has_simd_traits: true when a trait specialisation exists for T
+    template <typename Traits, typename = void>
+    struct has_simd_traits : std::false_type {};
+
+    template <typename Traits>
+    struct has_simd_traits<Traits, std::void_t<decltype(sizeof(Traits))>> : std::true_type {};
+
+    // below this length the scalar head and tail of the SIMD loop cost more
+    // than it saves
+    constexpr size_t simd_min_size = 32;
+
+    #if SIMD_HAS_AVX2
+    // use_avx2: traits with masked access are vectorised at any length
+    template <typename Traits>
+    bool use_avx2(size_t n) noexcept {
+        return (has_mask_io<Traits>::value || n >= simd_min_size) && simd_level_at_least(simd_level::avx2);
+    }
+    #endif
+}
+
+// each thread runs the serial driver on its own chunk
+template <typename T, template <typename> class Traits, typename UnaryOp>
+void dispatch_unary_op(const T *A, T *result, size_t n, UnaryOp unary_op) {
+    internal::parallel_chunks<T>(n, [&](size_t begin, size_t end) {
+        #if SIMD_HAS_AVX2
+            using Wide = internal::avx512_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Wide>::value) {
+                if (internal::simd_level_at_least(simd_level::avx512)) {
+                    apply_unary_op_avx512<T, Wide>(A + begin, result + begin, end - begin);
+                    return;
+                }
+            }
+
+            if constexpr (internal::has_simd_traits<Traits<T>>::value) {
+                if (internal::use_avx2<Traits<T>>(end - begin)) {
+                    apply_unary_op_simd<T, Traits<T>>(A + begin, result + begin, end - begin, unary_op);
+                    return;
+                }
+            }
+        #endif
+
+        #if SIMD_HAS_RVV
+            using Vector = internal::rvv_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Vector>::value) {
+                if (internal::simd_level_at_least(simd_level::rvv)) {
+                    apply_unary_op_rvv<T, Vector>(A + begin, result + begin, end - begin);
+                    return;
+                }
+            }
+        #endif
+
+        apply_unary_op_plain(A + begin, result + begin, end - begin, unary_op);
+    });
+}
+
+template <typename T, template <typename> class Traits, typename UnaryOp>
+void dispatch_unary_op_shift(const T *A, T *result, size_t n, const int imm8, UnaryOp unary_op) {
+    internal::parallel_chunks<T>(n, [&](size_t begin, size_t end) {
+        #if SIMD_HAS_AVX2
+            using Wide = internal::avx512_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Wide>::value) {
+                if (internal::simd_level_at_least(simd_level::avx512)) {
+                    apply_unary_op_avx512_shift<T, Wide>(A + begin, result + begin, end - begin, imm8);
+                    return;
+                }
+            }
+
+            if constexpr (internal::has_simd_traits<Traits<T>>::value) {
+                if (internal::use_avx2<Traits<T>>(end - begin)) {
+                    apply_unary_op_simd_shift<T, Traits<T>>(A + begin, result + begin, end - begin, imm8, unary_op);
+                    return;
+                }
+            }
+        #endif
+
+        #if SIMD_HAS_RVV
+            using Vector = internal::rvv_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Vector>::value) {
+                if (internal::simd_level_at_least(simd_level::rvv)) {
+                    apply_unary_op_rvv_shift<T, Vector>(A + begin, result + begin, end - begin, imm8);
+                    return;
+                }
+            }
+        #endif
+
+        apply_unary_op_plain(A + begin, result + begin, end - begin, unary_op);
+    });
+}
+
+// pair ops only come from xsimd, so there is no RVV driver
+template <typename T, template <typename> class Traits, typename UnaryOp>
+void dispatch_unary_op_pair(const T *A, T *first, T *second, size_t n, UnaryOp unary_op) {
+    internal::parallel_chunks<T>(n, [&](size_t begin, size_t end) {
+        #if SIMD_HAS_AVX2
+            using Wide = internal::avx512_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Wide>::value) {
+                if (internal::simd_level_at_least(simd_level::avx512)) {
+                    apply_unary_op_avx512_pair<T, Wide>(A + begin, first + begin, second + begin, end - begin);
+                    return;
+                }
+            }
+
+            if constexpr (internal::has_simd_traits<Traits<T>>::value) {
+                if (internal::use_avx2<Traits<T>>(end - begin)) {
+                    apply_unary_op_simd_pair<T, Traits<T>>(A + begin, first + begin, second + begin, end - begin);
+                    return;
+                }
+            }
+        #endif
+
+        apply_unary_op_plain_pair(A + begin, first + begin, second + begin, end - begin, unary_op);
+    });
+}
+
+template <typename T, template <typename> class Traits, typename BinaryOp>
+void dispatch_binary_op(const T *A, const T *B, T *result, size_t n, BinaryOp binary_op) {
+    internal::parallel_chunks<T>(n, [&](size_t begin, size_t end) {
+        #if SIMD_HAS_AVX2
+            using Wide = internal::avx512_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Wide>::value) {
+                if (internal::simd_level_at_least(simd_level::avx512)) {
+                    apply_binary_op_avx512<T, Wide>(A + begin, B + begin, result + begin, end - begin);
+                    return;
+                }
+            }
+
+            if constexpr (internal::has_simd_traits<Traits<T>>::value) {
+                if (internal::use_avx2<Traits<T>>(end - begin)) {
+                    apply_binary_op_simd<T, Traits<T>>(A + begin, B + begin, result + begin, end - begin, binary_op);
+                    return;
+                }
+            }
+        #endif
+
+        #if SIMD_HAS_RVV
+            using Vector = internal::rvv_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Vector>::value) {
+                if (internal::simd_level_at_least(simd_level::rvv)) {
+                    apply_binary_op_rvv<T, Vector>(A + begin, B + begin, result + begin, end - begin);
+                    return;
+                }
+            }
+        #endif
+
+        apply_binary_op_plain(A + begin, B + begin, result + begin, end - begin, binary_op);
+    });
+}
+
+template <typename T, template <typename> class Traits, typename BinaryOp>
+void dispatch_binary_op(const T *A, size_t inc_a, const T *B, size_t inc_b, T *result, size_t n,
+                        BinaryOp binary_op) {
+    if (inc_a == 1 && inc_b == 1) {
+        dispatch_binary_op<T, Traits>(A, B, result, n, binary_op);
+        return;
+    }
+
+    internal::parallel_chunks<T>(n, [&](size_t begin, size_t end) {
+        const T *a = A + begin * inc_a;
+        const T *b = B + begin * inc_b;
+
+        #if SIMD_HAS_AVX2
+            using Wide = internal::avx512_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Wide>::value) {
+                if ((inc_a == 1 || inc_b == 1) && internal::simd_level_at_least(simd_level::avx512)) {
+                    apply_binary_op_avx512<T, Wide>(a, inc_a, b, inc_b, result + begin, end - begin);
+                    return;
+                }
+            }
+
+            if constexpr (internal::has_simd_traits<Traits<T>>::value) {
+                if ((inc_a == 1 || inc_b == 1) && internal::use_avx2<Traits<T>>(end - begin)) {
+                    apply_binary_op_simd<T, Traits<T>>(a, inc_a, b, inc_b, result + begin, end - begin, binary_op);
+                    return;
+                }
+            }
+        #endif
+
+        #if SIMD_HAS_RVV
+            using Vector = internal::rvv_traits_t<Traits, T>;
+            if constexpr (internal::has_simd_traits<Vector>::value) {
+                if (internal::simd_level_at_least(simd_level::rvv)) {
+                    apply_binary_op_rvv<T, Vector>(a, inc_a, b, inc_b, result + begin, end - begin);
+                    return;
+                }
+            }
+        #endif
+
+        apply_binary_op_plain(a, inc_a, b, inc_b, result + begin, end - begin, binary_op);
+    });
+}
+
+
+template <typename T, template <typename> class Traits, typename BinaryOp>
+T dispatch_reduce_op_serial(const T *A, size_t n, T identity, BinaryOp binary_op) {
+    #if SIMD_HAS_AVX2
+        using Wide = internal::avx512_traits_t<Traits, T>;
+        if constexpr (internal::has_simd_traits<Wide>::value) {
+            if (internal::simd_level_at_least(simd_level::avx512))
+                return reduce_op_avx512<T, Wide>(A, n, identity, binary_op);
+        }
+
+        if constexpr (internal::has_simd_traits<Traits<T>>::value) {
+            if (internal::use_avx2<Traits<T>>(n))
+                return reduce_op_simd<T, Traits<T>>(A, n, identity, binary_op);
+        }
+    #endif
+
+    #if SIMD_HAS_RVV
+        using Vector = internal::rvv_traits_t<Traits, T>;
+        if constexpr (internal::has_simd_traits<Vector>::value) {
+            if (internal::simd_level_at_least(simd_level::rvv))
+                return reduce_op_rvv<T, Vector>(A, n, identity, binary_op);
+        }
+    #endif
+
+    return reduce_op_plain(A, n, identity, binary_op);
+}
+
+
+// partial results of the chunks are combined in chunk order
+template <typename T, template <typename> class Traits, typename BinaryOp>
+T dispatch_reduce_op(const T *A, size_t n, T identity, BinaryOp binary_op) {
+    return internal::parallel_reduce<T>(n, [&](size_t begin, size_t end) {
+        return dispatch_reduce_op_serial<T, Traits>(A + begin, end - begin, identity, binary_op);
+    }, binary_op);
+}
+
+
+template <typename T>
+T dispatch_sum_compensated(const T *A, size_t n) {
+    const auto result = internal::parallel_reduce<T>(n, [&](size_t begin, size_t end) {
+        const T *a = A + begin;
+        const size_t count = end - begin;
+
+        #if SIMD_HAS_AVX2
+            using WideAdd = internal::avx512_traits_t<add_simd_traits, T>;
+            using WideSub = internal::avx512_traits_t<sub_simd_traits, T>;
+            if constexpr (internal::has_simd_traits<WideAdd>::value && internal::has_simd_traits<WideSub>::value) {
+                if (internal::simd_level_at_least(simd_level::avx512))
+                    return sum_compensated_avx512<T, WideAdd, WideSub>(a, count);
+            }
+
+            if constexpr (internal::has_simd_traits<add_simd_traits<T>>::value
+                          && internal::has_simd_traits<sub_simd_traits<T>>::value) {
+                if (internal::use_avx2<add_simd_traits<T>>(count))
+                    return sum_compensated_simd<T, add_simd_traits<T>, sub_simd_traits<T>>(a, count);
+            }
+        #endif
+
+        #if SIMD_HAS_RVV
+            using VectorAdd = internal::rvv_traits_t<add_simd_traits, T>;
+            using VectorSub = internal::rvv_traits_t<sub_simd_traits, T>;
+            if constexpr (internal::has_simd_traits<VectorAdd>::value && internal::has_simd_traits<VectorSub>::value) {
+                if (internal::simd_level_at_least(simd_level::rvv))
+                    return sum_compensated_rvv<T, VectorAdd, VectorSub>(a, count);
+            }
+        #endif
+
+        return sum_compensated_plain(a, count);
+    }, internal::combine_compensated<T>);
+
+    return internal::compensated_total(result);
+}
+
+
+template <typename T, typename AddOp, typename MulOp>
+T dispatch_dot_op_serial(const T *A, const T *B, size_t n, AddOp add_op, MulOp mul_op) {
+    #if SIMD_HAS_AVX2
+        if constexpr (std::is_floating_point<T>::value) {
+            if (internal::use_avx2<inner_product_simd_traits<T>>(n))
+                return dot_op_simd<T, inner_product_simd_traits<T>>(A, B, n);
+        }
+    #endif
+
+    return dot_op_plain(A, B, n, add_op, mul_op);
+}
+
+
+template <typename T, typename AddOp, typename MulOp>
+T dispatch_dot_op(const T *A, const T *B, size_t n, AddOp add_op, MulOp mul_op) {
+    return internal::parallel_reduce<T>(n, [&](size_t begin, size_t end) {
+        return dispatch_dot_op_serial(A + begin, B + begin, end - begin, add_op, mul_op);
+    }, add_op);
+}
+
+
+template <typename T>
+T dispatch_dot_compensated(const T *A, const T *B, size_t n) {
+    const auto result = internal::parallel_reduce<T>(n, [&](size_t begin, size_t end) {
+        #if SIMD_HAS_AVX2
+            if (internal::use_avx2<inner_product_simd_traits<T>>(end - begin))
+                return dot_compensated_simd<T, inner_product_simd_traits<T>, add_simd_traits<T>, sub_simd_traits<T>>(
+                    A + begin, B + begin, end - begin);
+        #endif
+
+        return dot_compensated_plain(A + begin, B + begin, end - begin);
+    }, internal::combine_compensated<T>);
+
+    return internal::compensated_total(result);
+}
+
+
+template <typename T>
+internal::moments<T> dispatch_moments_op(const T *A, size_t n) {
+    return internal::parallel_reduce<T>(n, [&](size_t begin, size_t end) {
+        const T *a = A + begin;
+        const size_t count = end - begin;
+
+        #if SIMD_HAS_AVX2
+            using WideAdd = internal::avx512_traits_t<add_simd_traits, T>;
+            using WideSub = internal::avx512_traits_t<sub_simd_traits, T>;
+            using WideMul = internal::avx512_traits_t<mul_simd_traits, T>;
+            if constexpr (internal::has_simd_traits<WideAdd>::value && internal::has_simd_traits<WideSub>::value
+                          && internal::has_simd_traits<WideMul>::value) {
+                if (internal::simd_level_at_least(simd_level::avx512))
+                    return internal::pairwise_moments(a, count, internal::moments_block, moments_op_avx512<T, WideAdd, WideSub, WideMul>);
+            }
+
+            if constexpr (internal::has_simd_traits<add_simd_traits<T>>::value
+                          && internal::has_simd_traits<sub_simd_traits<T>>::value
+                          && internal::has_simd_traits<mul_simd_traits<T>>::value) {
+                if (internal::use_avx2<add_simd_traits<T>>(count))
+                    return internal::pairwise_moments(a, count, internal::moments_block, moments_op_simd<T, add_simd_traits<T>, sub_simd_traits<T>, mul_simd_traits<T>>);
+            }
+        #endif
+
+        #if SIMD_HAS_RVV
+            using VectorAdd = internal::rvv_traits_t<add_simd_traits, T>;
+            using VectorSub = internal::rvv_traits_t<sub_simd_traits, T>;
+            using VectorMul = internal::rvv_traits_t<mul_simd_traits, T>;
+            if constexpr (internal::has_simd_traits<VectorAdd>::value && internal::has_simd_traits<VectorSub>::value
+                          && internal::has_simd_traits<VectorMul>::value) {
+                if (internal::simd_level_at_least(simd_level::rvv))
+                    return internal::pairwise_moments(a, count, internal::moments_block, moments_op_rvv<T, VectorAdd, VectorSub, VectorMul>);
+            }
+        #endif
+
+        return moments_op_plain(a, count);
+    }, [](const internal::moments<T>& later, const internal::moments<T>& earlier) {
+        return internal::merge_moments(earlier, later);
+    });
+}
+
+
 #endif
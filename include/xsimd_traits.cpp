@@ -1,333 +1,235 @@
 #ifndef XSIMD_TRAITS
 #define XSIMD_TRAITS
 
-#ifdef __AVX2__
+#include "utils/cpu_features.cpp"
+#include "simd_traits_avx512.cpp"
+
+// xsimd only enables an architecture the compiler itself targets, so unlike
+// the in-tree traits these follow the build flags: the 256-bit family needs
+// -mavx2 -mfma and the 512-bit one -mavx512f as well. Without them the traits
+// stay declared only and dispatch runs the scalar loops.
+#if SIMD_HAS_AVX2 && defined(__AVX2__) && defined(__FMA__)
+    #define SIMD_HAS_XSIMD_AVX2 1
     #include <xsimd/xsimd.hpp>
+#else
+    #define SIMD_HAS_XSIMD_AVX2 0
 #endif
-#include <type_traits>
-
-#ifdef __AVX2__
-// log_simd
-template <typename T>
-struct log_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
-
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::log(a);
-    }
-};
-
-
-// log2_simd
-template <typename T>
-struct log2_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
-
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::log2(a);
-    }
-};
-
-
-// log10_simd
-template <typename T>
-struct log10_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
-
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::log10(a);
-    }
-};
-
-
-// sin_simd
-template <typename T>
-struct sin_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
-
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::sin(a);
-    }
-};
-
-
-// cos_simd;
-template <typename T>
-struct cos_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
 
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::cos(a);
-    }
-};
-
-
-// sincos_simd
-template <typename T>
-struct sincos_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
-
-    static std::pair<simd_type, simd_type> op(simd_type a) noexcept {
-        return xsimd::sincos(a);
-    }
-};
-
-
-// tan_simd;
-template <typename T>
-struct tan_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
-
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::tan(a);
-    }
-};
-
-
-// asin_simd
-template <typename T>
-struct asin_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
+#if SIMD_HAS_XSIMD_AVX2 && defined(__AVX512F__)
+    #define SIMD_HAS_XSIMD_AVX512 1
+#else
+    #define SIMD_HAS_XSIMD_AVX512 0
+#endif
 
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::asin(a);
-    }
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+template <typename T> struct log_simd_traits;
+template <typename T> struct log2_simd_traits;
+template <typename T> struct log10_simd_traits;
+template <typename T> struct sin_simd_traits;
+template <typename T> struct cos_simd_traits;
+template <typename T> struct sincos_simd_traits;
+template <typename T> struct tan_simd_traits;
+template <typename T> struct asin_simd_traits;
+template <typename T> struct acos_simd_traits;
+template <typename T> struct atan_simd_traits;
+template <typename T> struct exp_simd_traits;
+template <typename T> struct exp2_simd_traits;
+template <typename T> struct expm1_simd_traits;
+template <typename T> struct log1p_simd_traits;
+template <typename T> struct pow_simd_traits;
+template <typename T> struct tanh_simd_traits;
+template <typename T> struct sigmoid_simd_traits;
+
+// 512-bit counterparts, on xsimd::batch<T, xsimd::avx512f>
+template <typename T> struct log_avx512_traits;
+template <typename T> struct log2_avx512_traits;
+template <typename T> struct log10_avx512_traits;
+template <typename T> struct sin_avx512_traits;
+template <typename T> struct cos_avx512_traits;
+template <typename T> struct sincos_avx512_traits;
+template <typename T> struct tan_avx512_traits;
+template <typename T> struct asin_avx512_traits;
+template <typename T> struct acos_avx512_traits;
+template <typename T> struct atan_avx512_traits;
+template <typename T> struct exp_avx512_traits;
+template <typename T> struct exp2_avx512_traits;
+template <typename T> struct expm1_avx512_traits;
+template <typename T> struct log1p_avx512_traits;
+template <typename T> struct pow_avx512_traits;
+template <typename T> struct tanh_avx512_traits;
+template <typename T> struct sigmoid_avx512_traits;
+
+SIMD_AVX512_COUNTERPART(log)
+SIMD_AVX512_COUNTERPART(log2)
+SIMD_AVX512_COUNTERPART(log10)
+SIMD_AVX512_COUNTERPART(sin)
+SIMD_AVX512_COUNTERPART(cos)
+SIMD_AVX512_COUNTERPART(sincos)
+SIMD_AVX512_COUNTERPART(tan)
+SIMD_AVX512_COUNTERPART(asin)
+SIMD_AVX512_COUNTERPART(acos)
+SIMD_AVX512_COUNTERPART(atan)
+SIMD_AVX512_COUNTERPART(exp)
+SIMD_AVX512_COUNTERPART(exp2)
+SIMD_AVX512_COUNTERPART(expm1)
+SIMD_AVX512_COUNTERPART(log1p)
+SIMD_AVX512_COUNTERPART(pow)
+SIMD_AVX512_COUNTERPART(tanh)
+SIMD_AVX512_COUNTERPART(sigmoid)
+
+
+// Each family is instantiated on the xsimd batch of its own architecture, so
+// AVX-512 dispatch runs the math kernels at 512 bits when the build has both.
+#define XSIMD_UNARY_TRAITS(traits, io, expr) \
+template <typename T> \
+struct traits : internal::io<T> { \
+    using simd_type = typename internal::io<T>::simd_type; \
+    \
+    static simd_type op(simd_type a) noexcept { \
+        return expr; \
+    } \
 };
 
+// every op of the library's xsimd families; the comments stay with the list
+#define XSIMD_TRAITS_FAMILIES(suffix, io) \
+    /* log_simd */ \
+    XSIMD_UNARY_TRAITS(log_##suffix, io, xsimd::log(a)) \
+    /* log2_simd */ \
+    XSIMD_UNARY_TRAITS(log2_##suffix, io, xsimd::log2(a)) \
+    /* log10_simd */ \
+    XSIMD_UNARY_TRAITS(log10_##suffix, io, xsimd::log10(a)) \
+    /* sin_simd */ \
+    XSIMD_UNARY_TRAITS(sin_##suffix, io, xsimd::sin(a)) \
+    /* cos_simd */ \
+    XSIMD_UNARY_TRAITS(cos_##suffix, io, xsimd::cos(a)) \
+    /* tan_simd */ \
+    XSIMD_UNARY_TRAITS(tan_##suffix, io, xsimd::tan(a)) \
+    /* asin_simd */ \
+    XSIMD_UNARY_TRAITS(asin_##suffix, io, xsimd::asin(a)) \
+    /* acos_simd */ \
+    XSIMD_UNARY_TRAITS(acos_##suffix, io, xsimd::acos(a)) \
+    /* atan_simd */ \
+    XSIMD_UNARY_TRAITS(atan_##suffix, io, xsimd::atan(a)) \
+    /* exp_simd */ \
+    XSIMD_UNARY_TRAITS(exp_##suffix, io, xsimd::exp(a)) \
+    /* exp2_simd */ \
+    XSIMD_UNARY_TRAITS(exp2_##suffix, io, xsimd::exp2(a)) \
+    /* expm1_simd: exp(a) - 1 without the cancellation near zero */ \
+    XSIMD_UNARY_TRAITS(expm1_##suffix, io, xsimd::expm1(a)) \
+    /* log1p_simd: log(1 + a), accurate for small a */ \
+    XSIMD_UNARY_TRAITS(log1p_##suffix, io, xsimd::log1p(a)) \
+    /* tanh_simd */ \
+    XSIMD_UNARY_TRAITS(tanh_##suffix, io, xsimd::tanh(a)) \
+    /* sigmoid_simd: 1 / (1 + exp(-a)); exp overflows to inf for large -a, giving 0 */ \
+    XSIMD_UNARY_TRAITS(sigmoid_##suffix, io, simd_type(T(1)) / (simd_type(T(1)) + xsimd::exp(-a))) \
+    \
+    /* sincos_simd */ \
+    template <typename T> \
+    struct sincos_##suffix : internal::io<T> { \
+        using simd_type = typename internal::io<T>::simd_type; \
+        \
+        static std::pair<simd_type, simd_type> op(simd_type a) noexcept { \
+            return xsimd::sincos(a); \
+        } \
+    }; \
+    \
+    /* pow_simd */ \
+    template <typename T> \
+    struct pow_##suffix : internal::io<T> { \
+        using simd_type = typename internal::io<T>::simd_type; \
+        \
+        static simd_type op(simd_type a, simd_type b) noexcept { \
+            return xsimd::pow(a, b); \
+        } \
+    };
+
+
+namespace internal {
+    template <typename T>
+    using if_xsimd_scalar = std::enable_if_t<std::is_same<T, float>::value || std::is_same<T, double>::value>;
+
+    template <typename T, typename = void>
+    struct xsimd_avx2_io {
+        static_assert(sizeof(T) == 0, "Unsupported scalar type. Only float and double are supported.");
+    };
+
+    template <typename T, typename = void>
+    struct xsimd_avx512_io {
+        static_assert(sizeof(T) == 0, "Unsupported scalar type. Only float and double are supported.");
+    };
+}
+
+
+#if SIMD_HAS_XSIMD_AVX2
+namespace internal {
+    // xsimd_avx2_io: load/store of the 256-bit batch
+    template <typename T>
+    struct xsimd_avx2_io<T, if_xsimd_scalar<T>> {
+        using scalar_type = T;
+        using simd_type = xsimd::batch<T, xsimd::avx2>;
+        static constexpr size_t step = simd_type::size;
+
+        static simd_type load(const scalar_type* ptr) noexcept {
+            return simd_type::load_unaligned(ptr);
+        }
+
+        static void store(scalar_type* ptr, simd_type val) noexcept {
+            val.store_unaligned(ptr);
+        }
+    };
+}
+
+XSIMD_TRAITS_FAMILIES(simd_traits, xsimd_avx2_io)
+#endif
 
-// acos_simd
-template <typename T>
-struct acos_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
-
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
-
-    static constexpr size_t step = simd_type::size;
-
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
-
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
 
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::acos(a);
-    }
-};
+#if SIMD_HAS_XSIMD_AVX512
+// inside the AVX-512 region so the family inlines into its driver, which
+// also targets BW, DQ and VL
+SIMD_TARGET_AVX512_BEGIN
 
+namespace internal {
+    // xsimd_avx512_io: the 512-bit batch, with the masked access of avx512_io
+    // so the AVX-512 drivers finish a row with one masked block
+    template <typename T>
+    struct xsimd_avx512_io<T, if_xsimd_scalar<T>> : avx512_io<T> {
+        using simd_type = xsimd::batch<T, xsimd::avx512f>;
+        using mask_type = typename avx512_io<T>::mask_type;
+        static constexpr size_t step = simd_type::size;
 
-// atan_simd
-template <typename T>
-struct atan_simd_traits {
-    using scalar_type = T;
-    using simd_type = typename std::conditional<
-        std::is_same<T, float>::value,
-        xsimd::simd_type<float>,
-        typename std::conditional<
-            std::is_same<T, double>::value,
-            xsimd::simd_type<double>,
-            void
-        >::type
-    >::type;
+        // the masked access goes through the batch's native register, which
+        // xsimd only exposes for an architecture the build targets
+        static_assert(sizeof(simd_type) == sizeof(typename avx512_io<T>::simd_type) && step == avx512_io<T>::step,
+                      "xsimd::avx512f batches must wrap the native 512-bit register");
 
-    static_assert(!std::is_same<simd_type, void>::value, "Unsupported scalar type. Only float and double are supported.");
+        static simd_type load(const T* ptr) noexcept {
+            return simd_type::load_unaligned(ptr);
+        }
 
-    static constexpr size_t step = simd_type::size;
+        static void store(T* ptr, simd_type val) noexcept {
+            val.store_unaligned(ptr);
+        }
 
-    static simd_type load(const scalar_type* ptr) noexcept {
-        return simd_type::load_unaligned(ptr);
-    }
+        static simd_type load(const T* ptr, mask_type mask) noexcept {
+            return simd_type(avx512_io<T>::load(ptr, mask));
+        }
 
-    static void store(scalar_type* ptr, simd_type val) noexcept {
-        val.store_unaligned(ptr);
-    }
+        static void store(T* ptr, simd_type val, mask_type mask) noexcept {
+            avx512_io<T>::store(ptr, val, mask);
+        }
+    };
+}
 
-    static simd_type op(simd_type a) noexcept {
-        return xsimd::atan(a);
-    }
-};
+XSIMD_TRAITS_FAMILIES(avx512_traits, xsimd_avx512_io)
 
+SIMD_TARGET_END
 #endif
 
+#undef XSIMD_TRAITS_FAMILIES
+#undef XSIMD_UNARY_TRAITS
+
 
 #endif
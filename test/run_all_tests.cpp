@@ -1,10 +1,15 @@
+#include "test_accuracy.hpp"
 #include "test_apply.hpp"
 #include "test_basic_property.hpp"
+#include "test_expression.hpp"
 #include "test_logical.hpp"
 #include "test_math.hpp"
 #include "test_matrix_operations.hpp"
+#include "test_reduce.hpp"
 #include "test_shift.hpp"
 #include "test_sort.hpp"
+#include "test_statistics.hpp"
+#include "test_view.hpp"
 
 
 int main(int argc, char **argv) {
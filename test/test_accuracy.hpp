@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include <limits>
+#include "../include/data_structure/ndarray.cpp"
+
+// ulp_error: distance from result to the long double reference in units in
+// the last place of T at the reference; equal infinities and NaNs count as 0
+template <typename T>
+long double ulp_error(T result, long double reference) {
+    if (std::isnan(reference) || std::isinf(reference))
+        return (std::isnan(reference) ? std::isnan(result) : result == reference) ? 0
+                                                                                   : std::numeric_limits<long double>::infinity();
+
+    const T rounded = std::fabs(static_cast<T>(reference));
+    if (std::isinf(rounded))
+        return std::isinf(result) && (result > 0) == (reference > 0) ? 0 : std::numeric_limits<long double>::infinity();
+
+    const long double ulp = rounded == std::numeric_limits<T>::max()
+                          ? static_cast<long double>(rounded) - std::nextafter(rounded, T(0))
+                          : std::nextafter(rounded, std::numeric_limits<T>::infinity()) - static_cast<long double>(rounded);
+
+    return std::fabs(static_cast<long double>(result) - reference) / ulp;
+}
+
+// max_ulp_error: worst error of kernel over data against reference
+template <typename T, typename Kernel, typename Reference>
+long double max_ulp_error(const std::vector<T>& data, Kernel kernel, Reference reference) {
+    std::vector<T> result(data.size());
+    kernel(data.data(), result.data(), data.size());
+
+    long double worst = 0;
+    for (size_t i = 0; i < data.size(); ++i)
+        worst = std::max(worst, ulp_error(result[i], reference(static_cast<long double>(data[i]))));
+
+    return worst;
+}
+
+// log_uniform: n values spread evenly over the binades of [low, high]
+template <typename T>
+std::vector<T> log_uniform(T low, T high, size_t n) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dis(std::log(static_cast<double>(low)), std::log(static_cast<double>(high)));
+
+    std::vector<T> data(n);
+    for (auto& x : data)
+        x = static_cast<T>(std::exp(dis(gen)));
+
+    return data;
+}
+
+template <typename T>
+std::vector<T> uniform(T low, T high, size_t n) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<T> dis(low, high);
+
+    std::vector<T> data(n);
+    for (auto& x : data)
+        x = dis(gen);
+
+    return data;
+}
+
+
+TEST(AccuracyTest, ScopeTest) {
+    // nothing set: every kernel at its own default
+    EXPECT_EQ(get_accuracy(), std::nullopt);
+    EXPECT_EQ(internal::kernel_accuracy(), default_accuracy);
+    EXPECT_EQ(internal::rsqrt_accuracy(), default_rsqrt_accuracy);
+
+    {
+        accuracy_scope outer(accuracy::approx);
+        EXPECT_EQ(get_accuracy(), accuracy::approx);
+
+        {
+            accuracy_scope inner(accuracy::ulp4);
+            EXPECT_EQ(get_accuracy(), accuracy::ulp4);
+        }
+
+        EXPECT_EQ(get_accuracy(), accuracy::approx);
+        EXPECT_EQ(internal::kernel_accuracy(), accuracy::approx);
+        EXPECT_EQ(internal::rsqrt_accuracy(), accuracy::approx);
+    }
+
+    EXPECT_EQ(get_accuracy(), std::nullopt);
+}
+
+
+// every mode must meet its bound at every instruction set level, across the
+// whole range including subnormal inputs (log) and subnormal results (exp)
+template <typename T>
+void checkUlpBounds(accuracy mode, long double bound) {
+    const size_t n = 20003;
+    const T lowest = std::numeric_limits<T>::denorm_min() * 16;
+    const T exp_low = std::is_same<T, float>::value ? T(-103) : T(-744);
+    const T exp_high = std::is_same<T, float>::value ? T(88.7) : T(709.7);
+
+    const auto positive = log_uniform<T>(lowest, std::numeric_limits<T>::max() / 2, n);
+    const auto exponents = uniform<T>(exp_low, exp_high, n);
+    const auto small = uniform<T>(T(-1), T(1), n);
+
+    auto reference_exp = [](long double x) { return std::exp(x); };
+    auto reference_log = [](long double x) { return std::log(x); };
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        auto exp_kernel = [mode](const T *a, T *r, size_t m) { internal::exp1_simd(a, r, m, mode); };
+        auto log_kernel = [mode](const T *a, T *r, size_t m) { internal::log_1_simd(a, r, m, mode); };
+
+        EXPECT_LE(max_ulp_error(exponents, exp_kernel, reference_exp), bound);
+        EXPECT_LE(max_ulp_error(small, exp_kernel, reference_exp), bound);
+        EXPECT_LE(max_ulp_error(positive, log_kernel, reference_log), bound);
+
+        if constexpr (std::is_same<T, float>::value) {
+            auto rsqrt_kernel = [mode](const T *a, T *r, size_t m) { internal::rsqrt1_simd(a, r, m, mode); };
+            auto reference_rsqrt = [](long double x) { return 1 / std::sqrt(x); };
+
+            EXPECT_LE(max_ulp_error(positive, rsqrt_kernel, reference_rsqrt), bound);
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+TEST(AccuracyTest, UlpBoundTest) {
+    checkUlpBounds<float>(accuracy::ulp1, 1);
+    checkUlpBounds<double>(accuracy::ulp1, 1);
+    checkUlpBounds<float>(accuracy::ulp4, 4);
+    checkUlpBounds<double>(accuracy::ulp4, 4);
+}
+
+
+TEST(AccuracyTest, SpecialValueTest) {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<float> data = {0.0f, -0.0f, inf, -inf, nan, -1.0f, 1.0f, 1e-42f, 1e30f, -200.0f, 200.0f};
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (accuracy mode : {accuracy::ulp1, accuracy::ulp4, accuracy::approx}) {
+            const long double bound = mode == accuracy::ulp1 ? 1 : 4;
+
+            std::vector<float> e(data.size()), l(data.size()), r(data.size());
+            internal::exp1_simd(data.data(), e.data(), data.size(), mode);
+            internal::log_1_simd(data.data(), l.data(), data.size(), mode);
+            internal::rsqrt1_simd(data.data(), r.data(), data.size(), mode);
+
+            for (size_t i = 0; i < data.size(); ++i) {
+                const long double x = data[i];
+                EXPECT_LE(ulp_error(e[i], std::exp(x)), bound) << "exp(" << data[i] << ")";
+                EXPECT_LE(ulp_error(l[i], std::log(x)), bound) << "log(" << data[i] << ")";
+
+                if (std::isnan(x) || std::isinf(x) || x <= 0) {
+                    EXPECT_EQ(ulp_error(r[i], 1 / std::sqrt(x)), 0) << "rsqrt(" << data[i] << ")";
+                } else if (mode != accuracy::approx) {
+                    EXPECT_LE(ulp_error(r[i], 1 / std::sqrt(x)), bound) << "rsqrt(" << data[i] << ")";
+                }
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+
+TEST(AccuracyTest, ApproxRsqrtTest) {
+    const auto data = log_uniform<float>(1e-30f, 1e30f, 10001);
+    ndarray<float> arr({data.size()});
+    arr.assign(data);
+
+    // rsqrt keeps the hardware estimate until the thread asks for a bound
+    const std::vector<float> fast = arr.rsqrt().data();
+    std::vector<float> exact, approx;
+    {
+        accuracy_scope scope(accuracy::ulp1);
+        exact = arr.rsqrt().data();
+        {
+            accuracy_scope inner(accuracy::approx);
+            approx = arr.rsqrt().data();
+        }
+        EXPECT_EQ(arr.rsqrt().data(), exact);
+    }
+    EXPECT_EQ(get_accuracy(), std::nullopt);
+    EXPECT_EQ(arr.rsqrt().data(), fast);
+    EXPECT_EQ(approx, fast);
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_LE(ulp_error(exact[i], 1 / std::sqrt(static_cast<long double>(data[i]))), 1);
+        EXPECT_NEAR(fast[i], exact[i], exact[i] * 1e-3f);
+    }
+}
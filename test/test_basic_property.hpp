@@ -60,3 +60,109 @@ TEST(NDArrayTest, OperatorOutputTwoDimensionalTest) {
     std::string expected = "[[1, 2],\n [3, 4]]";
     EXPECT_EQ(oss.str(), expected);
 }
+
+TEST(NDArrayTest, AdoptStorageTest) {
+    std::vector<size_t> shape = {2, 3};
+    ndarray<int>::storage_type data = {1, 2, 3, 4, 5, 6};
+    const int *buffer = data.data();
+
+    ndarray<int> arr(shape, std::move(data));
+    EXPECT_EQ(arr.flat().data(), buffer);
+    EXPECT_EQ(arr({1, 2}), 6);
+
+    ndarray<int> moved(std::move(arr));
+    EXPECT_EQ(moved.flat().data(), buffer);
+
+    ndarray<int>::storage_type wrong_size(5);
+    EXPECT_THROW(ndarray<int>(shape, std::move(wrong_size)), std::invalid_argument);
+}
+
+TEST(NDArrayTest, FlatSpanTest) {
+    std::vector<size_t> shape = {4};
+    ndarray<float> arr(shape, uninitialized);
+
+    span<float> values = arr.flat();
+    EXPECT_EQ(values.size(), arr.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<float>(i);
+
+    const ndarray<float>& const_arr = arr;
+    span<const float> const_values = const_arr.flat();
+    EXPECT_EQ(const_values.data(), values.data());
+    EXPECT_EQ(arr.data(), (std::vector<float>{0.0f, 1.0f, 2.0f, 3.0f}));
+}
+
+TEST(NDArrayTest, ThreeDimensionalTest) {
+    std::vector<size_t> shape = {2, 2, 3};
+    ndarray<int> arr(shape);
+    span<int> values = arr.flat();
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<int>(i);
+
+    EXPECT_EQ(arr.ndim(), 3);
+    EXPECT_EQ(arr({1, 0, 2}), 8);
+    EXPECT_THROW(arr({0, 2, 0}), std::out_of_range);
+
+    std::ostringstream oss;
+    oss << arr;
+    EXPECT_EQ(oss.str(), "[[[0, 1, 2],\n  [3, 4, 5]],\n\n [[6, 7, 8],\n  [9, 10, 11]]]");
+
+    ndarray<int> doubled = arr.add(arr).max(arr);
+    ndarray<int> transposed = arr.transpose();
+    ndarray<int> sorted = arr.apply([](int x) { return -x; }).sort();
+
+    EXPECT_EQ(transposed.shape(), (std::vector<size_t>{3, 2, 2}));
+    for (size_t i = 0; i < shape[0]; ++i) {
+        for (size_t j = 0; j < shape[1]; ++j) {
+            for (size_t k = 0; k < shape[2]; ++k) {
+                EXPECT_EQ(doubled({i, j, k}), 2 * arr({i, j, k}));
+                EXPECT_EQ(transposed({k, j, i}), arr({i, j, k}));
+                EXPECT_EQ(sorted({i, j, k}), -arr({i, j, shape[2] - 1 - k}));
+            }
+        }
+    }
+}
+
+TEST(NDArrayTest, AlignedStorageTest) {
+    for (size_t n : {1, 3, 17, 1000}) {
+        ndarray<uint8_t> bytes(std::vector<size_t>{n});
+        ndarray<double> doubles(std::vector<size_t>{n, 3}, uninitialized);
+
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(bytes.flat().data()) % 64, 0u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(doubles.flat().data()) % 64, 0u);
+    }
+}
+
+TEST(NDArrayTest, MemoryPoolReuseTest) {
+    std::vector<size_t> shape = {1000};
+    const float *first;
+    {
+        ndarray<float> arr(shape, uninitialized);
+        first = arr.flat().data();
+    }
+
+    // a same-class request is served from the buffer just freed
+    ndarray<double> reused(std::vector<size_t>{400}, uninitialized);
+    EXPECT_EQ(static_cast<const void *>(reused.flat().data()), static_cast<const void *>(first));
+
+    release_memory_pool();
+    EXPECT_EQ(internal::local_memory_pool()->cached_bytes(), 0u);
+
+    set_memory_pool_limit(0);
+    { ndarray<float> arr(shape); }
+    EXPECT_EQ(internal::local_memory_pool()->cached_bytes(), 0u);
+    set_memory_pool_limit(static_cast<size_t>(256) << 20);
+}
+
+TEST(NDArrayTest, MemoryPoolBlockSizeTest) {
+    using internal::memory_pool;
+    const size_t largest = static_cast<size_t>(1) << memory_pool::max_class;
+
+    // cacheable sizes round up to their class, larger ones are exact
+    EXPECT_EQ(memory_pool::block_size(1), 64u);
+    EXPECT_EQ(memory_pool::block_size(4000), 4096u);
+    EXPECT_EQ(memory_pool::block_size(largest - 1), largest);
+    EXPECT_EQ(memory_pool::block_size(largest + 1), largest + 1);
+    EXPECT_EQ(memory_pool::block_size(std::numeric_limits<size_t>::max()), std::numeric_limits<size_t>::max());
+    EXPECT_EQ(memory_pool::size_class(std::numeric_limits<size_t>::max()), memory_pool::max_class);
+}
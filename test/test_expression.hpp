@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "../include/data_structure/ndarray.cpp"
+
+TEST(LazyExpressionTest, FusedChainMatchesEagerTest) {
+    std::vector<size_t> shape = {1003};
+    ndarray<float> a(shape), b(shape);
+    std::vector<float> data_a(shape[0]), data_b(shape[0]);
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> dis(-100.0f, 100.0f);
+
+    for (size_t i = 0; i < shape[0]; ++i) {
+        data_a[i] = dis(gen);
+        data_b[i] = dis(gen);
+    }
+    a.assign(data_a);
+    b.assign(data_b);
+
+    ndarray<float> eager = a.sub(b).abs().sqrt();
+    ndarray<float> fused = a.lazy().sub(b).abs().sqrt();
+
+    // abs runs on native registers and log on xsimd batches
+    ndarray<float> eager_log = a.abs().log();
+    ndarray<float> fused_log = a.lazy().abs().log();
+
+    for (size_t i = 0; i < shape[0]; ++i) {
+        EXPECT_FLOAT_EQ(fused({i}), eager({i}));
+        EXPECT_FLOAT_EQ(fused_log({i}), eager_log({i}));
+    }
+}
+
+TEST(LazyExpressionTest, IntegerChainTest) {
+    std::vector<size_t> shape = {7, 13};
+    ndarray<int32_t> a(shape), b(shape), c(shape);
+    std::vector<std::vector<int32_t>> data_a(shape[0], std::vector<int32_t>(shape[1]));
+    std::vector<std::vector<int32_t>> data_b = data_a, data_c = data_a;
+
+    for (size_t i = 0; i < shape[0]; ++i) {
+        for (size_t j = 0; j < shape[1]; ++j) {
+            data_a[i][j] = static_cast<int32_t>(i * 31 + j);
+            data_b[i][j] = static_cast<int32_t>(j * 7) - static_cast<int32_t>(i);
+            data_c[i][j] = static_cast<int32_t>(i + j);
+        }
+    }
+    a.assign(data_a);
+    b.assign(data_b);
+    c.assign(data_c);
+
+    ndarray<int32_t> result = a.lazy().add(b).max(c.lazy().sub(b)).slli(1);
+
+    for (size_t i = 0; i < shape[0]; ++i)
+        for (size_t j = 0; j < shape[1]; ++j)
+            EXPECT_EQ(result({i, j}), std::max(data_a[i][j] + data_b[i][j], data_c[i][j] - data_b[i][j]) << 1);
+}
+
+TEST(LazyExpressionTest, AssignInPlaceTest) {
+    std::vector<size_t> shape = {100};
+    ndarray<double> a(shape);
+    std::vector<double> data(shape[0]);
+    for (size_t i = 0; i < shape[0]; ++i)
+        data[i] = static_cast<double>(i) - 50.0;
+    a.assign(data);
+
+    a.assign(a.lazy().abs().add(a));
+    for (size_t i = 0; i < shape[0]; ++i)
+        EXPECT_DOUBLE_EQ(a({i}), std::abs(data[i]) + data[i]);
+
+    ndarray<double> other({50});
+    EXPECT_THROW(a.lazy().add(other), std::invalid_argument);
+    EXPECT_THROW(other.assign(a.lazy().abs()), std::invalid_argument);
+}
@@ -859,36 +859,41 @@ TEST(NDArrayMathTest, Atan2DTest) {
 }
 
 
-// TEST(NDArrayMathTest, Sincos1DTest) {
-//     std::vector<size_t> shape = {4};
-//     ndarray<float> arr(shape);
-//     std::vector<float> data = {0.0f, 0.5f, 0.707f, 1.0f};
-//     arr.assign(data);
-
-//     ndarray<float> result = arr.sincos();
-//     std::vector<float> resultData = result.data();
-
-//     for (size_t i = 0; i < data.size(); ++i) {
-//         EXPECT_NEAR(resultData[i], std::sin(data[i]), 1e-3);
-//     }
-// }
-
-// TEST(NDArrayMathTest, Sincos2DTest) {
-//     std::vector<size_t> shape = {2, 2};
-//     ndarray<float> arr(shape);
-//     std::vector<std::vector<float>> data = {{0.0f, 0.5f}, {0.707f, 1.0f}};
-//     arr.assign(data);
-
-//     ndarray<float> result = arr.sincos();
-//     std::vector<float> resultData = result.data();
-
-//     size_t index = 0;
-//     for (size_t i = 0; i < shape[0]; ++i) {
-//         for (size_t j = 0; j < shape[1]; ++j) {
-//             EXPECT_NEAR(resultData[index++], std::sin(data[i][j]), 1e-3);
-//         }
-//     }
-// }
+TEST(NDArrayMathTest, Sincos1DTest) {
+    std::vector<size_t> shape = {4};
+    ndarray<float> arr(shape);
+    std::vector<float> data = {0.0f, 0.5f, 0.707f, 1.0f};
+    arr.assign(data);
+
+    auto result = arr.sincos();
+    std::vector<float> sinData = result.first.data();
+    std::vector<float> cosData = result.second.data();
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_NEAR(sinData[i], std::sin(data[i]), 1e-3);
+        EXPECT_NEAR(cosData[i], std::cos(data[i]), 1e-3);
+    }
+}
+
+TEST(NDArrayMathTest, Sincos2DTest) {
+    std::vector<size_t> shape = {37, 53};
+    ndarray<double> arr(shape);
+    for (size_t i = 0; i < arr.size(); ++i)
+        arr.flat()[i] = static_cast<double>(i) * 0.37 - 300.0;
+
+    ndarray<double> sin_out(shape), cos_out(shape);
+    arr.sincos(sin_out, cos_out);
+
+    // matches the separate kernels, tail elements included
+    ndarray<double> sines = arr.sin(), cosines = arr.cos();
+    for (size_t i = 0; i < arr.size(); ++i) {
+        EXPECT_NEAR(sin_out.flat()[i], sines.flat()[i], 1e-12);
+        EXPECT_NEAR(cos_out.flat()[i], cosines.flat()[i], 1e-12);
+    }
+
+    ndarray<double> wrong({53, 37});
+    EXPECT_THROW(arr.sincos(wrong, cos_out), std::invalid_argument);
+}
 
 TEST(NDArrayMathTest, Round1DTest) {
     std::vector<size_t> shape = {10000};
@@ -942,3 +947,301 @@ TEST(NDArrayMathTest, Round2DTest) {
         }
     }
 }
+
+TEST(NDArrayMathTest, OutAndInPlaceTest) {
+    std::vector<size_t> shape = {10000};
+    ndarray<float> arr1(shape);
+    ndarray<float> arr2(shape);
+    ndarray<float> out(shape);
+    std::vector<float> data1(shape[0]);
+    std::vector<float> data2(shape[0]);
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> dis(1.0f, 10.0f);
+
+    for (size_t i = 0; i < shape[0]; ++i) {
+        data1[i] = dis(gen);
+        data2[i] = dis(gen);
+    }
+
+    arr1.assign(data1);
+    arr2.assign(data2);
+
+    ndarray<float>& sqrt_result = arr1.sqrt(out);
+    EXPECT_EQ(&sqrt_result, &out);
+
+    arr1.min_(arr2).sqrt_();
+
+    std::vector<float> outData = out.data();
+    std::vector<float> inPlaceData = arr1.data();
+    for (size_t i = 0; i < shape[0]; ++i) {
+        EXPECT_NEAR(outData[i], std::sqrt(data1[i]), 1e-3);
+        EXPECT_NEAR(inPlaceData[i], std::sqrt(std::min(data1[i], data2[i])), 1e-3);
+    }
+
+    ndarray<float> wrong_shape(std::vector<size_t>{shape[0] - 1});
+    EXPECT_THROW(arr1.sqrt(wrong_shape), std::invalid_argument);
+}
+
+TEST(NDArrayMathTest, UnalignedAndStreamingTest) {
+    // offset pointers exercise the alignment peel; 2M floats take the
+    // non-temporal store path
+    const size_t n = static_cast<size_t>(1) << 21;
+    std::vector<float> A(n + 1), B(n + 1), result(n + 1);
+    for (size_t i = 0; i < A.size(); ++i) {
+        A[i] = static_cast<float>(i % 1000);
+        B[i] = static_cast<float>(i % 7);
+    }
+
+    internal::max1_simd(A.data() + 1, B.data() + 1, result.data() + 1, 100);
+    for (size_t i = 1; i <= 100; ++i)
+        EXPECT_EQ(result[i], std::max(A[i], B[i]));
+
+    internal::sqrt1_simd(A.data(), result.data(), n);
+    for (size_t i = 0; i < n; i += 997)
+        EXPECT_FLOAT_EQ(result[i], std::sqrt(A[i]));
+    EXPECT_FLOAT_EQ(result[n - 1], std::sqrt(A[n - 1]));
+}
+
+TEST(NDArrayMathTest, ParallelChunksTest) {
+    // a low threshold forces the chunked path at test sizes
+    set_parallel_threshold(1024);
+
+    std::vector<size_t> shape = {257, 389};
+    ndarray<float> arr(shape), row({389});
+    for (size_t i = 0; i < arr.size(); ++i)
+        arr.flat()[i] = static_cast<float>(i % 1000) * 0.01f;
+    for (size_t j = 0; j < row.size(); ++j)
+        row.flat()[j] = static_cast<float>(j);
+
+    ndarray<float> sines = arr.sin();
+    ndarray<float> biased = arr.add(row);
+    ndarray<float> fused = arr.lazy().abs().max(arr).sqrt();
+
+    set_parallel_threshold(static_cast<size_t>(1) << 17);
+
+    for (size_t i = 0; i < shape[0]; ++i) {
+        for (size_t j = 0; j < shape[1]; ++j) {
+            EXPECT_NEAR(sines({i, j}), std::sin(arr({i, j})), 1e-5);
+            EXPECT_FLOAT_EQ(biased({i, j}), arr({i, j}) + row({j}));
+            EXPECT_FLOAT_EQ(fused({i, j}), std::sqrt(arr({i, j})));
+        }
+    }
+}
+
+TEST(NDArrayMathTest, RuntimeDispatchTest) {
+    std::vector<size_t> shape = {3, 67};
+    ndarray<float> arr(shape), row({67});
+    ndarray<int> ints(shape);
+    for (size_t i = 0; i < arr.size(); ++i) {
+        arr.flat()[i] = static_cast<float>(i) * 0.25f;
+        ints.flat()[i] = static_cast<int>(i);
+    }
+    for (size_t j = 0; j < row.size(); ++j)
+        row.flat()[j] = static_cast<float>(j);
+
+    const simd_level detected = get_simd_level();
+    ndarray<float> sums = arr.add(row);
+    ndarray<float> roots = arr.lazy().abs().sqrt();
+    ndarray<int> shifted = ints.max(ints).slli(2);
+
+    // the scalar path must agree with whatever level the CPU selected
+    set_simd_level(simd_level::scalar);
+    EXPECT_EQ(get_simd_level(), simd_level::scalar);
+
+    EXPECT_EQ(arr.add(row).data(), sums.data());
+    EXPECT_EQ(ndarray<float>(arr.lazy().abs().sqrt()).data(), roots.data());
+    EXPECT_EQ(ints.max(ints).slli(2).data(), shifted.data());
+
+    set_simd_level(simd_level::avx512);
+    EXPECT_EQ(get_simd_level(), detected);
+
+    // rvv ranks with avx2 but is its own level; another architecture's level
+    // never lowers dispatch
+    EXPECT_NE(simd_level::rvv, simd_level::avx2);
+    EXPECT_EQ(rank(simd_level::rvv), rank(simd_level::avx2));
+    set_simd_level(detected == simd_level::rvv ? simd_level::avx2 : simd_level::rvv);
+    EXPECT_EQ(get_simd_level(), detected);
+}
+
+TEST(NDArrayMathTest, MaskedTailTest) {
+    // every length up to a few registers, so each lane count is hit as a
+    // tail, at each level this CPU can dispatch to
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (size_t n = 1; n <= 130; ++n) {
+            ndarray<int8_t> bytes({n});
+            ndarray<int64_t> longs({n});
+            ndarray<int32_t> ints({n});
+            ndarray<float> floats({n});
+            ndarray<double> doubles({n}), offsets({1, n});
+            for (size_t i = 0; i < n; ++i) {
+                bytes.flat()[i] = static_cast<int8_t>(static_cast<int>(i * 7) % 200 - 100);
+                longs.flat()[i] = static_cast<int64_t>(i) * 1000003 - 50000000;
+                ints.flat()[i] = static_cast<int32_t>(i * 3);
+                floats.flat()[i] = static_cast<float>(i) * 0.25f - 8.0f;
+                doubles.flat()[i] = static_cast<double>(i) * 0.5 - 20.0;
+            }
+
+            ndarray<int8_t> byte_sums = bytes.add(bytes).abs();
+            ndarray<int64_t> long_max = longs.max(longs.sub(longs));
+            ndarray<int32_t> int_shifts = ints.slli(3);
+            ndarray<float> fused = floats.lazy().abs().sqrt();
+            ndarray<double> rounded = doubles.round();
+            ndarray<double> shifted = offsets.add(doubles);
+            ndarray<float> rows = ndarray<float>({3, n}).add(floats);
+
+            for (size_t i = 0; i < n; ++i) {
+                const int8_t sum = static_cast<int8_t>(bytes.flat()[i] + bytes.flat()[i]);
+                EXPECT_EQ(byte_sums.flat()[i], static_cast<int8_t>(std::abs(sum)));
+                EXPECT_EQ(long_max.flat()[i], std::max<int64_t>(longs.flat()[i], 0));
+                EXPECT_EQ(int_shifts.flat()[i], ints.flat()[i] << 3);
+                EXPECT_EQ(fused.flat()[i], std::sqrt(std::abs(floats.flat()[i])));
+                EXPECT_EQ(rounded.flat()[i], std::round(doubles.flat()[i]));
+                EXPECT_EQ(shifted.flat()[i], doubles.flat()[i]);
+                for (size_t r = 0; r < 3; ++r)
+                    EXPECT_EQ(rows({r, i}), floats.flat()[i]);
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+TEST(NDArrayMathTest, ExpFamilyTest) {
+    const size_t n = 203;
+    ndarray<double> arr({n}), exponents({n});
+    for (size_t i = 0; i < n; ++i) {
+        arr.flat()[i] = static_cast<double>(i) * 0.1 - 10.05;
+        exponents.flat()[i] = static_cast<double>(i % 7) - 3.0;
+    }
+
+    ndarray<double> exps = arr.exp(), exp2s = arr.exp2(), expm1s = arr.expm1(), tanhs = arr.tanh(),
+                    sigmoids = arr.sigmoid(), powers = arr.abs().pow(exponents);
+    ndarray<double> log1ps = arr.abs().log1p();
+    ndarray<double> fused = arr.lazy().tanh().exp();
+
+    for (size_t i = 0; i < n; ++i) {
+        const double x = arr.flat()[i];
+        EXPECT_NEAR(exps.flat()[i], std::exp(x), 1e-12 * std::exp(x));
+        EXPECT_NEAR(exp2s.flat()[i], std::exp2(x), 1e-12 * std::exp2(x));
+        EXPECT_NEAR(expm1s.flat()[i], std::expm1(x), 1e-12 * std::abs(std::expm1(x)) + 1e-300);
+        EXPECT_NEAR(log1ps.flat()[i], std::log1p(std::abs(x)), 1e-12);
+        EXPECT_NEAR(tanhs.flat()[i], std::tanh(x), 1e-12);
+        EXPECT_NEAR(sigmoids.flat()[i], 1 / (1 + std::exp(-x)), 1e-12);
+        EXPECT_NEAR(powers.flat()[i], std::pow(std::abs(x), exponents.flat()[i]),
+                    1e-12 * std::pow(std::abs(x), exponents.flat()[i]));
+        EXPECT_NEAR(fused.flat()[i], std::exp(std::tanh(x)), 1e-12);
+    }
+
+    ndarray<float> extremes({4});
+    extremes.assign(std::vector<float>{-1000.0f, -100.0f, 100.0f, 1000.0f});
+    ndarray<float> squashed = extremes.sigmoid();
+    EXPECT_EQ(squashed.flat()[0], 0.0f);
+    EXPECT_EQ(squashed.flat()[3], 1.0f);
+}
+
+TEST(NDArrayMathTest, XsimdLevelsTest) {
+    // the xsimd families have their own batch per level, with masked tails
+    // at AVX-512
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (size_t n = 1; n <= 70; ++n) {
+            ndarray<float> arr({n}), logits({2, n});
+            for (size_t i = 0; i < n; ++i)
+                arr.flat()[i] = static_cast<float>(i) * 0.125f - 4.0f;
+            for (size_t i = 0; i < logits.size(); ++i)
+                logits.flat()[i] = static_cast<float>(i % 13) * 0.5f;
+
+            auto sincos = arr.sincos();
+            ndarray<float> exps = arr.exp(), powers = arr.abs().pow(arr);
+            ndarray<float> exp2s = arr.exp2(), expm1s = arr.expm1(), tanhs = arr.tanh(), sigmoids = arr.sigmoid();
+            ndarray<float> log1ps = arr.abs().log1p();
+            ndarray<float> result = logits.softmax(1), lse = logits.logsumexp(1);
+
+            for (size_t i = 0; i < n; ++i) {
+                const float x = arr.flat()[i];
+                EXPECT_NEAR(sincos.first.flat()[i], std::sin(x), 1e-6f);
+                EXPECT_NEAR(sincos.second.flat()[i], std::cos(x), 1e-6f);
+                EXPECT_NEAR(exps.flat()[i], std::exp(x), 1e-6f * std::exp(x));
+                EXPECT_NEAR(powers.flat()[i], std::pow(std::abs(x), x), 1e-5f * std::pow(std::abs(x), x));
+                EXPECT_NEAR(exp2s.flat()[i], std::exp2(x), 1e-6f * std::exp2(x));
+                EXPECT_NEAR(expm1s.flat()[i], std::expm1(x), 1e-6f * std::max(1.0f, std::abs(std::expm1(x))));
+                EXPECT_NEAR(log1ps.flat()[i], std::log1p(std::abs(x)), 1e-6f);
+                EXPECT_NEAR(tanhs.flat()[i], std::tanh(x), 1e-6f);
+                EXPECT_NEAR(sigmoids.flat()[i], 1.0f / (1.0f + std::exp(-x)), 1e-6f);
+            }
+
+            for (size_t r = 0; r < 2; ++r) {
+                float total = 0, sum_exp = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    total += result({r, i});
+                    sum_exp += std::exp(logits({r, i}));
+                }
+                EXPECT_NEAR(total, 1.0f, 1e-5f);
+                EXPECT_NEAR(lse({r}), std::log(sum_exp), 1e-5f);
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+TEST(NDArrayMathTest, SoftmaxTest) {
+    // large logits would overflow exp without the max shift
+    ndarray<double> arr({3, 5, 37});
+    for (size_t i = 0; i < arr.size(); ++i)
+        arr.flat()[i] = static_cast<double>((i * 37) % 101) * 9.0 - 400.0;
+
+    const std::vector<size_t>& shape = arr.shape();
+    for (int axis : {0, 1, 2, -1}) {
+        const size_t a = axis < 0 ? 2 : static_cast<size_t>(axis);
+        ndarray<double> result = arr.softmax(axis);
+        ndarray<double> lse = arr.logsumexp(axis);
+
+        std::vector<size_t> reduced_shape;
+        for (size_t d = 0; d < 3; ++d)
+            if (d != a)
+                reduced_shape.push_back(shape[d]);
+        EXPECT_EQ(lse.shape(), reduced_shape);
+
+        for (size_t o = 0; o < lse.size(); ++o) {
+            // o indexes the two kept axes in row-major order
+            std::vector<size_t> index(3, 0);
+            size_t rest = o;
+            for (int d = 2; d >= 0; --d) {
+                if (static_cast<size_t>(d) == a)
+                    continue;
+                index[d] = rest % shape[d];
+                rest /= shape[d];
+            }
+
+            long double max = -INFINITY, sum = 0;
+            for (size_t k = 0; k < shape[a]; ++k) {
+                index[a] = k;
+                max = std::max<long double>(max, arr(index));
+            }
+            for (size_t k = 0; k < shape[a]; ++k) {
+                index[a] = k;
+                sum += std::exp(static_cast<long double>(arr(index)) - max);
+            }
+
+            EXPECT_NEAR(lse.flat()[o], static_cast<double>(max + std::log(sum)), 1e-9);
+
+            double total = 0;
+            for (size_t k = 0; k < shape[a]; ++k) {
+                index[a] = k;
+                const long double expected = std::exp(static_cast<long double>(arr(index)) - max) / sum;
+                EXPECT_NEAR(result(index), static_cast<double>(expected), 1e-12);
+                total += result(index);
+            }
+            EXPECT_NEAR(total, 1.0, 1e-12);
+        }
+    }
+
+    EXPECT_THROW(arr.softmax(3), std::invalid_argument);
+    EXPECT_THROW(arr.logsumexp(-4), std::invalid_argument);
+}
@@ -322,4 +322,381 @@ TEST(NDArrayTest, TransposeNonTwoDimensionalTest) {
     arr.assign(data);
 
     EXPECT_THROW(arr.transpose(), std::invalid_argument);
-}
\ No newline at end of file
+}
+TEST(NDArrayDotTest, TransposedViewDotTest) {
+    std::vector<size_t> shapeA = {64, 48};
+    std::vector<size_t> shapeB = {80, 48};
+    ndarray<double> arrA(shapeA);
+    ndarray<double> arrB(shapeB);
+    std::vector<std::vector<double>> dataA(shapeA[0], std::vector<double>(shapeA[1]));
+    std::vector<std::vector<double>> dataB(shapeB[0], std::vector<double>(shapeB[1]));
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+
+    for (auto& row : dataA)
+        for (double& value : row)
+            value = dis(gen);
+    for (auto& row : dataB)
+        for (double& value : row)
+            value = dis(gen);
+    arrA.assign(dataA);
+    arrB.assign(dataB);
+
+    ndarray<double> result = arrA.dot(arrB.view().transpose());
+    std::vector<std::vector<double>> expected = manual_dot(dataA, manual_transpose(dataB));
+
+    EXPECT_EQ(result.shape(), (std::vector<size_t>{shapeA[0], shapeB[0]}));
+    for (size_t i = 0; i < shapeA[0]; ++i)
+        for (size_t j = 0; j < shapeB[0]; ++j)
+            EXPECT_NEAR(result({i, j}), expected[i][j], 1e-9);
+}
+
+// integer products against a 64-bit reference, for every combination of
+// transposed operands, with sizes that leave partial tiles and registers;
+// 64-bit operands wrap around the same way the reference does
+template <typename T, typename R>
+void checkIntegerDot(T low, T high) {
+    const size_t M = 37, N = 29, K = 75;
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int64_t> dis(low, high);
+
+    std::vector<T> A(M * K), B(K * N), At(K * M), Bt(N * K);
+    for (size_t i = 0; i < M; ++i)
+        for (size_t k = 0; k < K; ++k)
+            At[k * M + i] = A[i * K + k] = static_cast<T>(dis(gen));
+    for (size_t k = 0; k < K; ++k)
+        for (size_t j = 0; j < N; ++j)
+            Bt[j * K + k] = B[k * N + j] = static_cast<T>(dis(gen));
+
+    std::vector<uint64_t> expected(M * N, 0);
+    for (size_t i = 0; i < M; ++i)
+        for (size_t j = 0; j < N; ++j)
+            for (size_t k = 0; k < K; ++k)
+                expected[i * N + j] += static_cast<uint64_t>(A[i * K + k]) * static_cast<uint64_t>(B[k * N + j]);
+
+    for (simd_level level : {simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (int trans = 0; trans < 4; ++trans) {
+            const bool trans_a = trans & 1, trans_b = trans & 2;
+            std::vector<R> C(M * N);
+            internal::dot(trans_a, trans_b, M, N, K, trans_a ? At.data() : A.data(), trans_a ? M : K,
+                          trans_b ? Bt.data() : B.data(), trans_b ? K : N, C.data(), N);
+
+            for (size_t i = 0; i < M * N; ++i)
+                EXPECT_EQ(C[i], static_cast<R>(expected[i])) << "trans " << trans << " at " << i;
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+TEST(NDArrayDotTest, IntegerDotTest) {
+    checkIntegerDot<int8_t, int32_t>(-128, 127);
+    checkIntegerDot<uint8_t, uint32_t>(0, 255);
+    checkIntegerDot<int16_t, int32_t>(-32768, 32767);
+    checkIntegerDot<uint16_t, uint32_t>(0, 65535);
+    checkIntegerDot<int32_t, int32_t>(-30000, 30000);
+    checkIntegerDot<int64_t, int64_t>(-(int64_t(1) << 40), int64_t(1) << 40);
+    checkIntegerDot<uint64_t, uint64_t>(0, int64_t(1) << 40);
+}
+
+TEST(NDArrayDotTest, WideningDotTest) {
+    ndarray<int8_t> arrA({3, 40}, ndarray<int8_t>::storage_type(3 * 40, -128));
+    ndarray<int8_t> arrB({40, 5}, ndarray<int8_t>::storage_type(40 * 5, -128));
+
+    const ndarray<int32_t> result = arrA.dot<int32_t>(arrB);
+    EXPECT_EQ(result.shape(), (std::vector<size_t>{3, 5}));
+    for (int32_t value : result.data())
+        EXPECT_EQ(value, 40 * 128 * 128);
+
+    // in int8 the same product wraps around, as numpy's does
+    for (int8_t value : arrA.dot(arrB).data())
+        EXPECT_EQ(value, 0);
+}
+
+// the in-tree gemm against a long double reference, for every combination
+// of transposed operands, with sizes that cross the row, depth and column
+// blocks and leave partial tiles
+template <typename T>
+void checkBlockedGemm(size_t M, size_t N, size_t K, T tolerance) {
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<T> dis(-1, 1);
+
+    std::vector<T> A(M * K), B(K * N), At(K * M), Bt(N * K);
+    for (size_t i = 0; i < M; ++i)
+        for (size_t k = 0; k < K; ++k)
+            At[k * M + i] = A[i * K + k] = dis(gen);
+    for (size_t k = 0; k < K; ++k)
+        for (size_t j = 0; j < N; ++j)
+            Bt[j * K + k] = B[k * N + j] = dis(gen);
+
+    std::vector<long double> expected(M * N, 0);
+    for (size_t i = 0; i < M; ++i)
+        for (size_t k = 0; k < K; ++k)
+            for (size_t j = 0; j < N; ++j)
+                expected[i * N + j] += static_cast<long double>(A[i * K + k]) * B[k * N + j];
+
+    for (simd_level level : {simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (int trans = 0; trans < 4; ++trans) {
+            const bool trans_a = trans & 1, trans_b = trans & 2;
+
+            // C is wider than N, and the padding must stay untouched
+            std::vector<T> C(M * (N + 3), T(7));
+            internal::gemm_blocked(trans_a, trans_b, M, N, K, trans_a ? At.data() : A.data(), trans_a ? M : K,
+                                   trans_b ? Bt.data() : B.data(), trans_b ? K : N, C.data(), N + 3);
+
+            for (size_t i = 0; i < M; ++i) {
+                for (size_t j = 0; j < N; ++j)
+                    EXPECT_NEAR(C[i * (N + 3) + j], expected[i * N + j], tolerance) << "trans " << trans;
+                for (size_t j = N; j < N + 3; ++j)
+                    EXPECT_EQ(C[i * (N + 3) + j], T(7));
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+TEST(NDArrayDotTest, BlockedGemmTest) {
+    checkBlockedGemm<float>(79, 37, 300, 1e-3f);
+    checkBlockedGemm<double>(79, 37, 300, 1e-11);
+    checkBlockedGemm<float>(13, 2069, 5, 1e-5f);
+    checkBlockedGemm<double>(8, 8, 0, 0.0);
+}
+
+// the fixed-size kernels behind dot on small square matrices, including a
+// view whose rows are longer than the matrix
+TEST(NDArrayDotTest, SmallFixedDotTest) {
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+
+    for (size_t n : {2, 3, 4, 8, 16}) {
+        std::vector<double> a(n * n), b(n * (n + 5));
+        for (auto& x : a) x = dis(gen);
+        for (auto& x : b) x = dis(gen);
+
+        ndarray<double> arrA({n, n}, ndarray<double>::storage_type(a.begin(), a.end()));
+        ndarray<double> arrB({n, n + 5}, ndarray<double>::storage_type(b.begin(), b.end()));
+
+        for (simd_level level : {simd_level::avx2, simd_level::scalar}) {
+            set_simd_level(level);
+            ndarray<double> result = arrA.dot(arrB.view().slice(1, 2, 2 + n));
+
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < n; ++j) {
+                    double expected = 0;
+                    for (size_t k = 0; k < n; ++k)
+                        expected += a[i * n + k] * b[k * (n + 5) + 2 + j];
+                    EXPECT_NEAR(result({i, j}), expected, 1e-12);
+                }
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+TEST(NDArrayDotTest, BatchedFixedDotTest) {
+    const size_t count = 1001;
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+
+    std::vector<float> points(count * 4 * 4), transforms(count * 4 * 4);
+    for (auto& x : points) x = dis(gen);
+    for (auto& x : transforms) x = dis(gen);
+
+    ndarray<float> arr({count, 4, 4}, ndarray<float>::storage_type(points.begin(), points.end()));
+    ndarray<float> each({count, 4, 4}, ndarray<float>::storage_type(transforms.begin(), transforms.end()));
+    ndarray<float> shared({4, 4}, ndarray<float>::storage_type(transforms.begin(), transforms.begin() + 16));
+
+    set_parallel_threshold(1 << 10);
+    const std::vector<float> per_item = arr.dot_batched<4, 4, 4>(each).data();
+    const std::vector<float> common = arr.dot_batched<4, 4, 4>(shared).data();
+    set_parallel_threshold(1 << 17);
+
+    ASSERT_EQ(per_item.size(), count * 16);
+    for (size_t b = 0; b < count; ++b) {
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                float expected = 0, expected_shared = 0;
+                for (size_t k = 0; k < 4; ++k) {
+                    expected += points[b * 16 + i * 4 + k] * transforms[b * 16 + k * 4 + j];
+                    expected_shared += points[b * 16 + i * 4 + k] * transforms[k * 4 + j];
+                }
+                EXPECT_NEAR(per_item[b * 16 + i * 4 + j], expected, 1e-5f);
+                EXPECT_NEAR(common[b * 16 + i * 4 + j], expected_shared, 1e-5f);
+            }
+        }
+    }
+
+    EXPECT_THROW((arr.dot_batched<4, 4, 3>(shared)), std::invalid_argument);
+    EXPECT_THROW((arr.dot_batched<4, 2, 4>(shared)), std::invalid_argument);
+
+    // 8 x 8 rows fill an AVX2 register, so these take the FMA kernel
+    const size_t wide_count = count / 4;
+    ndarray<float> wide({wide_count, 8, 8}, ndarray<float>::storage_type(points.begin(), points.begin() + wide_count * 64));
+    ndarray<float> wide_each({wide_count, 8, 8},
+                             ndarray<float>::storage_type(transforms.begin(), transforms.begin() + wide_count * 64));
+
+    for (simd_level level : {simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+        const std::vector<float> wide_result = wide.dot_batched<8, 8, 8>(wide_each).data();
+
+        for (size_t b = 0; b < wide_count; ++b) {
+            for (size_t i = 0; i < 8; ++i) {
+                for (size_t j = 0; j < 8; ++j) {
+                    float expected = 0;
+                    for (size_t k = 0; k < 8; ++k)
+                        expected += points[b * 64 + i * 8 + k] * transforms[b * 64 + k * 8 + j];
+                    EXPECT_NEAR(wide_result[b * 64 + i * 8 + j], expected, 1e-5f);
+                }
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+// matmul against products of the matching 2D slices, for a full batch, a
+// shared right operand and a broadcast that needs pointer arrays
+template <typename T>
+void checkMatmul(const std::vector<size_t>& shape_a, const std::vector<size_t>& shape_b, double tolerance) {
+    std::mt19937 gen(8);
+    std::uniform_int_distribution<int> dis(-9, 9);
+
+    std::vector<T> a(std::accumulate(shape_a.begin(), shape_a.end(), size_t(1), std::multiplies<size_t>()));
+    std::vector<T> b(std::accumulate(shape_b.begin(), shape_b.end(), size_t(1), std::multiplies<size_t>()));
+    for (auto& x : a) x = static_cast<T>(dis(gen));
+    for (auto& x : b) x = static_cast<T>(dis(gen));
+    const ndarray<T> arrA(shape_a, typename ndarray<T>::storage_type(a.begin(), a.end()));
+    const ndarray<T> arrB(shape_b, typename ndarray<T>::storage_type(b.begin(), b.end()));
+
+    const size_t M = shape_a[shape_a.size() - 2], K = shape_a.back(), N = shape_b.back();
+    const std::vector<size_t> batch_a(shape_a.begin(), shape_a.end() - 2);
+    const std::vector<size_t> batch_b(shape_b.begin(), shape_b.end() - 2);
+    const std::vector<size_t> batch = internal::broadcast_shape(batch_a, batch_b);
+    const std::vector<size_t> strides_a = internal::broadcast_strides(batch_a, batch);
+    const std::vector<size_t> strides_b = internal::broadcast_strides(batch_b, batch);
+
+    set_parallel_threshold(1 << 10);
+    ndarray<T> result = arrA.matmul(arrB);
+    set_parallel_threshold(1 << 17);
+
+    std::vector<size_t> expected_shape(batch);
+    expected_shape.push_back(M);
+    expected_shape.push_back(N);
+    ASSERT_EQ(result.shape(), expected_shape);
+
+    const std::vector<T> c = result.data();
+    const size_t count = c.size() / (M * N);
+    for (size_t i = 0; i < count; ++i) {
+        size_t offset_a = 0, offset_b = 0;
+        for (size_t d = batch.size(), rest = i; d-- > 0; rest /= batch[d]) {
+            offset_a += rest % batch[d] * strides_a[d];
+            offset_b += rest % batch[d] * strides_b[d];
+        }
+
+        for (size_t r = 0; r < M; ++r) {
+            for (size_t col = 0; col < N; ++col) {
+                double expected = 0;
+                for (size_t k = 0; k < K; ++k)
+                    expected += static_cast<double>(a[offset_a * M * K + r * K + k]) * b[offset_b * K * N + k * N + col];
+                EXPECT_NEAR(c[i * M * N + r * N + col], expected, tolerance);
+            }
+        }
+    }
+}
+
+TEST(NDArrayDotTest, MatmulTest) {
+    checkMatmul<float>({40, 64, 64}, {40, 64, 64}, 0);
+    checkMatmul<double>({7, 3, 5}, {5, 4}, 0);
+    checkMatmul<double>({6, 5}, {3, 5, 4}, 0);
+    checkMatmul<float>({2, 1, 3, 4}, {3, 4, 2}, 0);
+    checkMatmul<int32_t>({4, 1, 6, 9}, {1, 3, 9, 5}, 0);
+
+    EXPECT_THROW(ndarray<float>({3}).matmul(ndarray<float>({3, 2})), std::invalid_argument);
+    EXPECT_THROW(ndarray<float>({2, 3, 4}).matmul(ndarray<float>({2, 3, 4})), std::invalid_argument);
+    EXPECT_THROW(ndarray<float>({2, 3, 4}).matmul(ndarray<float>({3, 4, 2})), std::invalid_argument);
+}
+
+TEST(NDArrayAddSubTest, InPlaceAliasingTest) {
+    std::vector<size_t> shape = {3};
+    ndarray<double> a(shape);
+    ndarray<double> b(shape);
+    a.assign(std::vector<double>{1.0, 2.0, 3.0});
+    b.assign(std::vector<double>{10.0, 20.0, 30.0});
+
+    a.add_(b);
+    EXPECT_EQ(a.data(), (std::vector<double>{11.0, 22.0, 33.0}));
+
+    b.sub(a, b);
+    EXPECT_EQ(b.data(), (std::vector<double>{-1.0, -2.0, -3.0}));
+
+    a.sub_(a);
+    EXPECT_EQ(a.data(), (std::vector<double>{0.0, 0.0, 0.0}));
+
+    ndarray<int64_t> big(shape);
+    big.assign(std::vector<int64_t>{(int64_t(1) << 40) + 1, 3, -5});
+    big.add_(big);
+    EXPECT_EQ(big.data(), (std::vector<int64_t>{(int64_t(1) << 41) + 2, 6, -10}));
+}
+
+TEST(NDArrayBroadcastTest, RowColumnAndScalarTest) {
+    std::vector<size_t> shape = {300, 256};
+    ndarray<float> arr(shape), row({256}), col({300, 1}), scalar({1});
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> dis(-10.0f, 10.0f);
+
+    for (float& value : arr.flat())
+        value = dis(gen);
+    for (float& value : row.flat())
+        value = dis(gen);
+    for (float& value : col.flat())
+        value = dis(gen);
+    scalar({0}) = 2.5f;
+
+    ndarray<float> biased = arr.add(row);
+    ndarray<float> clipped = arr.min(col);
+    ndarray<float> shifted = scalar.sub(arr);
+
+    EXPECT_EQ(biased.shape(), shape);
+    for (size_t i = 0; i < shape[0]; ++i) {
+        for (size_t j = 0; j < shape[1]; ++j) {
+            EXPECT_FLOAT_EQ(biased({i, j}), arr({i, j}) + row({j}));
+            EXPECT_FLOAT_EQ(clipped({i, j}), std::min(arr({i, j}), col({i, 0})));
+            EXPECT_FLOAT_EQ(shifted({i, j}), 2.5f - arr({i, j}));
+        }
+    }
+
+    arr.add_(row);
+    for (size_t i = 0; i < shape[0]; ++i)
+        for (size_t j = 0; j < shape[1]; ++j)
+            EXPECT_FLOAT_EQ(arr({i, j}), biased({i, j}));
+
+    EXPECT_THROW(row.add_(arr), std::invalid_argument);
+}
+
+TEST(NDArrayBroadcastTest, GeneralNDTest) {
+    ndarray<int> a({4, 1, 5}), b({3, 1});
+    for (size_t i = 0; i < a.size(); ++i)
+        a.flat()[i] = static_cast<int>(i);
+    for (size_t i = 0; i < b.size(); ++i)
+        b.flat()[i] = static_cast<int>(i * 100);
+
+    ndarray<int> result = a.max(b).logical_xor(b);
+    EXPECT_EQ(result.shape(), (std::vector<size_t>{4, 3, 5}));
+
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            for (size_t k = 0; k < 5; ++k)
+                EXPECT_EQ(result({i, j, k}), std::max(a({i, 0, k}), b({j, 0})) ^ b({j, 0}));
+
+    EXPECT_THROW(a.add(ndarray<int>({4})), std::invalid_argument);
+}
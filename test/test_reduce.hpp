@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include <limits>
+#include "../include/data_structure/ndarray.cpp"
+
+// reference reduction of a [outer, len, inner] view, in long double
+template <typename T, typename Fold>
+std::vector<long double> referenceAxis(const std::vector<T>& data, size_t outer, size_t len, size_t inner,
+                                       long double init, Fold fold) {
+    std::vector<long double> result(outer * inner, init);
+    for (size_t o = 0; o < outer; ++o)
+        for (size_t k = 0; k < len; ++k)
+            for (size_t j = 0; j < inner; ++j)
+                result[o * inner + j] = fold(result[o * inner + j], data[(o * len + k) * inner + j]);
+
+    return result;
+}
+
+
+// every axis of a 3D array, at every SIMD level, through both the
+// contiguous-axis and the row-streaming path, with odd sizes for the tails
+TEST(NDArrayReduceTest, AxisTest) {
+    const std::vector<size_t> shape = {7, 45, 131};
+    const size_t size = shape[0] * shape[1] * shape[2];
+
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+    std::vector<double> data(size);
+    for (auto& x : data)
+        x = dis(gen);
+
+    ndarray<double> arr(shape, ndarray<double>::storage_type(data.begin(), data.end()));
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (int axis = 0; axis < 3; ++axis) {
+            size_t outer = 1, inner = 1;
+            for (int d = 0; d < axis; ++d) outer *= shape[d];
+            for (int d = axis + 1; d < 3; ++d) inner *= shape[d];
+            const size_t len = shape[axis];
+
+            auto sum = referenceAxis(data, outer, len, inner, 0.0L, [](long double a, double x) { return a + x; });
+            auto lo = referenceAxis(data, outer, len, inner, INFINITY, [](long double a, double x) { return std::min<long double>(a, x); });
+            auto hi = referenceAxis(data, outer, len, inner, -INFINITY, [](long double a, double x) { return std::max<long double>(a, x); });
+
+            const std::vector<double> s = arr.sum(axis).data();
+            const std::vector<double> m = arr.mean(axis).data();
+            const std::vector<double> mn = arr.min(axis).data();
+            const std::vector<double> mx = arr.max(axis).data();
+            const std::vector<int64_t> amn = arr.argmin(axis).data();
+            const std::vector<int64_t> amx = arr.argmax(axis).data();
+
+            ASSERT_EQ(s.size(), outer * inner);
+            EXPECT_EQ(arr.sum(axis - 3).shape(), arr.sum(axis).shape());
+
+            for (size_t i = 0; i < outer * inner; ++i) {
+                EXPECT_NEAR(s[i], static_cast<double>(sum[i]), 1e-12);
+                EXPECT_NEAR(m[i], static_cast<double>(sum[i] / len), 1e-13);
+                EXPECT_EQ(mn[i], static_cast<double>(lo[i]));
+                EXPECT_EQ(mx[i], static_cast<double>(hi[i]));
+
+                const size_t o = i / inner, j = i % inner;
+                EXPECT_EQ(data[(o * len + amn[i]) * inner + j], mn[i]);
+                EXPECT_EQ(data[(o * len + amx[i]) * inner + j], mx[i]);
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+    EXPECT_THROW(arr.sum(3), std::invalid_argument);
+}
+
+
+TEST(NDArrayReduceTest, FullTest) {
+    const size_t n = 300007;
+    std::vector<float> data(n);
+    std::vector<int32_t> ints(n);
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<float>((i * 7919) % 1000) * 0.001f;
+        ints[i] = static_cast<int32_t>((i * 7919) % 2001) - 1000;
+    }
+    data[123457] = -5.0f;
+    data[200001] = 9.0f;
+    data[250000] = 9.0f;
+
+    ndarray<float> arr({n});
+    arr.assign(data);
+    ndarray<int32_t> iarr({n});
+    iarr.assign(ints);
+
+    long double expected = 0;
+    int64_t expected_int = 0;
+    for (size_t i = 0; i < n; ++i) {
+        expected += data[i];
+        expected_int += ints[i];
+    }
+
+    // small enough that the elementwise split kicks in with several threads
+    set_parallel_threshold(1 << 10);
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        EXPECT_NEAR(arr.sum(), static_cast<float>(expected), std::fabs(static_cast<float>(expected)) * 1e-5f);
+        EXPECT_NEAR(arr.mean(), static_cast<float>(expected / n), 1e-5f);
+        EXPECT_EQ(arr.min(), -5.0f);
+        EXPECT_EQ(arr.max(), 9.0f);
+        EXPECT_EQ(arr.argmin(), 123457u);
+        EXPECT_EQ(arr.argmax(), 200001u);
+
+        EXPECT_EQ(iarr.sum(), static_cast<int32_t>(expected_int));
+        EXPECT_EQ(iarr.min(), -1000);
+        EXPECT_EQ(iarr.max(), 1000);
+    }
+
+    set_parallel_threshold(1 << 17);
+    set_simd_level(simd_level::avx512);
+}
+
+
+TEST(NDArrayReduceTest, ProdAndNaNTest) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> data(100, 1.0f);
+    data[3] = 2.0f;
+    data[50] = -0.5f;
+    data[97] = 3.0f;
+
+    std::vector<int64_t> ints(70, 1);
+    ints[10] = -3;
+    ints[69] = 5;
+
+    ndarray<float> arr({data.size()});
+    arr.assign(data);
+    ndarray<int64_t> iarr({ints.size()});
+    iarr.assign(ints);
+
+    std::vector<float> with_nan = {nan, 4.0f, nan, -2.0f, 7.0f, nan};
+    ndarray<float> narr({with_nan.size()});
+    narr.assign(with_nan);
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        EXPECT_FLOAT_EQ(arr.prod(), -3.0f);
+        EXPECT_EQ(iarr.prod(), -15);
+
+        EXPECT_EQ(narr.min(), -2.0f);
+        EXPECT_EQ(narr.max(), 7.0f);
+        EXPECT_EQ(narr.argmin(), 3u);
+        EXPECT_EQ(narr.argmax(), 4u);
+    }
+
+    set_simd_level(simd_level::avx512);
+
+    ndarray<float> empty({0});
+    EXPECT_EQ(empty.sum(), 0.0f);
+    EXPECT_EQ(empty.prod(), 1.0f);
+    EXPECT_THROW(empty.min(), std::invalid_argument);
+    EXPECT_THROW(empty.argmax(), std::invalid_argument);
+}
+
+
+// every summation mode against a long double reference, on enough floats
+// that plain accumulation visibly drifts; compensated must be within about
+// one rounding, pairwise within a few
+TEST(NDArrayReduceTest, SummationTest) {
+    const size_t n = (1 << 22) + 37;
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+    std::vector<float> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = dis(gen);
+        b[i] = dis(gen) + 0.5f;
+    }
+
+    long double sum = 0, dot = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i];
+        dot += static_cast<long double>(a[i]) * b[i];
+    }
+
+    ndarray<float> arr({n}), brr({n});
+    arr.assign(a);
+    brr.assign(b);
+
+    const long double eps = std::numeric_limits<float>::epsilon();
+    set_parallel_threshold(1 << 16);
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        {
+            summation_scope scope(summation::compensated);
+            EXPECT_LE(std::fabs(arr.sum() - sum), eps * sum);
+            EXPECT_LE(std::fabs(arr.vdot(brr) - dot), eps * dot);
+            EXPECT_LE(std::fabs(arr.mean() - sum / n), eps * sum / n);
+        }
+
+        {
+            summation_scope scope(summation::pairwise);
+            EXPECT_LE(std::fabs(arr.sum() - sum), 8 * eps * sum);
+            EXPECT_LE(std::fabs(arr.vdot(brr) - dot), 8 * eps * dot);
+        }
+
+        // a single scalar accumulator is off by about 1e-3 here
+        EXPECT_NEAR(arr.sum(), static_cast<float>(sum), 1e-2 * sum);
+        EXPECT_NEAR(arr.vdot(brr), static_cast<float>(dot), 1e-2 * dot);
+    }
+
+    set_parallel_threshold(1 << 17);
+    set_simd_level(simd_level::avx512);
+    EXPECT_EQ(get_summation(), summation::fast);
+    EXPECT_THROW(arr.vdot(ndarray<float>({3})), std::invalid_argument);
+}
+
+
+// the strided-axis path keeps a compensation per column; sums that reach
+// inf or NaN come out as they are
+TEST(NDArrayReduceTest, CompensatedAxisTest) {
+    const size_t rows = 20001, cols = 37;
+    std::vector<float> data(rows * cols);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (i % 3 == 0 ? 1e4f : 1e-3f) * static_cast<float>(i % 7 + 1);
+
+    ndarray<float> arr({rows, cols}, ndarray<float>::storage_type(data.begin(), data.end()));
+    auto sum = referenceAxis(data, 1, rows, cols, 0.0L, [](long double acc, float x) { return acc + x; });
+
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<float> special = {1.0f, inf, 2.0f, 3.0f, 5.0f, std::numeric_limits<float>::quiet_NaN()};
+    ndarray<float> sarr({2, 3}, ndarray<float>::storage_type(special.begin(), special.end()));
+
+    summation_scope scope(summation::compensated);
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        const std::vector<float> s = arr.sum(0).data();
+        for (size_t j = 0; j < cols; ++j)
+            EXPECT_LE(std::fabs(s[j] - sum[j]), std::numeric_limits<float>::epsilon() * sum[j]);
+
+        const std::vector<float> cs = sarr.sum(0).data();
+        EXPECT_EQ(cs[0], 4.0f);
+        EXPECT_EQ(cs[1], inf);
+        EXPECT_TRUE(std::isnan(cs[2]));
+
+        const std::vector<float> rs = sarr.sum(1).data();
+        EXPECT_EQ(rs[0], inf);
+        EXPECT_TRUE(std::isnan(rs[1]));
+    }
+
+    set_simd_level(simd_level::avx512);
+}
@@ -99,4 +99,73 @@ TEST(NDArrayShiftTest, Srli2DTest) {
             EXPECT_EQ(resultData[index++], expected);
         }
     }
-}
\ No newline at end of file
+}
+// every lane width, counts up to and past the width, odd lengths for tails
+template <typename T>
+void checkShiftWidths() {
+    using U = std::make_unsigned_t<T>;
+    constexpr int bits = sizeof(T) * 8;
+    const size_t n = 67;
+
+    ndarray<T> arr({n}), counts({n});
+    for (size_t i = 0; i < n; ++i) {
+        arr.flat()[i] = static_cast<T>(static_cast<U>(0x9e3779b97f4a7c15ull * (i + 1) >> 7));
+        counts.flat()[i] = static_cast<T>(i % (bits + 3));
+    }
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (int imm = 0; imm <= bits + 1; ++imm) {
+            ndarray<T> left = arr.slli(imm), right = arr.srli(imm), arith = arr.srai(imm);
+
+            for (size_t i = 0; i < n; ++i) {
+                const T a = arr.flat()[i];
+                const T expected_left = imm >= bits ? T(0) : static_cast<T>(static_cast<U>(static_cast<U>(a) << imm));
+                const T expected_right = imm >= bits ? T(0) : static_cast<T>(static_cast<U>(a) >> imm);
+                const T expected_arith = std::is_signed<T>::value ? static_cast<T>(a >> std::min(imm, bits - 1))
+                                                                  : expected_right;
+                ASSERT_EQ(left.flat()[i], expected_left) << "imm " << imm << " at " << i;
+                ASSERT_EQ(right.flat()[i], expected_right) << "imm " << imm << " at " << i;
+                ASSERT_EQ(arith.flat()[i], expected_arith) << "imm " << imm << " at " << i;
+            }
+        }
+
+        ndarray<T> left = arr.sllv(counts), right = arr.srlv(counts);
+        for (size_t i = 0; i < n; ++i) {
+            const T a = arr.flat()[i];
+            const int c = static_cast<int>(counts.flat()[i]);
+            EXPECT_EQ(left.flat()[i], c >= bits ? T(0) : static_cast<T>(static_cast<U>(static_cast<U>(a) << c)));
+            EXPECT_EQ(right.flat()[i], c >= bits ? T(0) : static_cast<T>(static_cast<U>(a) >> c));
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+TEST(NDArrayShiftTest, LaneWidthTest) {
+    checkShiftWidths<int8_t>();
+    checkShiftWidths<uint8_t>();
+    checkShiftWidths<int16_t>();
+    checkShiftWidths<uint16_t>();
+    checkShiftWidths<int32_t>();
+    checkShiftWidths<uint32_t>();
+    checkShiftWidths<int64_t>();
+    checkShiftWidths<uint64_t>();
+}
+
+TEST(NDArrayShiftTest, LazyShiftTest) {
+    ndarray<int32_t> arr({100}), counts({100});
+    for (size_t i = 0; i < 100; ++i) {
+        arr.flat()[i] = static_cast<int32_t>(i * 7919) - 400000;
+        counts.flat()[i] = static_cast<int32_t>(i % 5);
+    }
+
+    ndarray<int32_t> fused = arr.lazy().srai(3).sllv(counts);
+    ndarray<int32_t> expected = arr.srai(3).sllv(counts);
+    EXPECT_EQ(fused.data(), expected.data());
+
+    ndarray<int32_t> broadcast = ndarray<int32_t>({3, 100}).srlv(counts);
+    for (size_t i = 0; i < broadcast.size(); ++i)
+        EXPECT_EQ(broadcast.flat()[i], 0);
+}
@@ -49,4 +49,26 @@ TEST(NDArraySortTest, SortWithCustomComparator) {
     for (size_t i = 0; i < data.size(); ++i)
         EXPECT_EQ(sortedData[i], data[i]);
 }
-    
\ No newline at end of file
+    
+TEST(NDArraySortTest, Sort2DSortsEachRow) {
+    std::vector<size_t> shape = {100, 300};
+    ndarray<int> arr(shape);
+    std::vector<std::vector<int>> data(shape[0], std::vector<int>(shape[1]));
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(1, 1000);
+
+    for (auto& row : data)
+        for (int& value : row)
+            value = dis(gen);
+    arr.assign(data);
+
+    ndarray<int> sortedArr = arr.sort(std::less<int>{});
+
+    for (size_t i = 0; i < shape[0]; ++i) {
+        std::sort(data[i].begin(), data[i].end());
+        for (size_t j = 0; j < shape[1]; ++j)
+            EXPECT_EQ(sortedArr({i, j}), data[i][j]);
+    }
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include <limits>
+#include "../include/data_structure/ndarray.cpp"
+
+// two-pass variance of a [outer, len, inner] view, in long double
+template <typename T>
+std::vector<long double> referenceVar(const std::vector<T>& data, size_t outer, size_t len, size_t inner, size_t ddof) {
+    std::vector<long double> result(outer * inner);
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t j = 0; j < inner; ++j) {
+            long double mean = 0, m2 = 0;
+            for (size_t k = 0; k < len; ++k)
+                mean += data[(o * len + k) * inner + j];
+            mean /= len;
+
+            for (size_t k = 0; k < len; ++k) {
+                const long double d = data[(o * len + k) * inner + j] - mean;
+                m2 += d * d;
+            }
+
+            result[o * inner + j] = m2 / (len - ddof);
+        }
+    }
+
+    return result;
+}
+
+// covariance of [vars, obs] data, in long double
+template <typename T>
+std::vector<long double> referenceCov(const std::vector<T>& data, size_t vars, size_t obs, size_t ddof) {
+    std::vector<long double> mean(vars, 0), result(vars * vars, 0);
+    for (size_t i = 0; i < vars; ++i) {
+        for (size_t t = 0; t < obs; ++t)
+            mean[i] += data[i * obs + t];
+        mean[i] /= obs;
+    }
+
+    for (size_t i = 0; i < vars; ++i)
+        for (size_t j = 0; j < vars; ++j) {
+            for (size_t t = 0; t < obs; ++t)
+                result[i * vars + j] += (data[i * obs + t] - mean[i]) * (data[j * obs + t] - mean[j]);
+            result[i * vars + j] /= obs - ddof;
+        }
+
+    return result;
+}
+
+
+// every axis of a 3D array at every SIMD level; the offset makes a
+// sum-of-squares formula lose every digit, which one-pass Welford must not
+TEST(StatisticsTest, AxisTest) {
+    const std::vector<size_t> shape = {3, 1100, 37};
+    const size_t size = shape[0] * shape[1] * shape[2];
+
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+    std::vector<double> data(size);
+    for (auto& x : data)
+        x = 1e4 + dis(gen);
+
+    ndarray<double> arr(shape, ndarray<double>::storage_type(data.begin(), data.end()));
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        for (int axis = 0; axis < 3; ++axis) {
+            size_t outer = 1, inner = 1;
+            for (int d = 0; d < axis; ++d) outer *= shape[d];
+            for (int d = axis + 1; d < 3; ++d) inner *= shape[d];
+
+            const auto expected = referenceVar(data, outer, shape[axis], inner, 1);
+            const std::vector<double> v = arr.var(axis, 1).data();
+            const std::vector<double> s = arr.std(axis - 3, 1).data();
+
+            ASSERT_EQ(v.size(), outer * inner);
+            for (size_t i = 0; i < v.size(); ++i) {
+                EXPECT_NEAR(v[i], static_cast<double>(expected[i]), 1e-7 * expected[i]);
+                EXPECT_NEAR(s[i], std::sqrt(static_cast<double>(expected[i])), 1e-7);
+            }
+        }
+    }
+
+    set_simd_level(simd_level::avx512);
+}
+
+
+TEST(StatisticsTest, FullTest) {
+    const size_t n = 1000003;
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+    std::vector<float> data(n);
+    for (auto& x : data)
+        x = 1000.0f + dis(gen);
+
+    ndarray<float> arr({n});
+    arr.assign(data);
+    const long double expected = referenceVar(data, 1, n, 1, 0)[0];
+
+    set_parallel_threshold(1 << 12);
+
+    for (simd_level level : {simd_level::avx512, simd_level::avx2, simd_level::scalar}) {
+        set_simd_level(level);
+
+        EXPECT_NEAR(arr.var(), static_cast<float>(expected), 1e-5 * expected);
+        EXPECT_NEAR(arr.std(), std::sqrt(static_cast<float>(expected)), 1e-4f);
+    }
+
+    set_parallel_threshold(1 << 17);
+    set_simd_level(simd_level::avx512);
+
+    // sample variance; a bare integer is an axis, so ddof is named
+    ndarray<double> small({4});
+    small.assign(std::vector<double>{1.0, 2.0, 3.0, 6.0});
+    EXPECT_DOUBLE_EQ(small.var(ddof_t{1}), 14.0 / 3);
+    EXPECT_DOUBLE_EQ(small.std(ddof_t{1}), std::sqrt(14.0 / 3));
+    EXPECT_DOUBLE_EQ(small.var(ddof_t{3}), 14.0);
+    EXPECT_THROW(small.var(ddof_t{4}), std::invalid_argument);
+    EXPECT_THROW(small.std(ddof_t{4}), std::invalid_argument);
+    EXPECT_DOUBLE_EQ(small.var(0).data()[0], small.var());
+
+    ndarray<float> one({1});
+    one.assign(std::vector<float>{2.0f});
+    EXPECT_EQ(one.var(), 0.0f);
+    EXPECT_THROW(one.var(ddof_t{1}), std::invalid_argument);
+    EXPECT_TRUE(std::isnan(one.var(0, 1).data()[0]));
+}
+
+
+// below and above cov_gemm_min_vars, with variables as rows and as columns
+TEST(StatisticsTest, CovTest) {
+    for (size_t vars : {5, 24}) {
+        const size_t obs = 3001;
+        std::mt19937 gen(17);
+        std::normal_distribution<double> dis(0.0, 1.0);
+
+        // [vars, obs], each variable mixed with the one before it
+        std::vector<double> data(vars * obs);
+        for (size_t i = 0; i < vars; ++i)
+            for (size_t t = 0; t < obs; ++t)
+                data[i * obs + t] = 50.0 * i + dis(gen) + (i > 0 ? 0.5 * data[(i - 1) * obs + t] : 0.0);
+
+        std::vector<double> transposed(vars * obs);
+        for (size_t i = 0; i < vars; ++i)
+            for (size_t t = 0; t < obs; ++t)
+                transposed[t * vars + i] = data[i * obs + t];
+
+        ndarray<double> rows({vars, obs}, ndarray<double>::storage_type(data.begin(), data.end()));
+        ndarray<double> cols({obs, vars}, ndarray<double>::storage_type(transposed.begin(), transposed.end()));
+        const auto expected = referenceCov(data, vars, obs, 1);
+
+        set_parallel_threshold(1 << 10);
+        const std::vector<double> c = rows.cov().data();
+        const std::vector<double> ct = cols.cov(false).data();
+        const std::vector<double> r = rows.corrcoef().data();
+        set_parallel_threshold(1 << 17);
+
+        ASSERT_EQ(c.size(), vars * vars);
+        for (size_t i = 0; i < vars; ++i) {
+            EXPECT_DOUBLE_EQ(r[i * vars + i], 1.0);
+
+            for (size_t j = 0; j < vars; ++j) {
+                const double e = static_cast<double>(expected[i * vars + j]);
+                const double scale = std::sqrt(static_cast<double>(expected[i * vars + i] * expected[j * vars + j]));
+                EXPECT_NEAR(c[i * vars + j], e, 1e-10 * scale);
+                EXPECT_NEAR(ct[i * vars + j], e, 1e-10 * scale);
+                EXPECT_NEAR(r[i * vars + j], e / scale, 1e-10);
+                EXPECT_LE(std::fabs(r[i * vars + j]), 1.0);
+            }
+        }
+    }
+
+    ndarray<double> cube({2, 2, 2});
+    EXPECT_THROW(cube.cov(), std::invalid_argument);
+}
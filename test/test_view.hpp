@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "../include/data_structure/ndarray.cpp"
+
+TEST(NDArrayViewTest, SliceSharesBufferTest) {
+    std::vector<size_t> shape = {4, 5};
+    ndarray<int> arr(shape);
+    std::vector<std::vector<int>> data(shape[0], std::vector<int>(shape[1]));
+
+    for (size_t i = 0; i < shape[0]; ++i)
+        for (size_t j = 0; j < shape[1]; ++j)
+            data[i][j] = static_cast<int>(i * shape[1] + j);
+    arr.assign(data);
+
+    ndarray_view<int> block = arr.slice(0, 1, 3).slice(1, 0, 5, 2);
+
+    EXPECT_EQ(block.shape(), (std::vector<size_t>{2, 3}));
+    EXPECT_FALSE(block.is_contiguous());
+
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            EXPECT_EQ(block({i, j}), data[i + 1][j * 2]);
+
+    block({0, 1}) = -1;
+    EXPECT_EQ(arr({1, 2}), -1);
+}
+
+TEST(NDArrayViewTest, TransposeViewMaterialiseTest) {
+    std::vector<size_t> shape = {300, 200};
+    ndarray<float> arr(shape);
+    std::vector<std::vector<float>> data(shape[0], std::vector<float>(shape[1]));
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> dis(-10.0f, 10.0f);
+
+    for (auto& row : data)
+        for (float& value : row)
+            value = dis(gen);
+    arr.assign(data);
+
+    ndarray_view<const float> transposed = static_cast<const ndarray<float>&>(arr).view().transpose();
+    EXPECT_EQ(transposed.shape(), (std::vector<size_t>{shape[1], shape[0]}));
+    EXPECT_EQ(transposed.data(), arr.view().data());
+
+    ndarray<float> result(transposed);
+    EXPECT_EQ(result.shape(), (std::vector<size_t>{shape[1], shape[0]}));
+
+    for (size_t i = 0; i < shape[1]; ++i)
+        for (size_t j = 0; j < shape[0]; ++j)
+            EXPECT_EQ(result({i, j}), data[j][i]);
+}
+
+TEST(NDArrayViewTest, ReshapeTest) {
+    std::vector<size_t> shape = {12};
+    ndarray<int> arr(shape);
+    std::vector<int> data(12);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<int>(i);
+    arr.assign(data);
+
+    ndarray_view<int> reshaped = arr.reshape({3, 4});
+    EXPECT_TRUE(reshaped.is_contiguous());
+    EXPECT_EQ(reshaped({2, 1}), 9);
+
+    EXPECT_THROW(arr.reshape({5, 2}), std::invalid_argument);
+    EXPECT_THROW(reshaped.transpose().reshape({12}), std::invalid_argument);
+    EXPECT_THROW(arr.slice(0, 4, 2), std::out_of_range);
+}